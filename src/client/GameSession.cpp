@@ -10,8 +10,14 @@
 #include "Protocol.h"   // LOBBY_MAP_PATH, PKT_* constants
 #include "GameMode.h"
 #include "SpawnFinder.h" // FindCenterSpawn (shared con server)
+#include "WireCodec.h"   // QuantizeInputFrame, EncodeInputPacket
+#include "LevelCodec.h"  // DecodeLevelGrid, DecodeRegionBlocks
+#include "ChunkLibrary.h"   // ricostruzione dei livelli da LevelRecipe (src/server)
+#include "LevelGenerator.h"
+#include "LevelPack.h"       // LoadWorldFile (mappe dal pack, fallback .tmj)
 #include <algorithm>
 #include <cmath>
+#include <utility>
 
 // ---------------------------------------------------------------------------
 // Catmull-Rom helpers for spline tessellation caching
@@ -27,6 +33,62 @@ static Vector2 CatmullRomPoint(Vector2 p0, Vector2 p1, Vector2 p2, Vector2 p3, f
 #include <cstring>
 #include <raylib.h>
 
+// ---------------------------------------------------------------------------
+// Chunk set locale per i livelli inviati come LevelRecipe: lo stesso snapshot
+// del LocalServer (ChunkLibrary::Shared): snapshot unico, caricato una sola volta
+// per processo (il client non attiva l'hot reload). Se il server usa un altro
+// chunk set, la ricetta non combacia e si chiede la griglia completa.
+// ---------------------------------------------------------------------------
+static std::shared_ptr<const ChunkStore> LocalChunkStore() {
+    return ChunkLibrary::Shared().Current();
+}
+
+// Payload di PKT_LEVEL_DATA / PKT_LEVEL_STAGE → World pronto da installare.
+// false se il pacchetto è malformato o la ricetta non si ricostruisce in locale
+// (in quel caso il chiamante chiede la griglia completa con PKT_LEVEL_REQUEST).
+static bool DecodeLevelPayload(const uint8_t* data, size_t size,
+                               const PktLevelDataHeader& hdr,
+                               World& world) {
+    if (hdr.width == 0 || hdr.height == 0) return false;
+    const uint8_t* payload = data + sizeof(PktLevelDataHeader);
+    const size_t   len     = size - sizeof(PktLevelDataHeader);
+
+    if (hdr.encoding == LEVEL_ENC_PACKED)
+        return DecodeLevelGrid(payload, len, hdr.width, hdr.height, world);
+    if (hdr.encoding == LEVEL_ENC_REGIONS) {
+        // Solo le regioni vicine allo spawn: il resto arriva con PKT_LEVEL_REGION.
+        PktLevelRegionsInfo info{};
+        if (len < sizeof(info)) return false;
+        std::memcpy(&info, payload, sizeof(info));
+        if (info.count > info.total) return false;
+        world.InitPending(hdr.width, hdr.height);
+        return DecodeRegionBlocks(payload + sizeof(info), len - sizeof(info),
+                                  info.count, info.region_tiles, world);
+    }
+    if (hdr.encoding == LEVEL_ENC_GRID) {
+        if (len < static_cast<size_t>(hdr.width) * hdr.height) return false;
+        const char* tile_data = reinterpret_cast<const char*>(payload);
+        std::vector<std::string> rows(hdr.height);
+        for (int y = 0; y < hdr.height; ++y)
+            rows[y].assign(tile_data + y * hdr.width, hdr.width);
+        return world.LoadFromGrid(hdr.width, hdr.height, rows);
+    }
+    if (hdr.encoding == LEVEL_ENC_RECIPE) {
+        BitReader   r(payload, len);
+        LevelRecipe recipe;
+        World       rebuilt;
+        if (!ReadLevelRecipe(r, recipe) ||
+            !LevelGenerator::Rebuild(*LocalChunkStore(), recipe, rebuilt) ||
+            rebuilt.GetWidth() != hdr.width || rebuilt.GetHeight() != hdr.height)
+            return false;
+        world = std::move(rebuilt);
+        printf("[session] level %u rebuilt from recipe (%zu chunks, %zu bytes)\n",
+               (unsigned)hdr.level, recipe.placements.size(), len);
+        return true;
+    }
+    return false;
+}
+
 // ---------------------------------------------------------------------------
 // Costruttore
 // ---------------------------------------------------------------------------
@@ -48,7 +110,7 @@ GameSession::GameSession(const Config& cfg)
         sfx_.SetMuted(save_->sfx_muted);
 
     if (cfg.map_path) {
-        world_.LoadFromFile(cfg.map_path);
+        LoadWorldFile(world_, cfg.map_path);
         const SpawnPos sp = FindCenterSpawn(world_);
         PlayerState ps{};
         std::strncpy(ps.name, username_.c_str(), sizeof(ps.name) - 1);
@@ -88,7 +150,7 @@ bool GameSession::Tick(float dt, NetworkClient& net, Renderer& renderer) {
     if (in_results_screen_ && !local_ready_) {
         if (input_sampler_.ConsumeJumpPressed()) {
             PktReady rp{};
-            net.SendReliable(&rp, sizeof(rp));
+            net.Send(&rp, sizeof(rp));
             local_ready_ = true;
             printf("[session] READY inviato\n");
         }
@@ -98,7 +160,7 @@ bool GameSession::Tick(float dt, NetworkClient& net, Renderer& renderer) {
     if (in_global_results_screen_ && !local_global_ready_) {
         if (input_sampler_.ConsumeJumpPressed()) {
             PktReady rp{};
-            net.SendReliable(&rp, sizeof(rp));
+            net.Send(&rp, sizeof(rp));
             local_global_ready_ = true;
             printf("[session] GLOBAL READY inviato\n");
         }
@@ -114,7 +176,7 @@ bool GameSession::Tick(float dt, NetworkClient& net, Renderer& renderer) {
             && !(cur_mode == GameMode::VERSUS && cur.finished);
         if (can_restart) {
             PktRestart rpkt{};
-            net.SendReliable(&rpkt, sizeof(rpkt));
+            net.Send(&rpkt, sizeof(rpkt));
             show_record_ = false;
         }
     }
@@ -129,7 +191,7 @@ bool GameSession::Tick(float dt, NetworkClient& net, Renderer& renderer) {
             && !(cur_mode == GameMode::VERSUS && cur.finished);
         if (can_restart) {
             PktRestartSpawn rpkt{};
-            net.SendReliable(&rpkt, sizeof(rpkt));
+            net.Send(&rpkt, sizeof(rpkt));
             show_record_ = false;
         }
     }
@@ -140,7 +202,7 @@ bool GameSession::Tick(float dt, NetworkClient& net, Renderer& renderer) {
         if (emote >= 0 && emote < EMOTE_COUNT) {
             PktEmote epkt{};
             epkt.emote_id = static_cast<uint8_t>(emote);
-            net.SendReliable(&epkt, sizeof(epkt));
+            net.Send(&epkt, sizeof(epkt));
             // Show locally immediately
             EmoteBubble& eb = emote_bubbles_[local_player_id_];
             eb.emote_id = static_cast<uint8_t>(emote);
@@ -354,7 +416,7 @@ void GameSession::HandlePauseInput(Renderer& renderer, NetworkClient& net) {
             if (value == static_cast<int>(current_max_levels())) return;
             PktSetMaxLevels lpkt{};
             lpkt.max_levels = static_cast<uint8_t>(value);
-            net.SendReliable(&lpkt, sizeof(lpkt));
+            net.Send(&lpkt, sizeof(lpkt));
         };
 
         if      (toggle)       { pause_state_ = PauseState::PAUSED; pause_focused_ = 0; }
@@ -372,7 +434,7 @@ void GameSession::HandlePauseInput(Renderer& renderer, NetworkClient& net) {
                 else if (cur == GameMode::RACE)   next = GameMode::COOP;
                 else                              next = GameMode::VERSUS;
                 mpkt.game_mode = static_cast<uint8_t>(next);
-                net.SendReliable(&mpkt, sizeof(mpkt));
+                net.Send(&mpkt, sizeof(mpkt));
             } else if (pause_focused_ == 1) {
                 // Quick increment when confirming the levels row.
                 send_max_levels(+1);
@@ -448,14 +510,31 @@ void GameSession::TickFixed(NetworkClient& net) {
         }
     }
 
-    // Invia al server
-    PktInput pkt{};
-    pkt.frame = frame;
-    net.SendReliable(&pkt, sizeof(pkt));
+    // Stessa griglia del wire codec: la prediction simula esattamente l'input che
+    // il server decodifica.
+    QuantizeInputFrame(frame);
 
-    // Archivia per reconciliation
+    // Archivia per reconciliation (e per il reinvio ridondante)
     input_history_[frame.tick % IHIST] = frame;
 
+    // Invia al server tutti i frame non ancora confermati (max INPUT_BUNDLE_MAX):
+    // un pacchetto perso viene coperto dal successivo, senza ritrasmissioni.
+    {
+        uint32_t first = input_unacked_;
+        if (frame.tick + 1 - first > static_cast<uint32_t>(INPUT_BUNDLE_MAX))
+            first = frame.tick + 1 - static_cast<uint32_t>(INPUT_BUNDLE_MAX);
+        InputFrame bundle[INPUT_BUNDLE_MAX];
+        int count = 0;
+        for (uint32_t t = first; t <= frame.tick; t++) {
+            const InputFrame& hf = input_history_[t % IHIST];
+            if (hf.tick != t) { count = 0; continue; }   // keep the run contiguous
+            bundle[count++] = hf;
+        }
+        std::vector<uint8_t> pkt;
+        EncodeInputPacket(snapshot_ack_, level_epoch_, bundle, count, pkt);
+        net.Send(pkt.data(), pkt.size());
+    }
+
     // Salva lo stato prima della simulazione per rilevare eventi sonori.
     const float   pre_vy   = player_.GetState().vel_y;
     const uint8_t pre_dash = player_.GetState().dash_active_ticks;
@@ -539,6 +618,7 @@ void GameSession::HandlePacket(const uint8_t* data, size_t size, NetworkClient&
         PktWelcome welcome{};
         std::memcpy(&welcome, data, sizeof(PktWelcome));
         local_player_id_ = welcome.player_id;
+        level_epoch_     = welcome.level_epoch;
         printf("[session] player_id=%u  session_token=%u\n",
                welcome.player_id, welcome.session_token);
 
@@ -549,7 +629,8 @@ void GameSession::HandlePacket(const uint8_t* data, size_t size, NetworkClient&
         PktPlayerInfo info{};
         info.protocol_version = PROTOCOL_VERSION;
         std::strncpy(info.name, username_.c_str(), sizeof(info.name) - 1);
-        net.SendReliable(&info, sizeof(info));
+        info.chunk_hash = LocalChunkStore()->ContentHash();
+        net.Send(&info, sizeof(info));
         printf("[session] nome='%s'  protocol=%u\n", username_.c_str(), PROTOCOL_VERSION);
         return;
     }
@@ -570,26 +651,52 @@ void GameSession::HandlePacket(const uint8_t* data, size_t size, NetworkClient&
     }
 
     // PKT_GAME_STATE: reconciliation + aggiornamento remoti
-    if (pkt_type == PKT_GAME_STATE && size >= sizeof(PktGameState)) {
-        PktGameState resp{};
-        std::memcpy(&resp, data, sizeof(PktGameState));
+    if (pkt_type == PKT_GAME_STATE) {
+        uint32_t seq = 0, baseline_seq = 0;
+        if (!ReadSnapshotHeader(data, size, seq, baseline_seq)) return;
+        if (seq <= snapshot_ack_) return;   // older than what we already have
+
+        const GameState* base = nullptr;
+        if (baseline_seq != 0) {
+            const uint32_t slot = baseline_seq % SNAPSHOT_RING;
+            if (snapshot_ring_seq_[slot] != baseline_seq) return;  // baseline lost: wait for next
+            base = &snapshot_ring_[slot];
+        }
+        GameState state{};
+        if (!DecodeSnapshot(base, data, size, state)) {
+            printf("[session] snapshot %u malformed (baseline %u)\n", seq, baseline_seq);
+            return;
+        }
+        // I nomi arrivano da PKT_ROSTER, non dallo snapshot.
+        for (uint32_t i = 0; i < state.count; i++) {
+            auto nit = roster_names_.find(state.players[i].player_id);
+            if (nit != roster_names_.end())
+                std::memcpy(state.players[i].name, nit->second.name, sizeof(nit->second.name));
+        }
+        snapshot_ring_[seq % SNAPSHOT_RING]     = state;
+        snapshot_ring_seq_[seq % SNAPSHOT_RING] = seq;
+        snapshot_ack_ = seq;
+
+        // PKT_LEVEL_DATA viaggia su CHANNEL_BULK: uno snapshot del nuovo livello può
+        // sorpassarlo. Resta come baseline ma non va applicato al mondo precedente.
+        if (state.level_epoch != level_epoch_) return;
 
         // Grab SFX: detect authoritative grabbed-state transitions per player.
         // This guarantees all clients hear the same grab_on / grab_off events.
         std::unordered_set<uint32_t> seen_players;
-        seen_players.reserve(resp.state.count);
+        seen_players.reserve(state.count);
         float listener_x = player_.GetState().x + TILE_SIZE * 0.5f;
         float listener_y = player_.GetState().y + TILE_SIZE * 0.5f;
-        for (uint32_t i = 0; i < resp.state.count; ++i) {
-            const PlayerState& ps = resp.state.players[i];
+        for (uint32_t i = 0; i < state.count; ++i) {
+            const PlayerState& ps = state.players[i];
             if (ps.player_id == local_player_id_) {
                 listener_x = ps.x + TILE_SIZE * 0.5f;
                 listener_y = ps.y + TILE_SIZE * 0.5f;
                 break;
             }
         }
-        for (uint32_t i = 0; i < resp.state.count; i++) {
-            const PlayerState& ps = resp.state.players[i];
+        for (uint32_t i = 0; i < state.count; i++) {
+            const PlayerState& ps = state.players[i];
             if (ps.player_id == 0) continue;
             seen_players.insert(ps.player_id);
             auto it = prev_grabbed_state_.find(ps.player_id);
@@ -608,12 +715,12 @@ void GameSession::HandlePacket(const uint8_t* data, size_t size, NetworkClient&
             else ++it;
         }
 
-        last_game_state_ = resp.state;
+        last_game_state_ = state;
 
         // Aggiorna trail remoti e rileva eventi SFX — SOLO su nuovo tick autoritativo.
         // Gestire qui (non nel loop di Tick) evita falsi trigger ogni frame.
-        for (uint32_t i = 0; i < resp.state.count; i++) {
-            const PlayerState& rp = resp.state.players[i];
+        for (uint32_t i = 0; i < state.count; i++) {
+            const PlayerState& rp = state.players[i];
             if (rp.player_id == 0 || rp.player_id == local_player_id_) continue;
 
             // Prima apparizione: inizializza prev state senza suonare.
@@ -711,11 +818,14 @@ void GameSession::HandlePacket(const uint8_t* data, size_t size, NetworkClient&
 
         // Reconciliation
         if (local_player_id_ != 0) {
-            for (uint32_t i = 0; i < resp.state.count; i++) {
-                const PlayerState& auth = resp.state.players[i];
+            for (uint32_t i = 0; i < state.count; i++) {
+                const PlayerState& auth = state.players[i];
                 if (auth.player_id != local_player_id_) continue;
 
                 const uint32_t srv_tick = auth.last_processed_tick;
+                // Frames up to srv_tick reached the server: stop resending them.
+                if (srv_tick < sim_tick_ && srv_tick + 1 > input_unacked_)
+                    input_unacked_ = srv_tick + 1;
                 if (sim_tick_ > srv_tick && sim_tick_ - srv_tick < IHIST) {
                     player_.SetState(auth);
                     for (uint32_t t = srv_tick + 1; t < sim_tick_; t++) {
@@ -778,33 +888,126 @@ void GameSession::HandlePacket(const uint8_t* data, size_t size, NetworkClient&
         return;
     }
 
-    // PKT_LEVEL_DATA: generated level grid from server (chunk-based generator)
+    // PKT_LEVEL_DATA: generated level from server (packed grid, regions or chunk recipe)
     if (pkt_type == PKT_LEVEL_DATA && size >= sizeof(PktLevelDataHeader)) {
         PktLevelDataHeader hdr{};
         std::memcpy(&hdr, data, sizeof(hdr));
-        const size_t grid_size = static_cast<size_t>(hdr.width) * hdr.height;
-        if (size >= sizeof(PktLevelDataHeader) + grid_size && hdr.width > 0 && hdr.height > 0) {
+        World world;
+        stream_regions_left_ = 0;   // any level still streaming is superseded
+        if (hdr.is_last) {
             in_results_screen_        = false;
             in_global_results_screen_ = false;
-            if (hdr.is_last) {
-                end_message_ = "Game over.";
-                end_sub_msg_ = "Returning to main menu...";
-                end_color_   = CLRS_SESSION_OK;
-                session_over_ = true;
-            } else {
-                // Build rows from the char data that follows the header
-                const char* tile_data = reinterpret_cast<const char*>(data + sizeof(PktLevelDataHeader));
-                std::vector<std::string> rows(hdr.height);
-                for (int y = 0; y < hdr.height; ++y)
-                    rows[y].assign(tile_data + y * hdr.width, hdr.width);
-                current_level_ = hdr.level;  // set before LoadLevelFromGrid so MakeLevelPalette sees the correct level
-                LoadLevelFromGrid(hdr.width, hdr.height, rows);
-                generating_level_ = false;  // level data received — hide loading overlay
+            end_message_ = "Game over.";
+            end_sub_msg_ = "Returning to main menu...";
+            end_color_   = CLRS_SESSION_OK;
+            session_over_ = true;
+        } else if (!DecodeLevelPayload(data, size, hdr, world)) {
+            printf("[session] PKT_LEVEL_DATA level=%u not decodable --> full grid requested\n",
+                   (unsigned)hdr.level);
+            PktLevelRequest req{};
+            req.level = hdr.level;
+            net.Send(&req, sizeof(req));
+        } else {
+            in_results_screen_        = false;
+            in_global_results_screen_ = false;
+            current_level_ = hdr.level;  // set before LoadLevelFromWorld so MakeLevelPalette sees the correct level
+            level_epoch_   = hdr.epoch;
+            LoadLevelFromWorld(std::move(world));
+            generating_level_ = false;  // level data received — hide loading overlay
+            has_staged_level_ = false;  // a full level supersedes any pending stage
+            if (hdr.encoding == LEVEL_ENC_REGIONS) {
+                PktLevelRegionsInfo info{};
+                std::memcpy(&info, data + sizeof(hdr), sizeof(info));
+                stream_region_tiles_ = info.region_tiles;
+                stream_regions_left_ = info.total - info.count;
+                printf("[session] PKT_LEVEL_DATA level=%u  %ux%u: %u/%u regions, streaming the rest\n",
+                       (unsigned)hdr.level, (unsigned)hdr.width, (unsigned)hdr.height,
+                       (unsigned)info.count, (unsigned)info.total);
             }
         }
         return;
     }
 
+    // PKT_LEVEL_REGION: altre regioni del livello in streaming (le più vicine allo spawn
+    // sono già arrivate con PKT_LEVEL_DATA). Quelle di un livello precedente si scartano.
+    if (pkt_type == PKT_LEVEL_REGION && size >= sizeof(PktLevelRegion)) {
+        PktLevelRegion reg{};
+        std::memcpy(&reg, data, sizeof(reg));
+        if (stream_regions_left_ <= 0 || reg.epoch != level_epoch_ ||
+            reg.level != current_level_)
+            return;
+        if (reg.count > stream_regions_left_ ||
+            !DecodeRegionBlocks(data + sizeof(reg), size - sizeof(reg), reg.count,
+                                stream_region_tiles_, world_)) {
+            printf("[session] PKT_LEVEL_REGION level=%u malformed --> full grid requested\n",
+                   (unsigned)reg.level);
+            stream_regions_left_ = 0;
+            PktLevelRequest req{};
+            req.level = reg.level;
+            net.Send(&req, sizeof(req));
+            return;
+        }
+        stream_regions_left_ -= reg.count;
+        if (stream_regions_left_ == 0)
+            printf("[session] level %u: all regions received\n", (unsigned)reg.level);
+        return;
+    }
+
+    // PKT_LEVEL_STAGE: livello successivo pre-generato, inviato durante i risultati.
+    // Viene solo conservato; PKT_LEVEL_COMMIT lo applica senza ritrasferire la griglia.
+    // Se non è decodificabile il commit troverà lo stage mancante e chiederà la griglia.
+    if (pkt_type == PKT_LEVEL_STAGE && size >= sizeof(PktLevelDataHeader)) {
+        PktLevelDataHeader hdr{};
+        std::memcpy(&hdr, data, sizeof(hdr));
+        has_staged_level_ = false;
+        // Uno stage deve essere completo: le regioni arrivano solo con PKT_LEVEL_DATA.
+        if (hdr.encoding != LEVEL_ENC_REGIONS &&
+            DecodeLevelPayload(data, size, hdr, staged_world_)) {
+            staged_level_  = hdr.level;
+            has_staged_level_ = true;
+            printf("[session] PKT_LEVEL_STAGE level=%u  %ux%u\n",
+                   (unsigned)hdr.level, (unsigned)hdr.width, (unsigned)hdr.height);
+        }
+        return;
+    }
+
+    // PKT_LEVEL_COMMIT: passa al livello preparato con PKT_LEVEL_STAGE
+    if (pkt_type == PKT_LEVEL_COMMIT && size >= sizeof(PktLevelCommit)) {
+        PktLevelCommit commit{};
+        std::memcpy(&commit, data, sizeof(commit));
+        if (!has_staged_level_ || commit.level != staged_level_) {
+            printf("[session] PKT_LEVEL_COMMIT level=%u without matching stage --> full grid requested\n",
+                   (unsigned)commit.level);
+            PktLevelRequest req{};
+            req.level = commit.level;
+            net.Send(&req, sizeof(req));
+            return;
+        }
+        in_results_screen_        = false;
+        in_global_results_screen_ = false;
+        current_level_ = staged_level_;  // set before LoadLevelFromWorld (MakeLevelPalette)
+        level_epoch_   = commit.epoch;
+        LoadLevelFromWorld(std::move(staged_world_));
+        stream_regions_left_ = 0;
+        generating_level_ = false;
+        has_staged_level_ = false;
+        staged_world_ = World{};
+        return;
+    }
+
+    // PKT_ROSTER: tabella player_id → nome
+    if (pkt_type == PKT_ROSTER && size >= sizeof(PktRoster)) {
+        PktRoster roster{};
+        std::memcpy(&roster, data, sizeof(roster));
+        roster_names_.clear();
+        for (uint8_t i = 0; i < roster.count && i < static_cast<uint8_t>(MAX_PLAYERS); i++) {
+            RosterEntry e = roster.entries[i];
+            e.name[sizeof(e.name) - 1] = '\0';
+            roster_names_[e.player_id] = e;
+        }
+        return;
+    }
+
     // PKT_EMOTE_BROADCAST: remote player triggered an emote
     if (pkt_type == PKT_EMOTE_BROADCAST && size >= sizeof(PktEmoteBroadcast)) {
         PktEmoteBroadcast epkt{};
@@ -826,15 +1029,14 @@ void GameSession::HandlePacket(const uint8_t* data, size_t size, NetworkClient&
         return;
     }
 
-    // PKT_GENERATING: server is about to block its ENet loop for level generation.
-    // Show a loading overlay and extend our timeout so we don't disconnect.
+    // PKT_GENERATING: the server started generating the next level (worker thread;
+    // the connection stays serviced). Show a loading overlay until PKT_LEVEL_DATA.
     if (pkt_type == PKT_GENERATING && size >= sizeof(PktGenerating)) {
         PktGenerating gpkt{};
         std::memcpy(&gpkt, data, sizeof(gpkt));
         generating_level_     = true;
         generating_level_num_ = gpkt.level;
         generating_elapsed_   = 0.f;
-        net.SetLongTimeout(60000);  // 60 s — enough for any generation
         printf("[session] PKT_GENERATING level=%u\n", (unsigned)gpkt.level);
         return;
     }
@@ -862,7 +1064,8 @@ void GameSession::HandleDisconnect(uint32_t disconnect_data) {
 // LoadLevel — resetta lo stato effimero del livello corrente
 // ---------------------------------------------------------------------------
 void GameSession::LoadLevel(const char* path) {
-    world_.LoadFromFile(path);
+    LoadWorldFile(world_, path);
+    stream_regions_left_ = 0;
 
     // Lobby uses the default palette; any other file-based level also resets to default.
     palette_ = LevelPalette{};
@@ -885,8 +1088,9 @@ void GameSession::LoadLevel(const char* path) {
         last_safe_y_ = new_ps.y;
     }
 
-    sim_tick_    = 0;
-    accumulator_ = 0.f;
+    sim_tick_      = 0;
+    input_unacked_ = 0;
+    accumulator_   = 0.f;
 
     prev_finished_ = false;
     show_record_   = false;
@@ -921,10 +1125,10 @@ void GameSession::LoadLevel(const char* path) {
 }
 
 // ---------------------------------------------------------------------------
-// LoadLevelFromGrid — same as LoadLevel but from in-memory grid (generated levels)
+// LoadLevelFromWorld — same as LoadLevel but from a decoded World (generated levels)
 // ---------------------------------------------------------------------------
-void GameSession::LoadLevelFromGrid(int w, int h, const std::vector<std::string>& rows) {
-    world_.LoadFromGrid(w, h, rows);
+void GameSession::LoadLevelFromWorld(World&& world) {
+    world_ = std::move(world);
 
     // Generate a hue-rotated palette for this generated level.
     // current_level_ must be set before this call (done in HandlePacket).
@@ -944,8 +1148,9 @@ void GameSession::LoadLevelFromGrid(int w, int h, const std::vector<std::string>
     last_safe_x_ = new_ps.x;
     last_safe_y_ = new_ps.y;
 
-    sim_tick_    = 0;
-    accumulator_ = 0.f;
+    sim_tick_      = 0;
+    input_unacked_ = 0;
+    accumulator_   = 0.f;
 
     prev_finished_ = false;
     show_record_   = false;
@@ -7,6 +7,7 @@
 #include "World.h"
 #include "Player.h"
 #include "Protocol.h"
+#include "SnapshotDelta.h"
 #include "VisualEffects.h"
 #include "InputSampler.h"
 #include "NetworkClient.h"
@@ -55,6 +56,15 @@ private:
     static constexpr uint32_t IHIST = 128;   // input ring-buffer capacity for reconciliation
     InputFrame  input_history_[IHIST] = {};
     GameState   last_game_state_{};
+
+    // Decoded snapshots kept as delta baselines (slot = seq % SNAPSHOT_RING).
+    // Independent of level changes: the server's snapshot sequence never restarts.
+    GameState   snapshot_ring_[SNAPSHOT_RING] = {};
+    uint32_t    snapshot_ring_seq_[SNAPSHOT_RING] = {};
+    uint32_t    snapshot_ack_ = 0;   // newest decoded seq; echoed in every PKT_INPUT
+    uint32_t    input_unacked_ = 0;  // oldest tick the server has not confirmed (resent in PKT_INPUT)
+    uint8_t     level_epoch_   = 0;  // from PKT_WELCOME / PKT_LEVEL_DATA; echoed in PKT_INPUT
+    std::unordered_map<uint32_t, RosterEntry> roster_names_;   // player_id → name (PKT_ROSTER)
     InputSampler input_sampler_;
 
     float    accumulator_ = 0.f;
@@ -127,6 +137,15 @@ private:
     uint8_t generating_level_num_ = 0;
     float   generating_elapsed_   = 0.f;
 
+    // Level being streamed by region (LEVEL_ENC_REGIONS): PKT_LEVEL_REGION blocks still due.
+    int     stream_region_tiles_ = 0;
+    int     stream_regions_left_ = 0;
+
+    // Next level received ahead of time (PKT_LEVEL_STAGE); applied by PKT_LEVEL_COMMIT.
+    bool                     has_staged_level_ = false;
+    uint8_t                  staged_level_     = 0;
+    World                    staged_world_;
+
     // Queued disconnect reason received via PKT_VERSION_MISMATCH before the ENet DISCONNECT event.
     std::string pending_disc_reason_;
     std::string pending_disc_sub_;
@@ -156,7 +175,7 @@ private:
     void HandlePacket(const uint8_t* data, size_t size, NetworkClient& net);
     void HandleDisconnect(uint32_t disconnect_data);
     void LoadLevel(const char* path);
-    void LoadLevelFromGrid(int w, int h, const std::vector<std::string>& rows);
+    void LoadLevelFromWorld(World&& world);
     void UpdateLiveBestTicks();
     void BuildLiveLeaderboard(LiveLeaderEntry* out, int& count) const;
     void DoRender(float draw_x, float draw_y, float dt,
@@ -2,7 +2,7 @@
 // Se si sostituisce ENet con un'altra libreria, si riscrive solo questo file.
 
 #include "NetworkClient.h"
-#include "Protocol.h"   // CHANNEL_COUNT, CHANNEL_RELIABLE
+#include "Protocol.h"   // CHANNEL_COUNT, RoutePacket
 #include <enet/enet.h>
 #include <cstdio>
 #include <cstring>
@@ -66,16 +66,14 @@ void NetworkClient::Disconnect() {
     }
 }
 
-void NetworkClient::SendReliable(const void* data, size_t size) {
-    if (!peer_) return;
-    ENetPacket* pkt = enet_packet_create(data, size, ENET_PACKET_FLAG_RELIABLE);
-    enet_peer_send(PEER, CHANNEL_RELIABLE, pkt);
-}
-
-void NetworkClient::SendUnreliable(const void* data, size_t size) {
-    if (!peer_) return;
-    ENetPacket* pkt = enet_packet_create(data, size, 0);
-    enet_peer_send(PEER, CHANNEL_RELIABLE, pkt);
+void NetworkClient::Send(const void* data, size_t size) {
+    if (!peer_ || size < 1) return;
+    const PacketRoute route = RoutePacket(static_cast<const uint8_t*>(data)[0]);
+    enet_uint32 flags = 0;
+    if (route.delivery == Delivery::RELIABLE)    flags = ENET_PACKET_FLAG_RELIABLE;
+    if (route.delivery == Delivery::UNSEQUENCED) flags = ENET_PACKET_FLAG_UNSEQUENCED;
+    ENetPacket* pkt = enet_packet_create(data, size, flags);
+    enet_peer_send(PEER, route.channel, pkt);
 }
 
 NetEvent NetworkClient::Poll() {
@@ -114,13 +112,5 @@ uint32_t NetworkClient::GetLoss() const {
     return PEER->packetLoss * 100u / ENET_PEER_PACKET_LOSS_SCALE;
 }
 
-void NetworkClient::SetLongTimeout(uint32_t timeout_ms) {
-    if (!peer_) return;
-    // timeoutLimit=0 uses ENet's default retry count.
-    // timeoutMinimum and timeoutMaximum are both set to timeout_ms so the connection
-    // stays alive even when the server's ENet loop is blocked for extended periods.
-    enet_peer_timeout(PEER, 0, timeout_ms, timeout_ms);
-}
-
 #undef HOST
 #undef PEER
@@ -216,6 +216,7 @@ void Renderer::DrawTilemap(const World& world) {
             else if (c == 'K') col = palette_.kill_tile;
             else if (c == 'X') col = palette_.spawn;
             else if (c == 'C') col = palette_.checkpoint;
+            else if (c == World::PENDING_TILE) col = Fade(palette_.wall, 0.35f);  // region in arrivo
             else continue;
             DrawRectangle(tx * TILE_SIZE, ty * TILE_SIZE, TILE_SIZE, TILE_SIZE, col);
         }
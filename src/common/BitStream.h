@@ -0,0 +1,92 @@
+#pragma once
+// Header-only bit-level writer/reader for the packed wire formats (WireCodec, SnapshotDelta).
+// Bits are stored LSB-first inside each byte, so the encoding is identical on every host
+// regardless of endianness. No Raylib or ENet dependency.
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class BitWriter {
+public:
+    // Appends to out; any bytes already in out (e.g. a packet type byte) are kept.
+    explicit BitWriter(std::vector<uint8_t>& out) : out_(out) {}
+
+    // Write the low n bits of v (0 ≤ n ≤ 32).
+    void WriteBits(uint32_t v, int n) {
+        for (int i = 0; i < n; ++i) {
+            if (bit_ == 0) out_.push_back(0);
+            if ((v >> i) & 1u) out_.back() |= static_cast<uint8_t>(1u << bit_);
+            bit_ = (bit_ + 1) & 7;
+        }
+    }
+    void WriteBool(bool b) { WriteBits(b ? 1u : 0u, 1); }
+
+    // Two's complement in n bits; v must fit in [-2^(n-1), 2^(n-1)-1].
+    void WriteSigned(int32_t v, int n) { WriteBits(static_cast<uint32_t>(v), n); }
+
+    // Variable length: 4-bit groups, each followed by a continuation bit.
+    // Small values (< 16) cost 5 bits.
+    void WriteVarUint(uint32_t v) {
+        do {
+            WriteBits(v & 0xFu, 4);
+            v >>= 4;
+            WriteBool(v != 0);
+        } while (v != 0);
+    }
+    // Zig-zag mapping so small negative deltas stay small.
+    void WriteVarInt(int32_t v) {
+        WriteVarUint((static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31));
+    }
+
+private:
+    std::vector<uint8_t>& out_;
+    int bit_ = 0;   // next free bit in out_.back() (0 = start a new byte)
+};
+
+class BitReader {
+public:
+    BitReader(const uint8_t* data, size_t len) : data_(data), len_bits_(len * 8) {}
+
+    uint32_t ReadBits(int n) {
+        uint32_t v = 0;
+        for (int i = 0; i < n; ++i) {
+            if (pos_ >= len_bits_) { overflow_ = true; return 0; }
+            if ((data_[pos_ >> 3] >> (pos_ & 7)) & 1u) v |= 1u << i;
+            ++pos_;
+        }
+        return v;
+    }
+    bool ReadBool() { return ReadBits(1) != 0; }
+
+    int32_t ReadSigned(int n) {
+        const uint32_t v = ReadBits(n);
+        if (n < 32 && (v & (1u << (n - 1))))
+            return static_cast<int32_t>(v | ~((1u << n) - 1u));   // sign-extend
+        return static_cast<int32_t>(v);
+    }
+
+    uint32_t ReadVarUint() {
+        uint32_t v = 0;
+        for (int shift = 0; shift < 32; shift += 4) {
+            v |= ReadBits(4) << shift;
+            if (!ReadBool()) return v;
+        }
+        overflow_ = true;   // more than 8 groups: not produced by WriteVarUint
+        return 0;
+    }
+    int32_t ReadVarInt() {
+        const uint32_t z = ReadVarUint();
+        return static_cast<int32_t>((z >> 1) ^ (~(z & 1u) + 1u));
+    }
+
+    // True once any read ran past the end of the buffer.
+    bool Overflowed() const { return overflow_; }
+    // True when every remaining bit is padding of the final byte.
+    bool AtEnd() const { return len_bits_ - pos_ < 8; }
+
+private:
+    const uint8_t* data_;
+    size_t         len_bits_;
+    size_t         pos_      = 0;
+    bool           overflow_ = false;
+};
@@ -16,6 +16,6 @@ struct GameState {
     uint8_t     is_lobby                   = 0;   // 1 when the active map is _lobby.txt
     uint8_t     game_mode                  = static_cast<uint8_t>(GameMode::COOP);
     uint8_t     max_generated_levels       = 5;   // authoritative session setting (leader can change in lobby)
-    uint8_t     pad[1]                     = {};
+    uint8_t     level_epoch                = 0;   // PktLevelDataHeader::epoch of the level being simulated
     uint32_t    leader_id                  = 0;   // player_id of the current session leader
 };
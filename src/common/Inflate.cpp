@@ -0,0 +1,352 @@
+// Inflate.cpp — decoder DEFLATE canonico (blocchi stored, Huffman fissi e dinamici).
+// Struttura alla "puff" di zlib: tabelle count/symbol per lunghezza di codice,
+// decodifica bit a bit. Le mappe Tiled sono piccole, la semplicità vince sulla velocità.
+
+#include "Inflate.h"
+#include <array>
+
+namespace {
+
+constexpr int MAX_BITS  = 15;    // lunghezza massima di un codice Huffman
+constexpr int MAX_LCODES = 286;  // simboli letterale/lunghezza
+constexpr int MAX_DCODES = 30;   // simboli distanza
+constexpr int FIX_LCODES = 288;
+constexpr int FAST_BITS  = 9;    // codici fino a 9 bit risolti con una sola lookup
+
+struct Huffman {
+    std::array<uint16_t, MAX_BITS + 1>   count{};   // codici per lunghezza
+    std::array<uint16_t, FIX_LCODES>     symbol{};  // simboli ordinati per codice
+    std::array<uint16_t, 1 << FAST_BITS> fast{};    // prossimi 9 bit → (simbolo << 4) | lunghezza, 0 = slow path
+};
+
+class BitInput {
+public:
+    BitInput(const uint8_t* src, size_t len) : src_(src), len_(len) {}
+
+    // false once the input ran out (every later read returns zeros).
+    bool Ok() const { return ok_; }
+    // Bytes consumed so far (whole bytes still sitting in the bit buffer are not counted).
+    size_t Pos() const { return pos_ - static_cast<size_t>(bitcnt_ / 8); }
+
+    // Up to `need` bits without consuming them; returns how many are really there.
+    int Peek(int need, uint32_t& val) {
+        while (bitcnt_ < need && pos_ < len_) {
+            bitbuf_ |= static_cast<uint32_t>(src_[pos_++]) << bitcnt_;
+            bitcnt_ += 8;
+        }
+        val = bitbuf_ & ((1u << need) - 1);
+        return bitcnt_ < need ? bitcnt_ : need;
+    }
+    void Drop(int n) { bitbuf_ >>= n; bitcnt_ -= n; }
+
+    uint32_t Bits(int need) {
+        uint32_t val = bitbuf_;
+        while (bitcnt_ < need) {
+            if (pos_ >= len_) { ok_ = false; return 0; }
+            val |= static_cast<uint32_t>(src_[pos_++]) << bitcnt_;
+            bitcnt_ += 8;
+        }
+        bitbuf_ = val >> need;
+        bitcnt_ -= need;
+        return val & ((1u << need) - 1);
+    }
+
+    // Drops the partial byte; whole bytes buffered by Peek() go back to the stream.
+    void AlignToByte() { pos_ -= static_cast<size_t>(bitcnt_ / 8); bitbuf_ = 0; bitcnt_ = 0; }
+
+    bool Bytes(size_t n, std::vector<uint8_t>& out) {
+        if (len_ - pos_ < n) { ok_ = false; return false; }
+        out.insert(out.end(), src_ + pos_, src_ + pos_ + n);
+        pos_ += n;
+        return true;
+    }
+
+    bool U16(uint16_t& v) {
+        if (len_ - pos_ < 2) { ok_ = false; return false; }
+        v = static_cast<uint16_t>(src_[pos_] | (src_[pos_ + 1] << 8));
+        pos_ += 2;
+        return true;
+    }
+
+private:
+    const uint8_t* src_;
+    size_t   len_;
+    size_t   pos_    = 0;
+    uint32_t bitbuf_ = 0;
+    int      bitcnt_ = 0;
+    bool     ok_     = true;
+};
+
+// Decodifica un simbolo (codici Huffman canonici, bit più significativo prima).
+int Decode(BitInput& in, const Huffman& h) {
+    uint32_t peek = 0;
+    const int avail = in.Peek(FAST_BITS, peek);
+    const uint16_t e = h.fast[peek];
+    if (e != 0 && (e & 15) <= avail) { in.Drop(e & 15); return e >> 4; }
+
+    int code = 0, first = 0, index = 0;
+    for (int len = 1; len <= MAX_BITS; ++len) {
+        code |= static_cast<int>(in.Bits(1));
+        const int count = h.count[len];
+        if (code - count < first) return h.symbol[index + (code - first)];
+        index += count;
+        first += count;
+        first <<= 1;
+        code  <<= 1;
+    }
+    return -1;   // codice non valido o input esaurito
+}
+
+// Costruisce la tabella da n lunghezze di codice. Ritorna < 0 se il set è sovra-sottoscritto.
+int Construct(Huffman& h, const uint16_t* length, int n) {
+    h.count.fill(0);
+    h.fast.fill(0);
+    for (int s = 0; s < n; ++s) h.count[length[s]]++;
+    if (h.count[0] == n) return 0;   // nessun codice: completo ma vuoto
+
+    int left = 1;
+    for (int len = 1; len <= MAX_BITS; ++len) {
+        left <<= 1;
+        left -= h.count[len];
+        if (left < 0) return left;
+    }
+
+    std::array<uint16_t, MAX_BITS + 1> offs{};
+    for (int len = 1; len < MAX_BITS; ++len) offs[len + 1] = offs[len] + h.count[len];
+    for (int s = 0; s < n; ++s)
+        if (length[s] != 0) h.symbol[offs[length[s]]++] = static_cast<uint16_t>(s);
+
+    // Tabella rapida: i codici corti, letti LSB-first, sono il loro codice canonico rovesciato.
+    std::array<uint16_t, MAX_BITS + 1> next{};
+    for (int len = 1, code = 0; len <= MAX_BITS; ++len) {
+        code = (code + (len > 1 ? h.count[len - 1] : 0)) << 1;
+        next[len] = static_cast<uint16_t>(code);
+    }
+    for (int s = 0; s < n; ++s) {
+        const int len = length[s];
+        if (len == 0 || len > FAST_BITS) continue;
+        const uint32_t code = next[len]++;
+        uint32_t rev = 0;
+        for (int b = 0; b < len; ++b) rev |= ((code >> b) & 1u) << (len - 1 - b);
+        for (uint32_t i = rev; i < (1u << FAST_BITS); i += 1u << len)
+            h.fast[i] = static_cast<uint16_t>((s << 4) | len);
+    }
+    return left;
+}
+
+constexpr uint16_t LEN_BASE[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+constexpr uint16_t LEN_EXTRA[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+constexpr uint16_t DIST_BASE[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+constexpr uint16_t DIST_EXTRA[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+bool Codes(BitInput& in, std::vector<uint8_t>& out, size_t base,
+           const Huffman& lencode, const Huffman& distcode) {
+    while (true) {
+        const int sym = Decode(in, lencode);
+        if (sym < 0 || !in.Ok()) return false;
+        if (sym < 256) { out.push_back(static_cast<uint8_t>(sym)); continue; }
+        if (sym == 256) return true;
+
+        const int li = sym - 257;
+        if (li >= 29) return false;
+        const size_t len = LEN_BASE[li] + in.Bits(LEN_EXTRA[li]);
+        const int di = Decode(in, distcode);
+        if (di < 0 || di >= 30) return false;
+        const size_t dist = DIST_BASE[di] + in.Bits(DIST_EXTRA[di]);
+        if (!in.Ok() || dist > out.size() - base) return false;
+        // Copia byte a byte: le sorgenti possono sovrapporsi alla destinazione.
+        const size_t at = out.size();
+        out.resize(at + len);
+        uint8_t*       d   = out.data() + at;
+        const uint8_t* src = d - dist;
+        for (size_t i = 0; i < len; ++i) d[i] = src[i];
+    }
+}
+
+bool Stored(BitInput& in, std::vector<uint8_t>& out) {
+    in.AlignToByte();
+    uint16_t len = 0, nlen = 0;
+    if (!in.U16(len) || !in.U16(nlen) || len != static_cast<uint16_t>(~nlen)) return false;
+    return in.Bytes(len, out);
+}
+
+bool Fixed(BitInput& in, std::vector<uint8_t>& out, size_t base) {
+    static const std::array<Huffman, 2> tables = [] {
+        std::array<Huffman, 2> t{};
+        uint16_t lengths[FIX_LCODES];
+        int s = 0;
+        for (; s < 144; ++s) lengths[s] = 8;
+        for (; s < 256; ++s) lengths[s] = 9;
+        for (; s < 280; ++s) lengths[s] = 7;
+        for (; s < FIX_LCODES; ++s) lengths[s] = 8;
+        Construct(t[0], lengths, FIX_LCODES);
+        for (s = 0; s < MAX_DCODES; ++s) lengths[s] = 5;
+        Construct(t[1], lengths, MAX_DCODES);
+        return t;
+    }();
+    return Codes(in, out, base, tables[0], tables[1]);
+}
+
+bool Dynamic(BitInput& in, std::vector<uint8_t>& out, size_t base) {
+    static constexpr uint8_t ORDER[19] = {
+        16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+    const int nlen  = static_cast<int>(in.Bits(5)) + 257;
+    const int ndist = static_cast<int>(in.Bits(5)) + 1;
+    const int ncode = static_cast<int>(in.Bits(4)) + 4;
+    if (!in.Ok() || nlen > MAX_LCODES || ndist > MAX_DCODES) return false;
+
+    uint16_t lengths[MAX_LCODES + MAX_DCODES] = {};
+    for (int i = 0; i < ncode; ++i) lengths[ORDER[i]] = static_cast<uint16_t>(in.Bits(3));
+
+    Huffman lencode, distcode;
+    if (Construct(lencode, lengths, 19) != 0) return false;   // deve essere completo
+
+    for (int i = 0; i < nlen + ndist; ) {
+        int sym = Decode(in, lencode);
+        if (sym < 0 || !in.Ok()) return false;
+        if (sym < 16) { lengths[i++] = static_cast<uint16_t>(sym); continue; }
+        uint16_t len = 0;
+        int repeat;
+        if (sym == 16) {
+            if (i == 0) return false;
+            len    = lengths[i - 1];
+            repeat = 3 + static_cast<int>(in.Bits(2));
+        } else if (sym == 17) {
+            repeat = 3 + static_cast<int>(in.Bits(3));
+        } else {
+            repeat = 11 + static_cast<int>(in.Bits(7));
+        }
+        if (i + repeat > nlen + ndist) return false;
+        while (repeat--) lengths[i++] = len;
+    }
+    if (lengths[256] == 0) return false;   // manca il codice di fine blocco
+
+    // Codici incompleti ammessi solo per set da un singolo codice (come zlib).
+    int err = Construct(lencode, lengths, nlen);
+    if (err < 0 || (err > 0 && nlen - lencode.count[0] != 1)) return false;
+    err = Construct(distcode, lengths + nlen, ndist);
+    if (err < 0 || (err > 0 && ndist - distcode.count[0] != 1)) return false;
+
+    return Codes(in, out, base, lencode, distcode);
+}
+
+bool InflateStream(BitInput& in, std::vector<uint8_t>& out) {
+    const size_t base = out.size();   // i back-reference non escono dal nostro output
+    int last = 0;
+    do {
+        last = static_cast<int>(in.Bits(1));
+        const uint32_t type = in.Bits(2);
+        if (!in.Ok()) return false;
+        bool ok;
+        switch (type) {
+            case 0:  ok = Stored (in, out);       break;
+            case 1:  ok = Fixed  (in, out, base); break;
+            case 2:  ok = Dynamic(in, out, base); break;
+            default: ok = false;                  break;
+        }
+        if (!ok) return false;
+    } while (!last);
+    return true;
+}
+
+uint32_t Adler32(const uint8_t* p, size_t n) {
+    // Modulo rimandato: 5552 è il blocco più lungo per cui b non supera 32 bit.
+    uint32_t a = 1, b = 0;
+    while (n > 0) {
+        const size_t block = n < 5552 ? n : 5552;
+        for (size_t i = 0; i < block; ++i) {
+            a += p[i];
+            b += a;
+        }
+        a %= 65521u;
+        b %= 65521u;
+        p += block;
+        n -= block;
+    }
+    return (b << 16) | a;
+}
+
+uint32_t Crc32(const uint8_t* p, size_t n) {
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    uint32_t c = 0xFFFFFFFFu;
+    for (size_t i = 0; i < n; ++i) c = table[(c ^ p[i]) & 0xFF] ^ (c >> 8);
+    return c ^ 0xFFFFFFFFu;
+}
+
+uint32_t ReadBE32(const uint8_t* p) {
+    return (uint32_t{p[0]} << 24) | (uint32_t{p[1]} << 16) | (uint32_t{p[2]} << 8) | p[3];
+}
+
+uint32_t ReadLE32(const uint8_t* p) {
+    return uint32_t{p[0]} | (uint32_t{p[1]} << 8) | (uint32_t{p[2]} << 16) | (uint32_t{p[3]} << 24);
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// InflateRaw
+// ---------------------------------------------------------------------------
+bool InflateRaw(const uint8_t* src, size_t len, std::vector<uint8_t>& out) {
+    BitInput in(src, len);
+    return InflateStream(in, out);
+}
+
+// ---------------------------------------------------------------------------
+// InflateZlib — CMF/FLG, niente dizionario preimpostato, Adler-32 in coda
+// ---------------------------------------------------------------------------
+bool InflateZlib(const uint8_t* src, size_t len, std::vector<uint8_t>& out) {
+    if (len < 6) return false;
+    const uint8_t cmf = src[0], flg = src[1];
+    if ((cmf & 0x0F) != 8 || ((cmf << 8) | flg) % 31 != 0 || (flg & 0x20)) return false;
+
+    const size_t base = out.size();
+    BitInput in(src + 2, len - 2);
+    if (!InflateStream(in, out)) return false;
+    const size_t end = 2 + in.Pos();
+    if (len - end < 4) return false;
+    return ReadBE32(src + end) == Adler32(out.data() + base, out.size() - base);
+}
+
+// ---------------------------------------------------------------------------
+// InflateGzip — header RFC 1952 (campi opzionali saltati), CRC-32 + ISIZE in coda
+// ---------------------------------------------------------------------------
+bool InflateGzip(const uint8_t* src, size_t len, std::vector<uint8_t>& out) {
+    if (len < 18 || src[0] != 0x1F || src[1] != 0x8B || src[2] != 8) return false;
+    const uint8_t flags = src[3];
+    size_t pos = 10;
+    if (flags & 0x04) {                                   // FEXTRA
+        if (len - pos < 2) return false;
+        pos += 2 + (src[pos] | (src[pos + 1] << 8));
+    }
+    for (uint8_t bit : { uint8_t{0x08}, uint8_t{0x10} }) { // FNAME, FCOMMENT
+        if (!(flags & bit)) continue;
+        while (pos < len && src[pos] != 0) ++pos;
+        ++pos;
+    }
+    if (flags & 0x02) pos += 2;                           // FHCRC
+    if (pos >= len) return false;
+
+    const size_t base = out.size();
+    BitInput in(src + pos, len - pos);
+    if (!InflateStream(in, out)) return false;
+    const size_t end = pos + in.Pos();
+    if (len - end < 8) return false;
+    const size_t n = out.size() - base;
+    return ReadLE32(src + end) == Crc32(out.data() + base, n) &&
+           ReadLE32(src + end + 4) == static_cast<uint32_t>(n);
+}
@@ -0,0 +1,15 @@
+#pragma once
+// Small DEFLATE decoder (RFC 1951) with zlib (RFC 1950) and gzip (RFC 1952) wrappers.
+// Enough for Tiled's compressed tile layers; no external zlib. No Raylib or ENet dependency.
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Raw DEFLATE stream → appended to out. false on malformed or truncated input.
+bool InflateRaw (const uint8_t* src, size_t len, std::vector<uint8_t>& out);
+
+// zlib stream (2-byte header, Adler-32 trailer checked).
+bool InflateZlib(const uint8_t* src, size_t len, std::vector<uint8_t>& out);
+
+// gzip member (header fields skipped, CRC-32 and size trailer checked).
+bool InflateGzip(const uint8_t* src, size_t len, std::vector<uint8_t>& out);
@@ -0,0 +1,342 @@
+// LevelCodec.cpp — palette 3 bit + RLE per riga + range coder binario adattivo.
+
+#include "LevelCodec.h"
+#include <algorithm>
+#include <array>
+#include <utility>
+
+namespace {
+
+// ---------------------------------------------------------------------------
+// Range coder binario (schema LZMA): probabilità a 11 bit, adattamento con shift 5.
+// ---------------------------------------------------------------------------
+constexpr int      PROB_BITS  = 11;
+constexpr uint16_t PROB_INIT  = 1u << (PROB_BITS - 1);
+constexpr int      MOVE_BITS  = 5;
+constexpr uint32_t TOP        = 1u << 24;
+
+class RangeEncoder {
+public:
+    explicit RangeEncoder(std::vector<uint8_t>& out) : out_(out) {}
+
+    void Encode(uint16_t& p, int bit) {
+        const uint32_t bound = (range_ >> PROB_BITS) * p;
+        if (!bit) {
+            range_ = bound;
+            p += ((1u << PROB_BITS) - p) >> MOVE_BITS;
+        } else {
+            low_   += bound;
+            range_ -= bound;
+            p -= p >> MOVE_BITS;
+        }
+        while (range_ < TOP) { range_ <<= 8; ShiftLow(); }
+    }
+
+    void Flush() { for (int i = 0; i < 5; ++i) ShiftLow(); }
+
+private:
+    void ShiftLow() {
+        if (static_cast<uint32_t>(low_) < 0xFF000000u || (low_ >> 32) != 0) {
+            const uint8_t carry = static_cast<uint8_t>(low_ >> 32);
+            uint8_t temp = cache_;
+            do {
+                out_.push_back(static_cast<uint8_t>(temp + carry));
+                temp = 0xFF;
+            } while (--cache_size_ != 0);
+            cache_ = static_cast<uint8_t>(low_ >> 24);
+        }
+        ++cache_size_;
+        low_ = (low_ & 0x00FFFFFFu) << 8;
+    }
+
+    std::vector<uint8_t>& out_;
+    uint64_t low_        = 0;
+    uint32_t range_      = 0xFFFFFFFFu;
+    uint8_t  cache_      = 0;
+    uint64_t cache_size_ = 1;
+};
+
+class RangeDecoder {
+public:
+    RangeDecoder(const uint8_t* data, size_t len) : data_(data), len_(len) {
+        for (int i = 0; i < 5; ++i) code_ = (code_ << 8) | NextByte();
+    }
+
+    int Decode(uint16_t& p) {
+        const uint32_t bound = (range_ >> PROB_BITS) * p;
+        int bit;
+        if (code_ < bound) {
+            range_ = bound;
+            p += ((1u << PROB_BITS) - p) >> MOVE_BITS;
+            bit = 0;
+        } else {
+            code_  -= bound;
+            range_ -= bound;
+            p -= p >> MOVE_BITS;
+            bit = 1;
+        }
+        while (range_ < TOP) { range_ <<= 8; code_ = (code_ << 8) | NextByte(); }
+        return bit;
+    }
+
+    // More than the encoder's 4 flush bytes read past the end: truncated input.
+    bool Overflowed() const { return pos_ > len_ + 4; }
+
+private:
+    uint8_t NextByte() { return pos_ < len_ ? data_[pos_++] : (++pos_, 0); }
+
+    const uint8_t* data_;
+    size_t         len_;
+    size_t         pos_   = 0;
+    uint32_t       code_  = 0;
+    uint32_t       range_ = 0xFFFFFFFFu;
+};
+
+// ---------------------------------------------------------------------------
+// Modelli di contesto condivisi da encoder e decoder.
+// ---------------------------------------------------------------------------
+constexpr int LEN_MAX_BITS = 16;   // run fino a 2^17 - 1 tile (larghezza uint16)
+
+struct Models {
+    std::array<uint16_t, 2> same_row;                                   // ctx: flag riga precedente
+    std::array<std::array<uint16_t, 8>, LEVEL_CODEC_MAX_PALETTE + 1> tile; // ctx: tile run precedente
+    std::array<std::array<uint16_t, LEN_MAX_BITS + 1>, LEVEL_CODEC_MAX_PALETTE> len_prefix;
+    std::array<std::array<uint16_t, LEN_MAX_BITS>, LEN_MAX_BITS + 1> len_bits;
+
+    Models() {
+        same_row.fill(PROB_INIT);
+        for (auto& a : tile)       a.fill(PROB_INIT);
+        for (auto& a : len_prefix) a.fill(PROB_INIT);
+        for (auto& a : len_bits)   a.fill(PROB_INIT);
+    }
+};
+
+constexpr int ROW_START = LEVEL_CODEC_MAX_PALETTE;   // contesto "primo run della riga"
+
+void EncodeTile(RangeEncoder& rc, Models& m, int ctx, int tile) {
+    int node = 1;
+    for (int b = 2; b >= 0; --b) {
+        const int bit = (tile >> b) & 1;
+        rc.Encode(m.tile[ctx][node], bit);
+        node = (node << 1) | bit;
+    }
+}
+
+int DecodeTile(RangeDecoder& rc, Models& m, int ctx) {
+    int node = 1;
+    for (int b = 0; b < 3; ++b) node = (node << 1) | rc.Decode(m.tile[ctx][node]);
+    return node - 8;
+}
+
+// Exp-Golomb: v+1 = 1xxxx (n bit dopo l'1). n in unario, poi i bit con modello per (n, pos).
+void EncodeLength(RangeEncoder& rc, Models& m, int tile, uint32_t v) {
+    const uint32_t x = v + 1;
+    int n = 0;
+    while ((x >> (n + 1)) != 0) ++n;
+    for (int i = 0; i < n; ++i) rc.Encode(m.len_prefix[tile][i], 1);
+    if (n < LEN_MAX_BITS) rc.Encode(m.len_prefix[tile][n], 0);
+    for (int i = n - 1; i >= 0; --i) rc.Encode(m.len_bits[n][i], (x >> i) & 1);
+}
+
+uint32_t DecodeLength(RangeDecoder& rc, Models& m, int tile) {
+    int n = 0;
+    while (n < LEN_MAX_BITS && rc.Decode(m.len_prefix[tile][n])) ++n;
+    uint32_t x = 1;
+    for (int i = n - 1; i >= 0; --i) x = (x << 1) | static_cast<uint32_t>(rc.Decode(m.len_bits[n][i]));
+    return x - 1;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// EncodeLevelGrid
+// ---------------------------------------------------------------------------
+bool EncodeLevelGrid(const std::vector<std::string>& rows, int w, int h,
+                     std::vector<uint8_t>& out) {
+    if (w <= 0 || h <= 0 || static_cast<int>(rows.size()) < h) return false;
+
+    // Palette: tile presenti, in ordine crescente (deterministico).
+    std::array<bool, 256> used{};
+    for (int y = 0; y < h; ++y) {
+        if (static_cast<int>(rows[y].size()) < w) return false;
+        for (int x = 0; x < w; ++x) used[static_cast<uint8_t>(rows[y][x])] = true;
+    }
+    std::array<int, 256> index{};
+    std::vector<uint8_t> palette;
+    for (int c = 0; c < 256; ++c) {
+        if (!used[c]) continue;
+        if (static_cast<int>(palette.size()) == LEVEL_CODEC_MAX_PALETTE) return false;
+        index[c] = static_cast<int>(palette.size());
+        palette.push_back(static_cast<uint8_t>(c));
+    }
+
+    out.push_back(static_cast<uint8_t>(palette.size()));
+    out.insert(out.end(), palette.begin(), palette.end());
+
+    RangeEncoder rc(out);
+    Models m;
+    int prev_same = 0;
+    for (int y = 0; y < h; ++y) {
+        const int same = (y > 0 && rows[y].compare(0, w, rows[y - 1], 0, w) == 0) ? 1 : 0;
+        rc.Encode(m.same_row[prev_same], same);
+        prev_same = same;
+        if (same) continue;
+
+        int ctx = ROW_START;
+        for (int x = 0; x < w; ) {
+            const char ch = rows[y][x];
+            int run = 1;
+            while (x + run < w && rows[y][x + run] == ch) ++run;
+            const int tile = index[static_cast<uint8_t>(ch)];
+            EncodeTile(rc, m, ctx, tile);
+            EncodeLength(rc, m, tile, static_cast<uint32_t>(run - 1));
+            ctx = tile;
+            x += run;
+        }
+    }
+    rc.Flush();
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// DecodeLevelRows — griglia packed → righe di tile (w x h)
+// ---------------------------------------------------------------------------
+static bool DecodeLevelRows(const uint8_t* data, size_t len, int w, int h,
+                            std::vector<std::string>& rows) {
+    if (w <= 0 || h <= 0 || len < 1) return false;
+    const int pal_size = data[0];
+    if (pal_size < 1 || pal_size > LEVEL_CODEC_MAX_PALETTE ||
+        len < 1 + static_cast<size_t>(pal_size)) return false;
+    const uint8_t* palette = data + 1;
+
+    RangeDecoder rc(data + 1 + pal_size, len - 1 - pal_size);
+    Models m;
+    rows.assign(h, std::string());
+    int prev_same = 0;
+    for (int y = 0; y < h; ++y) {
+        const int same = rc.Decode(m.same_row[prev_same]);
+        prev_same = same;
+        if (same) {
+            if (y == 0) return false;
+            rows[y] = rows[y - 1];
+            continue;
+        }
+
+        rows[y].reserve(w);
+        int ctx = ROW_START;
+        while (static_cast<int>(rows[y].size()) < w) {
+            const int tile = DecodeTile(rc, m, ctx);
+            if (tile >= pal_size) return false;
+            const uint32_t run = DecodeLength(rc, m, tile) + 1;
+            if (run > static_cast<uint32_t>(w) - rows[y].size()) return false;
+            rows[y].append(run, static_cast<char>(palette[tile]));
+            ctx = tile;
+        }
+        if (rc.Overflowed()) return false;
+    }
+    return !rc.Overflowed();
+}
+
+// ---------------------------------------------------------------------------
+// DecodeLevelGrid
+// ---------------------------------------------------------------------------
+bool DecodeLevelGrid(const uint8_t* data, size_t len, int w, int h, World& world) {
+    std::vector<std::string> rows;
+    return DecodeLevelRows(data, len, w, h, rows) && world.LoadFromGrid(w, h, rows);
+}
+
+// ---------------------------------------------------------------------------
+// EncodeLevelRegions
+// ---------------------------------------------------------------------------
+bool EncodeLevelRegions(const std::vector<std::string>& rows, int w, int h,
+                        int region_tiles, int focus_x, int focus_y,
+                        std::vector<LevelRegion>& out) {
+    if (w <= 0 || h <= 0 || region_tiles <= 0 || static_cast<int>(rows.size()) < h) return false;
+    const int nx = (w + region_tiles - 1) / region_tiles;
+    const int ny = (h + region_tiles - 1) / region_tiles;
+    if (nx > 0xFFFF || ny > 0xFFFF) return false;
+
+    std::vector<LevelRegion> regions;
+    regions.reserve(static_cast<size_t>(nx) * ny);
+    std::vector<std::string> sub;
+    for (int ry = 0; ry < ny; ++ry) {
+        for (int rx = 0; rx < nx; ++rx) {
+            const int x0 = rx * region_tiles;
+            const int y0 = ry * region_tiles;
+            const int rw = std::min(region_tiles, w - x0);
+            const int rh = std::min(region_tiles, h - y0);
+            sub.assign(rh, std::string());
+            for (int y = 0; y < rh; ++y) {
+                if (static_cast<int>(rows[y0 + y].size()) < w) return false;
+                sub[y].assign(rows[y0 + y], x0, rw);
+            }
+            LevelRegion r;
+            r.rx = static_cast<uint16_t>(rx);
+            r.ry = static_cast<uint16_t>(ry);
+            if (!EncodeLevelGrid(sub, rw, rh, r.packed)) return false;
+            regions.push_back(std::move(r));
+        }
+    }
+
+    // Distanza (al quadrato, in regioni) dalla regione che contiene il focus.
+    const int fx = std::clamp(focus_x, 0, w - 1) / region_tiles;
+    const int fy = std::clamp(focus_y, 0, h - 1) / region_tiles;
+    auto dist = [&](const LevelRegion& r) {
+        const int dx = r.rx - fx, dy = r.ry - fy;
+        return dx * dx + dy * dy;
+    };
+    std::stable_sort(regions.begin(), regions.end(),
+                     [&](const LevelRegion& a, const LevelRegion& b) { return dist(a) < dist(b); });
+    out = std::move(regions);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// AppendRegionBlock — u16 rx, u16 ry, u16 len, len byte (little-endian)
+// ---------------------------------------------------------------------------
+size_t RegionBlockSize(const LevelRegion& region) {
+    return 6 + region.packed.size();
+}
+
+void AppendRegionBlock(const LevelRegion& region, std::vector<uint8_t>& out) {
+    const uint16_t len = static_cast<uint16_t>(region.packed.size());
+    const uint16_t fields[3] = { region.rx, region.ry, len };
+    for (uint16_t v : fields) {
+        out.push_back(static_cast<uint8_t>(v));
+        out.push_back(static_cast<uint8_t>(v >> 8));
+    }
+    out.insert(out.end(), region.packed.begin(), region.packed.end());
+}
+
+// ---------------------------------------------------------------------------
+// DecodeRegionBlocks
+// ---------------------------------------------------------------------------
+bool DecodeRegionBlocks(const uint8_t* data, size_t len, int count, int region_tiles,
+                        World& world) {
+    if (region_tiles <= 0 || count < 0) return false;
+    const int w = world.GetWidth();
+    const int h = world.GetHeight();
+    std::vector<std::string> rows;
+    size_t pos = 0;
+    for (int i = 0; i < count; ++i) {
+        if (len - pos < 6) return false;
+        auto u16 = [&](size_t at) {
+            return static_cast<int>(data[at] | (data[at + 1] << 8));
+        };
+        const int    rx    = u16(pos);
+        const int    ry    = u16(pos + 2);
+        const size_t bytes = static_cast<size_t>(u16(pos + 4));
+        pos += 6;
+        if (len - pos < bytes) return false;
+
+        const int x0 = rx * region_tiles;
+        const int y0 = ry * region_tiles;
+        if (x0 >= w || y0 >= h) return false;
+        const int rw = std::min(region_tiles, w - x0);
+        const int rh = std::min(region_tiles, h - y0);
+        if (!DecodeLevelRows(data + pos, bytes, rw, rh, rows)) return false;
+        world.BlitRows(x0, y0, rows);
+        pos += bytes;
+    }
+    return pos == len;
+}
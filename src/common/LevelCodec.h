@@ -0,0 +1,58 @@
+#pragma once
+// Compressed tile grid for PKT_LEVEL_DATA / PKT_LEVEL_STAGE (LEVEL_ENC_PACKED).
+// No Raylib or ENet dependency.
+//
+// Layout:
+//   u8          palette size P (1..8), then P tile chars (ascending)
+//   range-coded stream (adaptive binary models, no tables on the wire):
+//     per row   1 bit "identical to the previous row" (border and margin rows)
+//     otherwise runs until the row is full:
+//               tile index   3-bit binary tree, context = previous run's tile
+//               length - 1   Exp-Golomb binarisation, context = tile index
+//
+// Generated levels are a few long runs of air and solid per row framed by the
+// border, so a grid of ~14 KB packs into a few hundred bytes.
+#include "World.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Palette entries fit in 3 bits.
+inline constexpr int LEVEL_CODEC_MAX_PALETTE = 8;
+
+// Append the packed grid to out. Returns false (out unchanged) when rows use more than
+// LEVEL_CODEC_MAX_PALETTE distinct tiles or do not match w x h; send the raw grid then.
+bool EncodeLevelGrid(const std::vector<std::string>& rows, int w, int h,
+                     std::vector<uint8_t>& out);
+
+// Decode a packed w x h grid and load it into world (World::LoadFromGrid).
+// Returns false on truncated or malformed input; world is then unchanged.
+bool DecodeLevelGrid(const uint8_t* data, size_t len, int w, int h, World& world);
+
+// ---------------------------------------------------------------------------
+// Region streaming (LEVEL_ENC_REGIONS / PKT_LEVEL_REGION)
+// ---------------------------------------------------------------------------
+// The grid split into region_tiles x region_tiles blocks (right/bottom ones clipped),
+// each packed on its own with EncodeLevelGrid. Wire block: u16 rx, u16 ry, u16 len,
+// then len packed bytes (little-endian).
+struct LevelRegion {
+    uint16_t rx = 0;                 // region column (first tile x = rx * region_tiles)
+    uint16_t ry = 0;                 // region row
+    std::vector<uint8_t> packed;     // EncodeLevelGrid of the block
+};
+
+// Every region of the grid, nearest to tile (focus_x, focus_y) first (spawn area first).
+// false if a region cannot be packed (see EncodeLevelGrid).
+bool EncodeLevelRegions(const std::vector<std::string>& rows, int w, int h,
+                        int region_tiles, int focus_x, int focus_y,
+                        std::vector<LevelRegion>& out);
+
+size_t RegionBlockSize  (const LevelRegion& region);                             // bytes on the wire
+void   AppendRegionBlock(const LevelRegion& region, std::vector<uint8_t>& out);
+
+// Decode exactly count blocks filling data[0, len) and blit them into world, which must
+// already have the level's size (World::InitPending). false on malformed input; blocks
+// decoded before the error stay applied.
+bool DecodeRegionBlocks(const uint8_t* data, size_t len, int count, int region_tiles,
+                        World& world);
@@ -2,12 +2,20 @@
 #include "InputFrame.h"
 #include "World.h"
 #include "Physics.h"
+#include "WireCodec.h"  // QuantizePlayerState
 #include <cmath>    // fabsf, sqrtf
 
 // ---------------------------------------------------------------------------
 // Simulate — punto unico di aggiornamento (passo 9)
 // ---------------------------------------------------------------------------
 void Player::Simulate(const InputFrame& frame, const World& world) {
+    SimulateTick(frame, world);
+    // Lo stato resta sulla griglia del wire codec: client e server partono dagli
+    // stessi valori che il client ricostruisce da un PKT_GAME_STATE.
+    QuantizePlayerState(state_);
+}
+
+void Player::SimulateTick(const InputFrame& frame, const World& world) {
     // Registra il tick processato per permettere la reconciliation lato client.
     state_.last_processed_tick = frame.tick;
 
@@ -229,20 +237,12 @@ void Player::ResolveCollisionsX(const World& world, float dx) {
     // --- Snap (solo se ci si sta muovendo verso quel lato) ---
     if (dx > 0.f) {
         int tx = static_cast<int>(state_.x + TILE_SIZE - 1) / TILE_SIZE;
-        for (int ty = ty_top; ty <= ty_bot; ty++) {
-            if (world.IsSolid(tx, ty)) {
-                state_.x = static_cast<float>(tx * TILE_SIZE - TILE_SIZE);
-                break;
-            }
-        }
+        if (world.AnySolidInColumn(tx, ty_top, ty_bot))
+            state_.x = static_cast<float>(tx * TILE_SIZE - TILE_SIZE);
     } else if (dx < 0.f) {
         int tx = static_cast<int>(state_.x) / TILE_SIZE;
-        for (int ty = ty_top; ty <= ty_bot; ty++) {
-            if (world.IsSolid(tx, ty)) {
-                state_.x = static_cast<float>((tx + 1) * TILE_SIZE);
-                break;
-            }
-        }
+        if (world.AnySolidInColumn(tx, ty_top, ty_bot))
+            state_.x = static_cast<float>((tx + 1) * TILE_SIZE);
     }
 
     // --- Wall probe: rileva muri entro WALL_PROBE_REACH px dal bordo del player ---
@@ -252,14 +252,12 @@ void Player::ResolveCollisionsX(const World& world, float dx) {
     {
         // Tile a destra: primo pixel =  bordo destro + WALL_PROBE_REACH
         int tx_r = static_cast<int>(state_.x + TILE_SIZE + WALL_PROBE_REACH) / TILE_SIZE;
-        for (int ty = ty_top; ty <= ty_bot; ty++)
-            if (world.IsSolid(tx_r, ty)) { state_.on_wall_right = true; break; }
+        if (world.AnySolidInColumn(tx_r, ty_top, ty_bot)) state_.on_wall_right = true;
     }
     {
         // Tile a sinistra: primo pixel = bordo sinistro - 1 - WALL_PROBE_REACH
         int tx_l = (static_cast<int>(state_.x) - 1 - WALL_PROBE_REACH) / TILE_SIZE;
-        for (int ty = ty_top; ty <= ty_bot; ty++)
-            if (world.IsSolid(tx_l, ty)) { state_.on_wall_left = true; break; }
+        if (world.AnySolidInColumn(tx_l, ty_top, ty_bot)) state_.on_wall_left = true;
     }
 }
 
@@ -373,16 +371,13 @@ void Player::ResolveCollisionsY(const World& world) {
     if (state_.vel_y > 0.f) {
         // Caduta: controlla bordo inferiore
         int ty = static_cast<int>(state_.y + TILE_SIZE - 1) / TILE_SIZE;
-        for (int tx = tx_left; tx <= tx_right; tx++) {
-            if (world.IsSolid(tx, ty)) {
-                state_.y         = static_cast<float>(ty * TILE_SIZE - TILE_SIZE);
-                state_.vel_y     = 0.f;
-                state_.on_ground = true;
-                state_.dash_cooldown_ticks = 0;     // ricarica cooldown all'atterraggio
-                state_.dash_ready          = true;  // ricarica la carica del dash
-                state_.last_wall_jump_dir = 0;  // atterrato: può tornare a wall jumpare
-                break;
-            }
+        if (world.AnySolidInRow(ty, tx_left, tx_right)) {
+            state_.y         = static_cast<float>(ty * TILE_SIZE - TILE_SIZE);
+            state_.vel_y     = 0.f;
+            state_.on_ground = true;
+            state_.dash_cooldown_ticks = 0;     // ricarica cooldown all'atterraggio
+            state_.dash_ready          = true;  // ricarica la carica del dash
+            state_.last_wall_jump_dir = 0;  // atterrato: può tornare a wall jumpare
         }
     } else if (state_.vel_y < 0.f) {
         // Salto: controlla bordo superiore.
@@ -12,7 +12,8 @@ public:
     const PlayerState& GetState() const { return state_; }
 
     // Main update: apply one InputFrame to the current state.
-    // Runs all mechanics (movement, coyote, jump, dash, gravity, collision) in fixed order.
+    // Runs all mechanics (movement, coyote, jump, dash, gravity, collision) in fixed order,
+    // then snaps the state onto the wire grid (QuantizePlayerState, WireCodec.h).
     void Simulate(const InputFrame& frame, const World& world);
 
     // Low-level helpers — exposed for unit tests and split-step internal use.
@@ -30,6 +31,7 @@ private:
     PlayerState state_;
     bool        prev_jump_held_ = false;
 
+    void SimulateTick(const InputFrame& frame, const World& world);
     void ResolveCollisionsX(const World& world, float dx);
     void ResolveCollisionsY(const World& world);
 };
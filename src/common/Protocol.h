@@ -7,14 +7,19 @@
 
 // Increment PROTOCOL_VERSION on any breaking change to packet layout, PlayerState,
 // or simulation behaviour so client and server can detect incompatibility at connect time.
-static constexpr const char*  GAME_VERSION     = "0.2.8";
-static constexpr uint16_t     PROTOCOL_VERSION = 13;
+static constexpr const char*  GAME_VERSION     = "0.2.12";
+static constexpr uint16_t     PROTOCOL_VERSION = 21;
 
 static constexpr uint16_t SERVER_PORT       = 58291;  // dedicated (online) server
 static constexpr uint16_t SERVER_PORT_LOCAL = 58721;  // in-process server for offline mode
 static constexpr size_t   MAX_CLIENTS      = static_cast<size_t>(MAX_PLAYERS);
-static constexpr uint8_t  CHANNEL_RELIABLE = 0;
-static constexpr uint8_t  CHANNEL_COUNT    = 1;
+
+// ENet channels. Each channel has its own reliable sequence, so a large or retransmitted
+// packet only stalls its own channel.
+static constexpr uint8_t  CHANNEL_STATE    = 0;  // per-tick traffic: snapshots, inputs
+static constexpr uint8_t  CHANNEL_CONTROL  = 1;  // small reliable messages
+static constexpr uint8_t  CHANNEL_BULK     = 2;  // level transfer (PKT_GENERATING, PKT_LEVEL_DATA/REGION/STAGE/COMMIT)
+static constexpr uint8_t  CHANNEL_COUNT    = 3;
 
 // First map loaded on server start; players wait here between games.
 static constexpr const char* LOBBY_MAP_PATH = "assets/levels/tilemaps/_Lobby.tmj";
@@ -28,9 +33,9 @@ enum DisconnectReason : uint32_t {
 
 // First byte of every packet identifies its type.
 enum PktType : uint8_t {
-    PKT_INPUT             = 1,   // C → S  one InputFrame per fixed tick
+    PKT_INPUT             = 1,   // C → S  unconfirmed InputFrames (redundant, unsequenced)
     PKT_PLAYER_STATE      = 2,   // (legacy, unused)
-    PKT_GAME_STATE        = 3,   // S → C  authoritative GameState broadcast
+    PKT_GAME_STATE        = 3,   // S → C  authoritative GameState snapshot (delta vs. acked baseline)
     PKT_WELCOME           = 4,   // S → C  assigned player_id + session_token
     PKT_PLAYER_INFO       = 5,   // C → S  name + protocol_version (sent right after PKT_WELCOME)
     PKT_RESTART           = 6,   // C → S  respawn at last shared checkpoint (or spawn if none); Backspace / Triangle
@@ -48,16 +53,60 @@ enum PktType : uint8_t {
     PKT_SET_GAME_MODE     = 18,  // C → S  leader sets the game mode (coop / race)
     PKT_START_GAME        = 19,  // C → S  leader starts the game from the lobby
     PKT_SET_MAX_LEVELS    = 20,  // C → S  leader sets generated levels per session
+    PKT_ROSTER            = 21,  // S → C  player_id → name table (names are not in snapshots)
+    PKT_LEVEL_STAGE       = 22,  // S → C  pre-generated next level, sent during results (not applied yet)
+    PKT_LEVEL_COMMIT      = 23,  // S → C  switch to the staged level
+    PKT_LEVEL_REQUEST     = 24,  // C → S  could not build the level: send the full grid
+    PKT_LEVEL_REGION      = 25,  // S → C  more regions of a streamed PKT_LEVEL_DATA (LEVEL_ENC_REGIONS)
+};
+
+// How each packet type travels. Senders never choose a channel or flags themselves:
+// ServerSession::SendPacket / BroadcastPacket and NetworkClient::Send route by the type byte.
+// No ordering holds across channels: PKT_GAME_STATE carries level_epoch so snapshots
+// of a level whose PKT_LEVEL_DATA has not arrived yet are not applied.
+enum class Delivery : uint8_t {
+    RELIABLE,      // retransmitted, in order within the channel
+    UNRELIABLE,    // sequenced: late packets are dropped, never retransmitted
+    UNSEQUENCED,   // no ordering at all (redundant PKT_INPUT)
+};
+
+struct PacketRoute {
+    uint8_t  channel;
+    Delivery delivery;
 };
 
-struct PktInput {
-    uint8_t    type  = PKT_INPUT;
-    InputFrame frame = {};
+constexpr PacketRoute RoutePacket(uint8_t type) {
+    switch (type) {
+        case PKT_INPUT:      return { CHANNEL_STATE, Delivery::UNSEQUENCED };
+        case PKT_GAME_STATE: return { CHANNEL_STATE, Delivery::UNRELIABLE };
+        case PKT_GENERATING:
+        case PKT_LEVEL_DATA:
+        case PKT_LEVEL_REGION:
+        case PKT_LEVEL_STAGE:
+        case PKT_LEVEL_COMMIT: return { CHANNEL_BULK, Delivery::RELIABLE };
+        default:             return { CHANNEL_CONTROL, Delivery::RELIABLE };
+    }
+}
+
+// PKT_INPUT and PKT_GAME_STATE are bit-packed variable-size packets (type byte + BitStream):
+//   PKT_INPUT       EncodeInputPacket   (WireCodec.h)
+//   PKT_GAME_STATE  EncodeSnapshot      (SnapshotDelta.h)
+// snapshot_ack = newest PKT_GAME_STATE seq decoded by the client (0 = none).
+// PKT_INPUT is sent unsequenced: every packet repeats the frames the server has not yet
+// confirmed, so a lost packet is covered by the next one instead of a retransmit.
+
+// Player names are not part of PKT_GAME_STATE: the server sends the roster reliably
+// whenever it changes (join, name received, disconnect).
+struct RosterEntry {
+    uint32_t player_id = 0;
+    char     name[16]  = {};
 };
 
-struct PktGameState {
-    uint8_t   type  = PKT_GAME_STATE;
-    GameState state = {};
+struct PktRoster {
+    uint8_t     type  = PKT_ROSTER;
+    uint8_t     count = 0;
+    uint8_t     _pad[2] = {};
+    RosterEntry entries[MAX_PLAYERS];
 };
 
 // Sent exactly once on connection. session_token == 0 means currently in lobby.
@@ -65,6 +114,7 @@ struct PktWelcome {
     uint8_t  type          = PKT_WELCOME;
     uint32_t player_id     = 0;
     uint32_t session_token = 0;
+    uint8_t  level_epoch   = 0;   // current level epoch (see PktLevelDataHeader)
 };
 
 // Sent immediately after receiving PKT_WELCOME. Server disconnects if protocol_version mismatches.
@@ -72,6 +122,7 @@ struct PktPlayerInfo {
     uint8_t  type             = PKT_PLAYER_INFO;
     uint16_t protocol_version = PROTOCOL_VERSION;
     char     name[16]         = {};
+    uint64_t chunk_hash       = 0;   // ChunkStore::ContentHash of the client (0 = none loaded)
 };
 
 struct PktRestart {
@@ -138,17 +189,72 @@ struct PktGlobalResults {
     GlobalResultEntry entries[MAX_PLAYERS];
 };
 
-// Variable-size packet: header followed by width*height bytes of tile chars.
+// Payload that follows PktLevelDataHeader.
+enum LevelEncoding : uint8_t {
+    LEVEL_ENC_GRID   = 0,  // width*height bytes of tile chars
+    LEVEL_ENC_RECIPE = 1,  // LevelRecipe (bit-packed): chunk ids + offsets, rebuilt by the client
+    LEVEL_ENC_PACKED = 2,  // EncodeLevelGrid (LevelCodec.h): palette + row RLE, range-coded
+    LEVEL_ENC_REGIONS = 3, // PktLevelRegionsInfo + the regions nearest the spawn (see below)
+};
+
+// Variable-size packet: header followed by the level payload (see LevelEncoding).
 // Sent by the server when a generated level is loaded (chunk-based level generator).
 // The client reconstructs the World from the char grid (solid = (ch == '0')).
+// Peers without a matching chunk set get LEVEL_ENC_PACKED; LEVEL_ENC_GRID is left for
+// grids the codec cannot pack (more than LEVEL_CODEC_MAX_PALETTE tile kinds).
+// LEVEL_ENC_RECIPE is only sent to peers whose PktPlayerInfo::chunk_hash matches the
+// server's chunk set; a client that still cannot rebuild it sends PKT_LEVEL_REQUEST.
 struct PktLevelDataHeader {
     uint8_t  type    = PKT_LEVEL_DATA;
     uint8_t  is_last = 0;       // 1 → session over, return to menu
     uint16_t width   = 0;       // map width in tiles
     uint16_t height  = 0;       // map height in tiles
     uint8_t  level   = 0;       // current level number (for display)
-    uint8_t  _pad    = 0;
-    // char data[width * height] follows immediately
+    uint8_t  epoch   = 0;       // bumped on every level change; echoed in PKT_INPUT so
+                                // frames still in flight from the previous level are dropped
+    uint8_t  encoding = LEVEL_ENC_GRID;
+    // payload follows immediately
+};
+
+// The server generates the next level in the background while the current one is
+// played. During the results screen it sends that grid as PKT_LEVEL_STAGE (same layout
+// as PKT_LEVEL_DATA, epoch unused); the client keeps it aside until PKT_LEVEL_COMMIT.
+// Both travel on CHANNEL_BULK, so the commit never overtakes its stage. A stage that
+// is never committed (settings changed, session ended) is replaced or discarded.
+// Client → server fallback: the level (or staged level) could not be rebuilt from its
+// recipe. The server answers with PKT_LEVEL_DATA in LEVEL_ENC_PACKED (or GRID).
+struct PktLevelRequest {
+    uint8_t type  = PKT_LEVEL_REQUEST;
+    uint8_t level = 0;
+};
+
+// Region streaming (PKT_LEVEL_DATA to peers without the chunk set, only when the packed
+// grid does not fit in LEVEL_REGION_PKT_BYTES): the grid is cut into LEVEL_REGION_TILES
+// squares, packed one by one (EncodeLevelRegions) and sent nearest to the spawn first.
+// PKT_LEVEL_DATA carries PktLevelRegionsInfo and the first blocks, so the client can
+// install the level and play the Ready/Go intro right away; the remaining blocks follow
+// in PKT_LEVEL_REGION packets on the same channel. Until its region lands a tile is
+// World::PENDING_TILE (solid).
+static constexpr int LEVEL_REGION_TILES     = 32;
+static constexpr int LEVEL_REGION_PKT_BYTES = 1024;  // block bytes per packet: one ENet fragment
+
+struct PktLevelRegionsInfo {     // LEVEL_ENC_REGIONS payload, followed by count blocks
+    uint8_t  region_tiles = LEVEL_REGION_TILES;
+    uint8_t  count        = 0;   // blocks in this packet
+    uint16_t total        = 0;   // blocks in the whole level
+};
+
+struct PktLevelRegion {          // followed by count blocks
+    uint8_t type  = PKT_LEVEL_REGION;
+    uint8_t level = 0;
+    uint8_t epoch = 0;           // as PktLevelDataHeader::epoch; stale regions are dropped
+    uint8_t count = 0;
+};
+
+struct PktLevelCommit {
+    uint8_t type  = PKT_LEVEL_COMMIT;
+    uint8_t level = 0;   // must match the staged level
+    uint8_t epoch = 0;   // new level epoch (as PktLevelDataHeader::epoch)
 };
 
 // Number of generated levels per session before returning to lobby.
@@ -176,8 +282,8 @@ struct PktEmoteBroadcast {
     uint32_t player_id = 0;
 };
 
-// Sent before PKT_LEVEL_DATA to warn clients that generation may take a moment.
-// Clients show a loading overlay and extend their disconnect timeout.
+// Sent when the worker thread starts generating; PKT_LEVEL_DATA follows when it finishes.
+// Clients show a loading overlay meanwhile.
 struct PktGenerating {
     uint8_t type  = PKT_GENERATING;
     uint8_t level = 0;   // the level number being generated
@@ -0,0 +1,151 @@
+// SnapshotDelta.cpp — codifica delta dei GameState rispetto a un baseline confermato.
+
+#include "SnapshotDelta.h"
+#include "BitStream.h"
+#include "WireCodec.h"
+#include "Protocol.h"   // PKT_GAME_STATE
+
+namespace {
+
+// Campi dell'header di GameState (header mask).
+enum : uint32_t {
+    GS_COUNTDOWN  = 1u << 0,
+    GS_TIME_LIMIT = 1u << 1,
+    GS_IS_LOBBY   = 1u << 2,
+    GS_GAME_MODE  = 1u << 3,
+    GS_MAX_LEVELS = 1u << 4,
+    GS_LEADER     = 1u << 5,
+    GS_EPOCH      = 1u << 6,
+};
+constexpr int GS_MASK_BITS = 7;
+
+const PlayerState* FindPlayer(const GameState* gs, uint32_t player_id) {
+    if (!gs) return nullptr;
+    for (uint32_t i = 0; i < gs->count && i < static_cast<uint32_t>(MAX_PLAYERS); ++i)
+        if (gs->players[i].player_id == player_id) return &gs->players[i];
+    return nullptr;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// EncodeSnapshot
+// ---------------------------------------------------------------------------
+void EncodeSnapshot(uint32_t seq, uint32_t baseline_seq, const GameState* base,
+                    const GameState& cur, std::vector<uint8_t>& out) {
+    const GameState empty{};
+    const GameState& b = base ? *base : empty;
+
+    out.push_back(PKT_GAME_STATE);
+    BitWriter w(out);
+    w.WriteBits(seq, 32);
+    w.WriteVarUint(base ? seq - baseline_seq : 0u);
+
+    uint32_t gmask = 0;
+    if (cur.next_level_countdown_ticks != b.next_level_countdown_ticks) gmask |= GS_COUNTDOWN;
+    if (cur.time_limit_secs      != b.time_limit_secs)      gmask |= GS_TIME_LIMIT;
+    if (cur.is_lobby             != b.is_lobby)             gmask |= GS_IS_LOBBY;
+    if (cur.game_mode            != b.game_mode)            gmask |= GS_GAME_MODE;
+    if (cur.max_generated_levels != b.max_generated_levels) gmask |= GS_MAX_LEVELS;
+    if (cur.leader_id            != b.leader_id)            gmask |= GS_LEADER;
+    if (cur.level_epoch          != b.level_epoch)          gmask |= GS_EPOCH;
+    w.WriteBits(gmask, GS_MASK_BITS);
+    if (gmask & GS_COUNTDOWN)  w.WriteVarUint(cur.next_level_countdown_ticks);
+    if (gmask & GS_TIME_LIMIT) w.WriteVarUint(cur.time_limit_secs);
+    if (gmask & GS_IS_LOBBY)   w.WriteBits(cur.is_lobby, 1);
+    if (gmask & GS_GAME_MODE)  w.WriteBits(cur.game_mode, 2);
+    if (gmask & GS_MAX_LEVELS) w.WriteBits(cur.max_generated_levels, 8);
+    if (gmask & GS_LEADER)     w.WriteVarUint(cur.leader_id);
+    if (gmask & GS_EPOCH)      w.WriteBits(cur.level_epoch, 8);
+
+    const uint32_t count = cur.count < static_cast<uint32_t>(MAX_PLAYERS)
+        ? cur.count : static_cast<uint32_t>(MAX_PLAYERS);
+    w.WriteBits(count, 4);
+
+    const int fields = PlayerFieldCount();
+    const PlayerState def{};
+    for (uint32_t i = 0; i < count; ++i) {
+        const PlayerState& s  = cur.players[i];
+        const PlayerState* bp = FindPlayer(base, s.player_id);
+        const PlayerState& bs = bp ? *bp : def;
+
+        uint32_t fmask = 0;
+        for (int f = 0; f < fields; ++f)
+            if (!PlayerFieldEqual(f, s, bs)) fmask |= 1u << f;
+
+        w.WriteVarUint(s.player_id);
+        w.WriteBool(fmask != 0);
+        if (fmask == 0) continue;
+        w.WriteBits(fmask, fields);
+        for (int f = 0; f < fields; ++f)
+            if (fmask & (1u << f)) WritePlayerField(w, f, s, bs);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// ReadSnapshotHeader
+// ---------------------------------------------------------------------------
+bool ReadSnapshotHeader(const uint8_t* data, size_t len,
+                        uint32_t& seq, uint32_t& baseline_seq) {
+    if (len < 1 || data[0] != PKT_GAME_STATE) return false;
+    BitReader r(data + 1, len - 1);
+    seq = r.ReadBits(32);
+    const uint32_t back = r.ReadVarUint();
+    if (r.Overflowed() || seq == 0 || back > seq) return false;
+    baseline_seq = back ? seq - back : 0u;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// DecodeSnapshot
+// ---------------------------------------------------------------------------
+bool DecodeSnapshot(const GameState* base, const uint8_t* data, size_t len,
+                    GameState& out) {
+    if (len < 1 || data[0] != PKT_GAME_STATE) return false;
+    const GameState empty{};
+    const GameState& b = base ? *base : empty;
+    BitReader r(data + 1, len - 1);
+    r.ReadBits(32);
+    if ((r.ReadVarUint() != 0) != (base != nullptr)) return false;   // baseline mismatch
+
+    GameState gs{};
+    gs.next_level_countdown_ticks = b.next_level_countdown_ticks;
+    gs.time_limit_secs            = b.time_limit_secs;
+    gs.is_lobby                   = b.is_lobby;
+    gs.game_mode                  = b.game_mode;
+    gs.max_generated_levels       = b.max_generated_levels;
+    gs.leader_id                  = b.leader_id;
+    gs.level_epoch                = b.level_epoch;
+
+    const uint32_t gmask = r.ReadBits(GS_MASK_BITS);
+    if (gmask & GS_COUNTDOWN)  gs.next_level_countdown_ticks = r.ReadVarUint();
+    if (gmask & GS_TIME_LIMIT) gs.time_limit_secs            = r.ReadVarUint();
+    if (gmask & GS_IS_LOBBY)   gs.is_lobby             = static_cast<uint8_t>(r.ReadBits(1));
+    if (gmask & GS_GAME_MODE)  gs.game_mode            = static_cast<uint8_t>(r.ReadBits(2));
+    if (gmask & GS_MAX_LEVELS) gs.max_generated_levels = static_cast<uint8_t>(r.ReadBits(8));
+    if (gmask & GS_LEADER)     gs.leader_id            = r.ReadVarUint();
+    if (gmask & GS_EPOCH)      gs.level_epoch          = static_cast<uint8_t>(r.ReadBits(8));
+
+    gs.count = r.ReadBits(4);
+    if (gs.count > static_cast<uint32_t>(MAX_PLAYERS)) return false;
+
+    const int fields = PlayerFieldCount();
+    const PlayerState def{};
+    for (uint32_t i = 0; i < gs.count; ++i) {
+        const uint32_t player_id = r.ReadVarUint();
+        const PlayerState* bp = FindPlayer(base, player_id);
+        const PlayerState& bs = bp ? *bp : def;
+        PlayerState s = bs;
+        s.player_id = player_id;
+        s.name[0]   = '\0';
+        if (r.ReadBool()) {
+            const uint32_t fmask = r.ReadBits(fields);
+            for (int f = 0; f < fields; ++f)
+                if (fmask & (1u << f)) ReadPlayerField(r, f, s, bs);
+        }
+        gs.players[i] = s;
+    }
+    if (r.Overflowed() || !r.AtEnd()) return false;
+    out = gs;
+    return true;
+}
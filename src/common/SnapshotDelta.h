@@ -0,0 +1,44 @@
+#pragma once
+// Delta compression of GameState snapshots against an acknowledged baseline.
+// Shared by the server (encode, one packet per peer) and the client (decode).
+// No Raylib or ENet dependency — only the plain-data state structs.
+//
+// PKT_GAME_STATE layout (bit-packed after the type byte, see BitStream.h):
+//   u32     seq
+//   varuint seq - baseline_seq     (0 = keyframe, encoded against an empty GameState)
+//   7 bits  header mask            which GameState header fields follow
+//   ...     changed header fields
+//   4 bits  count
+//   per player:
+//     varuint player_id
+//     1 bit   changed              0 = identical to the baseline entry
+//     N bits  field mask           one bit per WireCodec schema field
+//     ...     changed fields       (WritePlayerField)
+//
+// A player is diffed against the baseline entry with the same player_id; players
+// missing from the baseline (or a keyframe) are diffed against a default-constructed
+// PlayerState, so only non-default fields are sent. Names are not part of snapshots
+// (PKT_ROSTER): decoded PlayerState::name is left empty.
+#include "GameState.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Snapshots kept by both ends for use as delta baselines (≈ 0.5 s at 60 Hz).
+// An ack older than this forces a keyframe.
+static constexpr uint32_t SNAPSHOT_RING = 32;
+
+// Append a complete PKT_GAME_STATE packet to out.
+// base must be the snapshot numbered baseline_seq (nullptr and 0 for a keyframe).
+void EncodeSnapshot(uint32_t seq, uint32_t baseline_seq, const GameState* base,
+                    const GameState& cur, std::vector<uint8_t>& out);
+
+// Read seq / baseline_seq from a PKT_GAME_STATE packet without decoding the rest.
+bool ReadSnapshotHeader(const uint8_t* data, size_t len,
+                        uint32_t& seq, uint32_t& baseline_seq);
+
+// Rebuild a full GameState from base (the snapshot named by the packet's baseline_seq,
+// nullptr for a keyframe) and a PKT_GAME_STATE packet.
+// Returns false on truncated or malformed input; out is then unspecified.
+bool DecodeSnapshot(const GameState* base, const uint8_t* data, size_t len,
+                    GameState& out);
@@ -0,0 +1,522 @@
+// TiledParser.cpp — lettura single-pass di .tmj (JSON) e .tsx (XML).
+// Il cursore JSON avanza una sola volta sul buffer: interi parsati sul posto, chiavi
+// confrontate come string_view, valori non interessanti saltati senza copiarli.
+
+#include "TiledParser.h"
+#include "Inflate.h"
+#include <array>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+namespace {
+
+// ============================================================================
+// JsonCursor — scanner JSON minimale, nessuna allocazione salvo String()
+// ============================================================================
+
+class JsonCursor {
+public:
+    JsonCursor(const char* p, size_t n) : p_(p), end_(p + n) {}
+
+    bool Ok() const { return ok_; }
+
+    void Ws() {
+        while (p_ < end_ && (*p_ == ' ' || *p_ == '\n' || *p_ == '\r' || *p_ == '\t')) ++p_;
+    }
+    bool Peek(char c) { Ws(); return p_ < end_ && *p_ == c; }
+    bool Eat(char c)  { if (Peek(c)) { ++p_; return true; } return false; }
+    bool Expect(char c) { if (Eat(c)) return true; ok_ = false; return false; }
+
+    // Next "key": of an object whose '{' was already eaten. false at '}' or on error.
+    bool NextMember(bool& first, std::string_view& key) {
+        if (!ok_ || Eat('}')) return false;
+        if (!first && !Expect(',')) return false;
+        first = false;
+        return RawString(key) && Expect(':');
+    }
+
+    // Next element of an array whose '[' was already eaten. false at ']' or on error.
+    bool NextElement(bool& first) {
+        if (!ok_ || Eat(']')) return false;
+        if (!first && !Expect(',')) return false;
+        first = false;
+        return true;
+    }
+
+    // String contents with escapes left in place (keys, base64 payloads).
+    bool RawString(std::string_view& out) {
+        if (!Expect('"')) return false;
+        const char* s = p_;
+        const char* q = s;
+        // memchr sulle virgolette; una '"' preceduta da un numero dispari di '\' è escapata.
+        while ((q = static_cast<const char*>(std::memchr(q, '"', static_cast<size_t>(end_ - q))))) {
+            const char* b = q;
+            while (b > s && b[-1] == '\\') --b;
+            if (((q - b) & 1) == 0) break;
+            ++q;
+        }
+        if (!q) { p_ = end_; ok_ = false; return false; }
+        out = std::string_view(s, static_cast<size_t>(q - s));
+        p_ = q + 1;
+        return true;
+    }
+
+    bool String(std::string& out) {
+        std::string_view raw;
+        if (!RawString(raw)) return false;
+        out.clear();
+        for (size_t i = 0; i < raw.size(); ++i) {
+            if (raw[i] != '\\' || i + 1 >= raw.size()) { out += raw[i]; continue; }
+            const char e = raw[++i];
+            switch (e) {
+                case 'n': out += '\n'; break;
+                case 't': out += '\t'; break;
+                case 'r': out += '\r'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'u': {
+                    // Solo ASCII: i file Tiled del gioco non usano altro nei campi letti.
+                    unsigned cp = 0;
+                    if (i + 4 < raw.size())
+                        std::from_chars(raw.data() + i + 1, raw.data() + i + 5, cp, 16);
+                    out += (cp < 0x80) ? static_cast<char>(cp) : '?';
+                    i += 4;
+                    break;
+                }
+                default: out += e; break;   // \" \\ \/
+            }
+        }
+        return true;
+    }
+
+    // Integer in place; a fractional part or exponent is skipped (truncated).
+    bool Int(int64_t& v) {
+        Ws();
+        const char* s = p_;
+        bool neg = false;
+        if (p_ < end_ && *p_ == '-') { neg = true; ++p_; }
+        if (p_ >= end_ || *p_ < '0' || *p_ > '9') { p_ = s; ok_ = false; return false; }
+        int64_t acc = 0;
+        while (p_ < end_ && *p_ >= '0' && *p_ <= '9') acc = acc * 10 + (*p_++ - '0');
+        while (p_ < end_ && (*p_ == '.' || *p_ == 'e' || *p_ == 'E' || *p_ == '+' || *p_ == '-' ||
+                             (*p_ >= '0' && *p_ <= '9'))) ++p_;
+        v = neg ? -acc : acc;
+        return true;
+    }
+
+    bool Int(int& v) {
+        int64_t w = 0;
+        if (!Int(w)) return false;
+        v = static_cast<int>(w);
+        return true;
+    }
+
+    // Array of non-negative integers (tile GIDs), '[' not yet eaten. Tight loop: this is
+    // where almost all the bytes of a .tmj are.
+    bool GidArray(std::vector<uint32_t>& out) {
+        if (!Expect('[')) return false;
+        out.clear();
+        const char* p = p_;   // copia locale: i push_back non costringono a ricaricare p_
+        while (p < end_) {
+            const char c = *p;
+            if (c >= '0' && c <= '9') {
+                uint32_t acc = 0;
+                while (p < end_ && *p >= '0' && *p <= '9') acc = acc * 10 + static_cast<uint32_t>(*p++ - '0');
+                out.push_back(acc & TILED_GID_MASK);
+            } else if (c == ',' || c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+                ++p;
+            } else if (c == ']') {
+                p_ = p + 1;
+                return true;
+            } else {
+                break;
+            }
+        }
+        p_ = p;
+        ok_ = false;
+        return false;
+    }
+
+    // Any scalar as text (string unescaped; number / bool / null verbatim).
+    bool ScalarText(std::string& out) {
+        if (Peek('"')) return String(out);
+        const char* s = p_;
+        while (p_ < end_ && *p_ != ',' && *p_ != '}' && *p_ != ']' &&
+               *p_ != ' ' && *p_ != '\n' && *p_ != '\r' && *p_ != '\t') ++p_;
+        out.assign(s, p_);
+        return true;
+    }
+
+    void SkipValue() {
+        Ws();
+        if (p_ >= end_) { ok_ = false; return; }
+        if (*p_ == '"') { std::string_view sv; RawString(sv); return; }
+        if (*p_ != '{' && *p_ != '[') {
+            while (p_ < end_ && *p_ != ',' && *p_ != '}' && *p_ != ']') ++p_;
+            return;
+        }
+        int depth = 0;
+        while (p_ < end_) {
+            const char c = *p_;
+            if (c == '"') { std::string_view sv; if (!RawString(sv)) return; continue; }
+            ++p_;
+            if (c == '{' || c == '[') ++depth;
+            else if ((c == '}' || c == ']') && --depth == 0) return;
+        }
+        ok_ = false;
+    }
+
+private:
+    const char* p_;
+    const char* end_;
+    bool        ok_ = true;
+};
+
+// ============================================================================
+// Layer payload decoding
+// ============================================================================
+
+// Base64 → bytes. Skips whitespace and the `\` of JSON `\/` escapes; stops at '='.
+bool Base64Decode(std::string_view in, std::vector<uint8_t>& out) {
+    static const auto table = [] {
+        std::array<int8_t, 256> t{};
+        t.fill(-1);
+        const char* a = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        for (int i = 0; i < 64; ++i) t[static_cast<uint8_t>(a[i])] = static_cast<int8_t>(i);
+        return t;
+    }();
+    out.resize(in.size() * 3 / 4 + 3);
+    uint8_t* dst = out.data();
+    uint32_t acc = 0;
+    int bits = 0;
+    for (const char c : in) {
+        if (c == '=') break;
+        const int v = table[static_cast<uint8_t>(c)];
+        if (v < 0) {
+            if (c == '\\' || c == ' ' || c == '\n' || c == '\r' || c == '\t') continue;
+            return false;
+        }
+        acc = (acc << 6) | static_cast<uint32_t>(v);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            *dst++ = static_cast<uint8_t>(acc >> bits);
+        }
+    }
+    out.resize(static_cast<size_t>(dst - out.data()));
+    return true;
+}
+
+// base64 (+ zlib | gzip) → little-endian uint32 GIDs.
+bool DecodeLayerData(std::string_view data, std::string_view compression, std::vector<uint32_t>& gids) {
+    // Buffer riusati tra una chiamata e l'altra: a regime nessuna allocazione.
+    thread_local std::vector<uint8_t> raw;
+    thread_local std::vector<uint8_t> inflated;
+
+    if (!Base64Decode(data, raw)) return false;
+    const std::vector<uint8_t>* bytes = &raw;
+    if (!compression.empty()) {
+        inflated.clear();
+        bool ok = false;
+        if      (compression == "zlib") ok = InflateZlib(raw.data(), raw.size(), inflated);
+        else if (compression == "gzip") ok = InflateGzip(raw.data(), raw.size(), inflated);
+        else {
+            printf("[tiled] unsupported layer compression '%.*s' (use zlib or gzip)\n",
+                   static_cast<int>(compression.size()), compression.data());
+            return false;
+        }
+        if (!ok) return false;
+        bytes = &inflated;
+    }
+
+    const size_t n = bytes->size() / 4;
+    gids.resize(n);
+    const uint8_t* b = bytes->data();
+    for (size_t i = 0; i < n; ++i, b += 4) {
+        const uint32_t g = uint32_t{b[0]} | (uint32_t{b[1]} << 8) |
+                           (uint32_t{b[2]} << 16) | (uint32_t{b[3]} << 24);
+        gids[i] = g & TILED_GID_MASK;
+    }
+    return true;
+}
+
+// ============================================================================
+// Map sections
+// ============================================================================
+
+// One entry of "layers". The first "tilelayer" fills out.gids; the rest are skipped.
+// Keys come alphabetically ("data" before "encoding" and "type"), so an array is parsed
+// straight into out.gids and a base64 string is only remembered until the object closes.
+bool ParseLayer(JsonCursor& c, TiledMap& out, bool& have_layer) {
+    if (!c.Expect('{')) return false;
+    std::string_view key, type, encoding, compression, b64;
+    bool array_data = false;
+
+    bool first = true;
+    while (c.NextMember(first, key)) {
+        if (key == "data" && !have_layer && c.Peek('[')) {
+            if (!c.GidArray(out.gids)) return false;
+            array_data = true;
+        } else if (key == "data" && !have_layer && c.Peek('"')) {
+            c.RawString(b64);
+        } else if (key == "type")        { c.RawString(type);
+        } else if (key == "encoding")    { c.RawString(encoding);
+        } else if (key == "compression") { c.RawString(compression);
+        } else {
+            c.SkipValue();
+        }
+    }
+    if (!c.Ok()) return false;
+
+    if (type != "tilelayer" || have_layer) {
+        if (!have_layer) out.gids.clear();
+        return true;
+    }
+    if (array_data) { have_layer = true; return true; }
+    if (b64.empty()) return true;
+    if (encoding != "base64") {
+        printf("[tiled] unsupported layer encoding '%.*s'\n",
+               static_cast<int>(encoding.size()), encoding.data());
+        return false;
+    }
+    if (!DecodeLayerData(b64, compression, out.gids)) return false;
+    have_layer = true;
+    return true;
+}
+
+bool ParseTilesets(JsonCursor& c, TiledMap& out) {
+    if (!c.Expect('[')) return false;
+    bool first = true, have = false;
+    while (c.NextElement(first)) {
+        if (have) { c.SkipValue(); continue; }   // solo il primo tileset
+        if (!c.Expect('{')) return false;
+        std::string_view key;
+        bool m_first = true;
+        while (c.NextMember(m_first, key)) {
+            if      (key == "firstgid") c.Int(out.firstgid);
+            else if (key == "source")   c.String(out.tileset_source);
+            else                        c.SkipValue();
+        }
+        have = true;
+    }
+    return c.Ok();
+}
+
+bool ParseProperties(JsonCursor& c, TiledMap& out) {
+    if (!c.Expect('[')) return false;
+    bool first = true;
+    while (c.NextElement(first)) {
+        if (!c.Expect('{')) return false;
+        TiledProperty prop;
+        std::string_view key;
+        bool m_first = true;
+        while (c.NextMember(m_first, key)) {
+            if      (key == "name")  c.String(prop.name);
+            else if (key == "value") c.ScalarText(prop.value);
+            else                     c.SkipValue();
+        }
+        out.properties.push_back(std::move(prop));
+    }
+    return c.Ok();
+}
+
+// ============================================================================
+// Tileset helpers
+// ============================================================================
+
+char CharForType(std::string_view t) {
+    if (t == "platform")    return '0';
+    if (t == "kill")        return 'K';
+    if (t == "end")         return 'E';
+    if (t == "spawn")       return 'X';
+    if (t == "checkpoint")  return 'C';
+    if (t == "chunk_entry") return 'I';
+    if (t == "chunk_exit")  return 'O';
+    return ' ';
+}
+
+// Value of attribute `name` inside the tag text [tag, tag_end). Empty view if absent.
+std::string_view XmlAttr(std::string_view tag, std::string_view name) {
+    size_t pos = 0;
+    while ((pos = tag.find(name, pos)) != std::string_view::npos) {
+        const size_t eq = pos + name.size();
+        const bool starts = pos > 0 && (tag[pos - 1] == ' ' || tag[pos - 1] == '\t' || tag[pos - 1] == '\n');
+        if (starts && eq + 1 < tag.size() && tag[eq] == '=' && tag[eq + 1] == '"') {
+            const size_t v = eq + 2;
+            const size_t q = tag.find('"', v);
+            if (q == std::string_view::npos) return {};
+            return tag.substr(v, q - v);
+        }
+        pos = eq;
+    }
+    return {};
+}
+
+bool ReadWholeFile(const char* path, std::string& out) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f.is_open()) return false;
+    f.seekg(0, std::ios::end);
+    const std::streamoff size = f.tellg();
+    if (size < 0) return false;
+    f.seekg(0, std::ios::beg);
+    out.resize(static_cast<size_t>(size));
+    return static_cast<bool>(f.read(out.data(), size));
+}
+
+} // namespace
+
+// ============================================================================
+// TiledMap
+// ============================================================================
+
+const std::string* TiledMap::Property(const char* name) const {
+    for (const TiledProperty& p : properties)
+        if (p.name == name) return &p.value;
+    return nullptr;
+}
+
+int TiledMap::PropertyInt(const char* name, int fallback) const {
+    const std::string* v = Property(name);
+    if (!v) return fallback;
+    int out = fallback;
+    const auto res = std::from_chars(v->data(), v->data() + v->size(), out);
+    return res.ec == std::errc() ? out : fallback;
+}
+
+bool ParseTiledMap(const char* json, size_t len, TiledMap& out) {
+    out.width = out.height = 0;
+    out.firstgid = 1;
+    out.tileset_source.clear();
+    out.gids.clear();
+    out.properties.clear();
+
+    JsonCursor c(json, len);
+    if (!c.Expect('{')) return false;
+
+    bool have_layer = false;
+    std::string_view key;
+    bool first = true;
+    while (c.NextMember(first, key)) {
+        bool ok = true;
+        if      (key == "width")      ok = c.Int(out.width);
+        else if (key == "height")     ok = c.Int(out.height);
+        else if (key == "layers") {
+            ok = c.Expect('[');
+            bool el_first = true;
+            while (ok && c.NextElement(el_first)) ok = ParseLayer(c, out, have_layer);
+        }
+        else if (key == "tilesets")   ok = ParseTilesets(c, out);
+        else if (key == "properties") ok = ParseProperties(c, out);
+        else                          c.SkipValue();
+        if (!ok) return false;
+    }
+    if (!c.Ok() || !have_layer) return false;
+    if (out.width <= 0 || out.height <= 0 || out.tileset_source.empty()) return false;
+    return out.gids.size() >= static_cast<size_t>(out.width) * out.height;
+}
+
+// ============================================================================
+// TiledTileset — <tile id="N"> ... <property name="solid|type" value="..."/> ... </tile>
+// ============================================================================
+
+bool ParseTiledTileset(const char* xml, size_t len, TiledTileset& out) {
+    out.tiles.clear();
+    const std::string_view doc(xml, len);
+
+    int              cur_id = -1;
+    std::string_view cur_type;
+    bool             cur_solid = false;
+    auto commit = [&] {
+        if (cur_id < 0) return;
+        if (static_cast<size_t>(cur_id) >= out.tiles.size()) out.tiles.resize(cur_id + 1);
+        TiledTile& t = out.tiles[cur_id];
+        t.ch    = CharForType(cur_type);
+        t.solid = cur_solid && t.ch != 'K';   // kill: sempre attraversabile
+        cur_id = -1;
+    };
+
+    size_t pos = 0;
+    while ((pos = doc.find('<', pos)) != std::string_view::npos) {
+        const size_t close = doc.find('>', pos);
+        if (close == std::string_view::npos) break;
+        const std::string_view tag = doc.substr(pos, close - pos + 1);
+        pos = close + 1;
+
+        if (tag.rfind("<tile ", 0) == 0) {
+            commit();
+            const std::string_view id = XmlAttr(tag, "id");
+            int v = -1;
+            if (std::from_chars(id.data(), id.data() + id.size(), v).ec != std::errc() || v < 0) continue;
+            cur_id = v;
+            cur_type = {};
+            cur_solid = false;
+            if (tag.size() >= 2 && tag[tag.size() - 2] == '/') commit();   // <tile id="N"/>
+        } else if (tag.rfind("</tile>", 0) == 0) {
+            commit();
+        } else if (cur_id >= 0 && tag.rfind("<property ", 0) == 0) {
+            const std::string_view name = XmlAttr(tag, "name");
+            if      (name == "solid") cur_solid = XmlAttr(tag, "value") == "true";
+            else if (name == "type")  cur_type  = XmlAttr(tag, "value");
+        }
+    }
+    commit();
+    return !out.tiles.empty();
+}
+
+// ============================================================================
+// File wrappers
+// ============================================================================
+
+bool LoadTiledMap(const char* path, TiledMap& out) {
+    thread_local std::string buf;   // riusato: i caricamenti ripetuti non riallocano
+    if (!ReadWholeFile(path, buf)) return false;
+    return ParseTiledMap(buf.data(), buf.size(), out);
+}
+
+bool LoadTiledTileset(const std::string& path, TiledTileset& out) {
+    thread_local std::string buf;
+    if (!ReadWholeFile(path.c_str(), buf)) return false;
+    return ParseTiledTileset(buf.data(), buf.size(), out);
+}
+
+std::shared_ptr<const TiledTileset> LoadTiledTilesetCached(const std::string& path) {
+    struct Entry {
+        std::filesystem::file_time_type     mtime;
+        std::shared_ptr<const TiledTileset> tileset;
+    };
+    static std::mutex                             mutex;
+    static std::unordered_map<std::string, Entry> cache;
+
+    // "chunks/03/../../TileSet.tsx" e "tilemaps/../TileSet.tsx" sono lo stesso file.
+    const std::string key = std::filesystem::path(path).lexically_normal().generic_string();
+    std::error_code ec;
+    const auto mtime = std::filesystem::last_write_time(key, ec);
+    if (ec) return nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto it = cache.find(key);
+        if (it != cache.end() && it->second.mtime == mtime) return it->second.tileset;
+    }
+
+    // Parse fuori dal lock: due thread che mancano insieme lo stesso file lo leggono
+    // entrambi, ma nessuno aspetta l'altro.
+    auto tsx = std::make_shared<TiledTileset>();
+    if (!LoadTiledTileset(key, *tsx)) return nullptr;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    cache[key] = Entry{ mtime, tsx };
+    return tsx;
+}
+
+std::string TiledResolvePath(const std::string& map_path, const std::string& rel) {
+    const size_t pos = map_path.find_last_of("/\\");
+    const std::string dir = (pos == std::string::npos) ? std::string(".") : map_path.substr(0, pos);
+    return dir + "/" + rel;
+}
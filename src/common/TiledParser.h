@@ -0,0 +1,72 @@
+#pragma once
+// Single-pass parser for the Tiled files the game ships: .tmj maps (JSON) and the .tsx
+// tileset (XML). Shared by World::LoadTmj and ChunkStore so the two no longer carry
+// their own copies of the find()/substr() helpers.
+// Tile layers may be a plain JSON array or base64 (uncompressed, zlib or gzip; see Inflate.h).
+// No Raylib or ENet dependency.
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Tiled stores flip/rotation flags in the top bits of each GID.
+constexpr uint32_t TILED_GID_MASK = 0x1FFFFFFFu;
+
+// One top-level custom property. Strings are unescaped; numbers and bools keep their text.
+struct TiledProperty {
+    std::string name;
+    std::string value;
+};
+
+struct TiledMap {
+    int width    = 0;
+    int height   = 0;
+    int firstgid = 1;                   // of the first tileset
+    std::string tileset_source;         // relative to the .tmj, `\/` already unescaped
+    std::vector<uint32_t> gids;         // first tile layer, row-major, flip flags masked off
+    std::vector<TiledProperty> properties;
+
+    // Property value by name, or nullptr.
+    const std::string* Property(const char* name) const;
+    // Integer property, or `fallback` if missing / not a number.
+    int PropertyInt(const char* name, int fallback) const;
+};
+
+// What a tileset tile becomes in a World grid.
+struct TiledTile {
+    char ch    = ' ';
+    bool solid = false;
+};
+
+// Tileset flattened to a table indexed by local tile id.
+struct TiledTileset {
+    std::vector<TiledTile> tiles;
+
+    // gid 0, unknown ids and ids below firstgid → air.
+    TiledTile Lookup(uint32_t gid, int firstgid) const {
+        if (gid == 0 || gid < static_cast<uint32_t>(firstgid)) return {};
+        const uint32_t id = gid - static_cast<uint32_t>(firstgid);
+        return id < tiles.size() ? tiles[id] : TiledTile{};
+    }
+};
+
+// Parse a .tmj buffer. `out` is reset first; its vectors keep their capacity.
+// false if the map has no size, no tileset or no usable tile layer.
+bool ParseTiledMap(const char* json, size_t len, TiledMap& out);
+
+// Parse a .tsx buffer. Tile "type" maps to the World chars ('0','K','E','X','C','I','O');
+// kill tiles are forced non-solid (the player must overlap them to die).
+bool ParseTiledTileset(const char* xml, size_t len, TiledTileset& out);
+
+// File wrappers around the two parsers.
+bool LoadTiledMap(const char* path, TiledMap& out);
+bool LoadTiledTileset(const std::string& path, TiledTileset& out);
+
+// Tileset shared by every map that references the same file: parsed once per
+// (normalized path, modification time), so an edited .tsx is picked up on the next call.
+// Thread-safe. nullptr if the file cannot be read or holds no tiles.
+std::shared_ptr<const TiledTileset> LoadTiledTilesetCached(const std::string& path);
+
+// Resolve `rel` (as found in a map) against the directory of `map_path`.
+std::string TiledResolvePath(const std::string& map_path, const std::string& rel);
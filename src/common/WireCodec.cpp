@@ -0,0 +1,270 @@
+// WireCodec.cpp — schema dei campi di PlayerState / InputFrame e quantizzazione.
+
+#include "WireCodec.h"
+#include "Physics.h"
+#include "Protocol.h"   // PKT_INPUT
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+namespace {
+
+// Bit necessari per rappresentare 0..max.
+constexpr int BitsFor(unsigned max) {
+    int n = 0;
+    while ((1u << n) <= max) ++n;
+    return n;
+}
+
+enum class Kind : uint8_t {
+    POS,      // float, signed fixed point WIRE_POS_BITS @ 1/WIRE_POS_SCALE
+    VEL,      // float, signed fixed point WIRE_VEL_BITS @ 1/WIRE_VEL_SCALE
+    DIR,      // float in [-1, 1], int8 @ 1/WIRE_DIR_SCALE
+    U8,       // uint8_t counter, `bits` wide (clamped)
+    S8,       // int8_t in [-1, 1], 2 bits
+    COUNTER,  // uint32_t, zig-zag varint delta vs. baseline
+    FLAGS,    // the nine bools, one bit each
+};
+
+struct Field {
+    Kind   kind;
+    size_t offset;
+    int    bits;
+};
+
+#define F(kind, member, bits) Field{ Kind::kind, offsetof(PlayerState, member), bits }
+
+// Ordine = formato sul filo: aggiungere campi solo in coda e incrementare PROTOCOL_VERSION.
+constexpr Field kSchema[] = {
+    F(POS,     x,                   WIRE_POS_BITS),
+    F(POS,     y,                   WIRE_POS_BITS),
+    F(VEL,     vel_x,               WIRE_VEL_BITS),
+    F(VEL,     vel_y,               WIRE_VEL_BITS),
+    F(VEL,     move_vel_x,          WIRE_VEL_BITS),
+    F(FLAGS,   on_ground,           9),
+    F(U8,      jump_buffer_ticks,   BitsFor(JUMP_BUFFER_TICKS)),
+    F(U8,      coyote_ticks,        BitsFor(COYOTE_TICKS)),
+    F(S8,      last_wall_jump_dir,  2),
+    F(U8,      dash_active_ticks,   BitsFor(DASH_ACTIVE_TICKS)),
+    F(U8,      dash_cooldown_ticks, BitsFor(DASH_COOLDOWN_TICKS)),
+    F(S8,      last_dir,            2),
+    F(DIR,     dash_dir_x,          8),
+    F(DIR,     dash_dir_y,          8),
+    F(U8,      dash_jump_ticks,     BitsFor(DASH_JUMP_WINDOW_TICKS)),
+    F(U8,      launch_push_ticks,   BitsFor(LAUNCH_PUSH_TICKS)),
+    F(DIR,     launch_dir_x,        8),
+    F(DIR,     launch_dir_y,        8),
+    F(COUNTER, last_processed_tick, 0),
+    F(COUNTER, level_ticks,         0),
+    F(U8,      kill_respawn_ticks,  8),   // respawn timers are literals (PlayerReset.h): full byte
+    F(U8,      respawn_grace_ticks, 8),
+    F(POS,     checkpoint_x,        WIRE_POS_BITS),
+    F(POS,     checkpoint_y,        WIRE_POS_BITS),
+};
+
+#undef F
+
+constexpr int FIELD_COUNT = static_cast<int>(sizeof(kSchema) / sizeof(kSchema[0]));
+
+// --- Quantizzazione ----------------------------------------------------------
+
+int32_t ToFixed(float v, float scale, int bits) {
+    if (!std::isfinite(v)) return 0;
+    const long    q  = std::lround(v * scale);
+    const int32_t lo = -(1 << (bits - 1));
+    const int32_t hi =  (1 << (bits - 1)) - 1;
+    return static_cast<int32_t>(q < lo ? lo : (q > hi ? hi : q));
+}
+float FromFixed(int32_t q, float scale) { return static_cast<float>(q) / scale; }
+
+float SnapFixed(float v, float scale, int bits) { return FromFixed(ToFixed(v, scale, bits), scale); }
+
+// Directions are symmetric: [-127, 127] (-128 would decode below -1).
+int32_t ToDir(float v) {
+    const int32_t q = ToFixed(v, WIRE_DIR_SCALE, 8);
+    return q < -127 ? -127 : q;
+}
+float SnapDir(float v) { return FromFixed(ToDir(v), WIRE_DIR_SCALE); }
+
+uint8_t ClampU8(uint8_t v, int bits) {
+    const unsigned hi = (1u << bits) - 1u;
+    return static_cast<uint8_t>(v > hi ? hi : v);
+}
+int8_t ClampS8(int8_t v) { return static_cast<int8_t>(v < -1 ? -1 : (v > 1 ? 1 : v)); }
+
+// --- Accesso ai campi ------------------------------------------------------------
+
+template <typename T>
+T& At(PlayerState& s, const Field& f) { return *reinterpret_cast<T*>(reinterpret_cast<uint8_t*>(&s) + f.offset); }
+template <typename T>
+const T& At(const PlayerState& s, const Field& f) { return *reinterpret_cast<const T*>(reinterpret_cast<const uint8_t*>(&s) + f.offset); }
+
+uint32_t PackFlags(const PlayerState& s) {
+    uint32_t f = 0;
+    if (s.on_ground)     f |= 1u << 0;
+    if (s.on_wall_left)  f |= 1u << 1;
+    if (s.on_wall_right) f |= 1u << 2;
+    if (s.dash_ready)    f |= 1u << 3;
+    if (s.finished)      f |= 1u << 4;
+    if (s.drawing)       f |= 1u << 5;
+    if (s.sprinting)     f |= 1u << 6;
+    if (s.magneting)     f |= 1u << 7;
+    if (s.grabbed)       f |= 1u << 8;
+    return f;
+}
+
+void UnpackFlags(uint32_t f, PlayerState& s) {
+    s.on_ground     = (f >> 0) & 1u;
+    s.on_wall_left  = (f >> 1) & 1u;
+    s.on_wall_right = (f >> 2) & 1u;
+    s.dash_ready    = (f >> 3) & 1u;
+    s.finished      = (f >> 4) & 1u;
+    s.drawing       = (f >> 5) & 1u;
+    s.sprinting     = (f >> 6) & 1u;
+    s.magneting     = (f >> 7) & 1u;
+    s.grabbed       = (f >> 8) & 1u;
+}
+
+constexpr uint16_t INPUT_BUTTON_MASK = (1u << 10) - 1u;   // BTN_LEFT .. BTN_MAGNET
+
+// Everything in an InputFrame except the tick: buttons (10) + three int8 axes = 34 bits.
+void WriteInputPayload(BitWriter& w, const InputFrame& f) {
+    w.WriteBits(f.buttons & INPUT_BUTTON_MASK, 10);
+    w.WriteSigned(ToDir(f.move_x),  8);
+    w.WriteSigned(ToDir(f.dash_dx), 8);
+    w.WriteSigned(ToDir(f.dash_dy), 8);
+}
+
+void ReadInputPayload(BitReader& r, InputFrame& f) {
+    f.buttons = static_cast<uint16_t>(r.ReadBits(10));
+    f.move_x  = FromFixed(r.ReadSigned(8), WIRE_DIR_SCALE);
+    f.dash_dx = FromFixed(r.ReadSigned(8), WIRE_DIR_SCALE);
+    f.dash_dy = FromFixed(r.ReadSigned(8), WIRE_DIR_SCALE);
+}
+
+bool SameInputPayload(const InputFrame& a, const InputFrame& b) {
+    return (a.buttons & INPUT_BUTTON_MASK) == (b.buttons & INPUT_BUTTON_MASK)
+        && ToDir(a.move_x)  == ToDir(b.move_x)
+        && ToDir(a.dash_dx) == ToDir(b.dash_dx)
+        && ToDir(a.dash_dy) == ToDir(b.dash_dy);
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Quantizzazione
+// ---------------------------------------------------------------------------
+void QuantizePlayerState(PlayerState& s) {
+    for (const Field& f : kSchema) {
+        switch (f.kind) {
+            case Kind::POS: At<float>(s, f) = SnapFixed(At<float>(s, f), WIRE_POS_SCALE, f.bits); break;
+            case Kind::VEL: At<float>(s, f) = SnapFixed(At<float>(s, f), WIRE_VEL_SCALE, f.bits); break;
+            case Kind::DIR: At<float>(s, f) = SnapDir(At<float>(s, f));                           break;
+            case Kind::U8:  At<uint8_t>(s, f) = ClampU8(At<uint8_t>(s, f), f.bits);               break;
+            case Kind::S8:  At<int8_t>(s, f)  = ClampS8(At<int8_t>(s, f));                        break;
+            case Kind::COUNTER:
+            case Kind::FLAGS:
+                break;
+        }
+    }
+}
+
+void QuantizeInputFrame(InputFrame& f) {
+    f.buttons = static_cast<uint16_t>(f.buttons & INPUT_BUTTON_MASK);
+    f.move_x  = SnapDir(f.move_x);
+    f.dash_dx = SnapDir(f.dash_dx);
+    f.dash_dy = SnapDir(f.dash_dy);
+}
+
+// ---------------------------------------------------------------------------
+// InputFrame
+// ---------------------------------------------------------------------------
+void WriteInputFrame(BitWriter& w, const InputFrame& f) {
+    w.WriteBits(f.tick, 32);
+    WriteInputPayload(w, f);
+}
+
+void ReadInputFrame(BitReader& r, InputFrame& f) {
+    f.tick = r.ReadBits(32);
+    ReadInputPayload(r, f);
+}
+
+void EncodeInputPacket(uint32_t snapshot_ack, uint8_t level_epoch,
+                       const InputFrame* frames, int count, std::vector<uint8_t>& out) {
+    out.push_back(PKT_INPUT);
+    BitWriter w(out);
+    w.WriteBits(snapshot_ack, 32);
+    w.WriteBits(level_epoch, 8);
+    w.WriteBits(static_cast<uint32_t>(count - 1), 4);
+    WriteInputFrame(w, frames[0]);
+    for (int i = 1; i < count; ++i) {
+        const bool changed = !SameInputPayload(frames[i], frames[i - 1]);
+        w.WriteBool(changed);
+        if (changed) WriteInputPayload(w, frames[i]);
+    }
+}
+
+bool DecodeInputPacket(const uint8_t* data, size_t len, uint32_t& snapshot_ack,
+                       uint8_t& level_epoch, InputFrame* frames, int& count) {
+    if (len < 1 || data[0] != PKT_INPUT) return false;
+    BitReader r(data + 1, len - 1);
+    snapshot_ack = r.ReadBits(32);
+    level_epoch  = static_cast<uint8_t>(r.ReadBits(8));
+    count        = static_cast<int>(r.ReadBits(4)) + 1;
+    ReadInputFrame(r, frames[0]);
+    for (int i = 1; i < count; ++i) {
+        if (r.ReadBool()) ReadInputPayload(r, frames[i]);
+        else              frames[i] = frames[i - 1];
+        frames[i].tick = frames[i - 1].tick + 1;
+    }
+    return !r.Overflowed() && r.AtEnd();
+}
+
+// ---------------------------------------------------------------------------
+// PlayerState schema
+// ---------------------------------------------------------------------------
+int PlayerFieldCount() { return FIELD_COUNT; }
+
+bool PlayerFieldEqual(int field, const PlayerState& a, const PlayerState& b) {
+    const Field& f = kSchema[field];
+    switch (f.kind) {
+        case Kind::POS:
+        case Kind::VEL:
+        case Kind::DIR:     return std::memcmp(&At<float>(a, f), &At<float>(b, f), sizeof(float)) == 0;
+        case Kind::U8:      return At<uint8_t>(a, f)  == At<uint8_t>(b, f);
+        case Kind::S8:      return At<int8_t>(a, f)   == At<int8_t>(b, f);
+        case Kind::COUNTER: return At<uint32_t>(a, f) == At<uint32_t>(b, f);
+        case Kind::FLAGS:   return PackFlags(a) == PackFlags(b);
+    }
+    return false;
+}
+
+void WritePlayerField(BitWriter& w, int field, const PlayerState& s, const PlayerState& base) {
+    const Field& f = kSchema[field];
+    switch (f.kind) {
+        case Kind::POS:     w.WriteSigned(ToFixed(At<float>(s, f), WIRE_POS_SCALE, f.bits), f.bits); break;
+        case Kind::VEL:     w.WriteSigned(ToFixed(At<float>(s, f), WIRE_VEL_SCALE, f.bits), f.bits); break;
+        case Kind::DIR:     w.WriteSigned(ToDir(At<float>(s, f)), 8);                                break;
+        case Kind::U8:      w.WriteBits(ClampU8(At<uint8_t>(s, f), f.bits), f.bits);                 break;
+        case Kind::S8:      w.WriteSigned(ClampS8(At<int8_t>(s, f)), 2);                             break;
+        case Kind::COUNTER:
+            w.WriteVarInt(static_cast<int32_t>(At<uint32_t>(s, f) - At<uint32_t>(base, f)));
+            break;
+        case Kind::FLAGS:   w.WriteBits(PackFlags(s), 9);                                           break;
+    }
+}
+
+void ReadPlayerField(BitReader& r, int field, PlayerState& s, const PlayerState& base) {
+    const Field& f = kSchema[field];
+    switch (f.kind) {
+        case Kind::POS:     At<float>(s, f)   = FromFixed(r.ReadSigned(f.bits), WIRE_POS_SCALE); break;
+        case Kind::VEL:     At<float>(s, f)   = FromFixed(r.ReadSigned(f.bits), WIRE_VEL_SCALE); break;
+        case Kind::DIR:     At<float>(s, f)   = FromFixed(r.ReadSigned(8), WIRE_DIR_SCALE);      break;
+        case Kind::U8:      At<uint8_t>(s, f) = static_cast<uint8_t>(r.ReadBits(f.bits));       break;
+        case Kind::S8:      At<int8_t>(s, f)  = static_cast<int8_t>(r.ReadSigned(2));           break;
+        case Kind::COUNTER:
+            At<uint32_t>(s, f) = At<uint32_t>(base, f) + static_cast<uint32_t>(r.ReadVarInt());
+            break;
+        case Kind::FLAGS:   UnpackFlags(r.ReadBits(9), s);                                      break;
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+// Schema-driven bit-packed encoding of PlayerState and InputFrame.
+// No Raylib or ENet dependency.
+//
+// Quantisation is part of the simulation contract, not only of the wire format:
+// Player::Simulate ends every tick with QuantizePlayerState, the server re-quantises
+// after its own post-processing (grab, collisions), and the client quantises every
+// InputFrame before simulating and sending it. Values therefore already sit on the
+// wire grid when encoded, and decode(encode(s)) == s bit-for-bit for every field the
+// simulation reads. PlayerState::name is not part of the per-tick schema; names travel
+// in PKT_ROSTER.
+#include "BitStream.h"
+#include "InputFrame.h"
+#include "PlayerState.h"
+
+// Fixed-point grids. Powers of two keep every grid value exactly representable as float.
+inline constexpr float WIRE_POS_SCALE = 16.f;   // positions: 1/16 px
+inline constexpr int   WIRE_POS_BITS  = 26;     // signed → ±2^21 px (±65536 tiles)
+inline constexpr float WIRE_VEL_SCALE = 16.f;   // velocities: 1/16 px/s
+inline constexpr int   WIRE_VEL_BITS  = 18;     // signed → ±8192 px/s
+inline constexpr float WIRE_DIR_SCALE = 127.f;  // directions / axes: int8 in [-127, 127]
+
+// Snap every quantised field of s onto its wire grid (idempotent).
+void QuantizePlayerState(PlayerState& s);
+// Snap move_x / dash_dx / dash_dy onto the int8 grid and drop unknown button bits.
+void QuantizeInputFrame(InputFrame& f);
+
+// InputFrame: tick (32) + buttons (10) + move_x, dash_dx, dash_dy (8 each) = 66 bits.
+void WriteInputFrame(BitWriter& w, const InputFrame& f);
+void ReadInputFrame (BitReader& r, InputFrame& f);
+
+// PKT_INPUT carries the newest INPUT_BUNDLE_MAX frames the server has not confirmed yet
+// (≈ 267 ms at 60 Hz), oldest first, with consecutive ticks. Layout after the type byte:
+//   u32 snapshot_ack, u8 level_epoch, 4 bits count-1,
+//   first frame in full (WriteInputFrame),
+//   then per frame 1 bit "changed" + buttons/axes (34 bits) only when it differs
+//   from the previous one. A held input costs 1 bit per extra frame.
+inline constexpr int INPUT_BUNDLE_MAX = 16;
+
+void EncodeInputPacket(uint32_t snapshot_ack, uint8_t level_epoch,
+                       const InputFrame* frames, int count, std::vector<uint8_t>& out);
+// frames must hold INPUT_BUNDLE_MAX entries. Returns false on malformed input.
+bool DecodeInputPacket(const uint8_t* data, size_t len, uint32_t& snapshot_ack,
+                       uint8_t& level_epoch, InputFrame* frames, int& count);
+
+// PlayerState schema, one entry per delta-encodable field (player_id and name excluded).
+// Counter fields are written relative to the same field in base, so a monotonically
+// increasing tick costs a few bits instead of 32.
+int  PlayerFieldCount();
+bool PlayerFieldEqual(int field, const PlayerState& a, const PlayerState& b);
+void WritePlayerField(BitWriter& w, int field, const PlayerState& s, const PlayerState& base);
+void ReadPlayerField (BitReader& r, int field, PlayerState& s, const PlayerState& base);
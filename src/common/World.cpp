@@ -1,225 +1,108 @@
 #include "World.h"
+#include "Physics.h"    // TILE_SIZE
+#include "TiledParser.h"
 #include <fstream>
 #include <sstream>
 #include <algorithm>    // std::max
-#include <cctype>       // std::isdigit
-#include <cstring>      // std::strstr
+#include <array>
+#include <cstdio>
 #include <string>
+#include <utility>
 #include <vector>
-#include <unordered_map>
 
 // ============================================================================
-// Internal helpers
+// World public interface
 // ============================================================================
 
-// Returns the directory portion of a file path (e.g. "a/b/c.txt" → "a/b").
-static std::string DirOf(const std::string& path) {
-    size_t pos = path.find_last_of("/\\");
-    return (pos == std::string::npos) ? std::string(".") : path.substr(0, pos);
+void World::Allocate(int w, int h) {
+    width_  = w > 0 ? w : 0;
+    height_ = h > 0 ? h : 0;
+    stride_ = width_ + 2;
+    words_  = (stride_ + 63) / 64;
+    tiles_.assign(static_cast<size_t>(stride_) * (height_ + 2), ' ');
+    classes_.assign(tiles_.size(), 0);
+    solid_.assign(static_cast<size_t>(words_)  * (height_ + 2), 0);
 }
 
-// Reads an entire file into a std::string.
-static bool ReadFile(const char* path, std::string& out) {
-    std::ifstream f(path, std::ios::binary);
-    if (!f.is_open()) return false;
-    out.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
-    return true;
-}
-
-// ============================================================================
-// Minimal JSON helpers for .tmj parsing
-// (handles the flat Tiled uncompressed orthogonal format only)
-// ============================================================================
-
-// Find the first integer value associated with "key" at any depth in `json`.
-static bool JsonGetInt(const std::string& json, const std::string& key, int& out) {
-    const std::string search = "\"" + key + "\"";
-    size_t pos = json.find(search);
-    if (pos == std::string::npos) return false;
-    pos += search.size();
-    while (pos < json.size() && (json[pos] == ' ' || json[pos] == ':' || json[pos] == '\t')) ++pos;
-    if (pos >= json.size()) return false;
-    try { out = std::stoi(json.substr(pos)); return true; }
-    catch (...) { return false; }
-}
+bool World::LoadFromGrid(int w, int h, const std::vector<std::string>& rows) {
+    if (w <= 0 || h <= 0) return false;
+    if (static_cast<int>(rows.size()) < h) return false;
 
-// Find the first string value (unescaping `\/` → `/`) for "key" in `json`.
-static bool JsonGetString(const std::string& json, const std::string& key, std::string& out) {
-    const std::string search = "\"" + key + "\"";
-    size_t pos = json.find(search);
-    if (pos == std::string::npos) return false;
-    pos += search.size();
-    while (pos < json.size() && (json[pos] == ' ' || json[pos] == ':' || json[pos] == '\t')) ++pos;
-    if (pos >= json.size() || json[pos] != '"') return false;
-    ++pos;
-    const size_t end = json.find('"', pos);
-    if (end == std::string::npos) return false;
-    out = json.substr(pos, end - pos);
-    // Unescape `\/` → `/` (Tiled path separator escaping)
-    for (size_t i = 0; i + 1 < out.size(); ) {
-        if (out[i] == '\\' && out[i + 1] == '/') { out.erase(i, 1); }
-        else ++i;
+    Allocate(w, h);
+    for (int y = 0; y < height_; ++y) {
+        const std::string& row = rows[y];
+        const int n = std::min(width_, static_cast<int>(row.size()));   // short rows: air
+        for (int x = 0; x < n; ++x)
+            SetTile(x, y, row[x], row[x] == '0');
     }
     return true;
 }
 
-// Extract the tile GID data array from the first "tilelayer" layer.
-// Scans the content of the first '[' after the first `"data"` key.
-static bool TmjParseData(const std::string& json, std::vector<int>& data) {
-    const size_t data_key = json.find("\"data\"");
-    if (data_key == std::string::npos) return false;
-    const size_t arr_open = json.find('[', data_key);
-    if (arr_open == std::string::npos) return false;
-    const size_t arr_close = json.find(']', arr_open);
-    if (arr_close == std::string::npos) return false;
-
-    size_t cur = arr_open + 1;
-    while (cur < arr_close) {
-        // Skip whitespace and separators
-        while (cur < arr_close &&
-               (json[cur] == ' ' || json[cur] == ',' ||
-                json[cur] == '\n' || json[cur] == '\r' || json[cur] == '\t')) ++cur;
-        if (cur >= arr_close) break;
+bool World::LoadFromTiles(int w, int h, const char* tiles, const uint8_t* solid_bits) {
+    if (w <= 0 || h <= 0) return false;
 
-        // Parse an integer (positive; GIDs are never negative in standard Tiled)
-        size_t num_end = cur;
-        while (num_end < arr_close && std::isdigit(static_cast<unsigned char>(json[num_end]))) ++num_end;
-        if (num_end > cur) {
-            try { data.push_back(std::stoi(json.substr(cur, num_end - cur))); }
-            catch (...) { data.push_back(0); }
-            cur = num_end;
-        } else {
-            ++cur; // skip unexpected char
+    Allocate(w, h);
+    for (int y = 0; y < height_; ++y) {
+        for (int x = 0; x < width_; ++x) {
+            const size_t i = static_cast<size_t>(y) * width_ + x;
+            SetTile(x, y, tiles[i], (solid_bits[i >> 3] >> (i & 7)) & 1);
         }
     }
-    return !data.empty();
+    return true;
 }
 
-// ============================================================================
-// Minimal TSX (XML) parser for Tiled tilesets
-// ============================================================================
-
-struct TileProps {
-    std::string type;   // "platform" | "kill" | "end" | "spawn"
-    bool        solid = false;
-};
-
-// Parse a TileSet.tsx file and return a map of tile_id → TileProps.
-static std::unordered_map<int, TileProps> TsxParse(const std::string& tsx_path) {
-    std::unordered_map<int, TileProps> result;
-
-    std::string content;
-    if (!ReadFile(tsx_path.c_str(), content)) return result;
-
-    size_t pos = 0;
-    while (true) {
-        // Find next <tile id="N"> opening tag
-        const size_t tile_tag = content.find("<tile id=\"", pos);
-        if (tile_tag == std::string::npos) break;
-
-        const size_t id_start = tile_tag + 10; // skip '<tile id="'
-        const size_t id_quote = content.find('"', id_start);
-        if (id_quote == std::string::npos) break;
-
-        int tile_id = 0;
-        try { tile_id = std::stoi(content.substr(id_start, id_quote - id_start)); }
-        catch (...) { pos = tile_tag + 1; continue; }
-
-        // Extract the block up to </tile>
-        const size_t close_tag = content.find("</tile>", tile_tag);
-        const size_t block_end = (close_tag == std::string::npos) ? content.size() : close_tag;
-        const std::string block = content.substr(tile_tag, block_end - tile_tag);
-
-        TileProps props;
-
-        // --- solid property:  name="solid" ... value="true/false" ---
-        const size_t solid_name = block.find("name=\"solid\"");
-        if (solid_name != std::string::npos) {
-            const size_t val_pos = block.find("value=\"", solid_name);
-            if (val_pos != std::string::npos) {
-                const size_t v = val_pos + 7;
-                props.solid = (block.substr(v, 4) == "true");
-            }
-        }
+bool World::LoadFromPadded(int w, int h, std::vector<char>&& padded) {
+    if (w <= 0 || h <= 0) return false;
+    if (padded.size() != static_cast<size_t>(w + 2) * (h + 2)) return false;
 
-        // --- type property:  name="type" ... value="spawn|platform|kill|end" ---
-        const size_t type_name = block.find("name=\"type\"");
-        if (type_name != std::string::npos) {
-            const size_t val_pos = block.find("value=\"", type_name);
-            if (val_pos != std::string::npos) {
-                const size_t v = val_pos + 7;
-                const size_t q = block.find('"', v);
-                if (q != std::string::npos)
-                    props.type = block.substr(v, q - v);
-            }
+    width_  = w;
+    height_ = h;
+    stride_ = w + 2;
+    words_  = (stride_ + 63) / 64;
+    tiles_  = std::move(padded);
+    classes_.assign(tiles_.size(), 0);
+    solid_.assign(static_cast<size_t>(words_) * (height_ + 2), 0);
+    // Class depends on the char alone here: one table lookup per tile, and solid bits
+    // gathered a word at a time.
+    static const auto class_of = [] {
+        std::array<uint8_t, 256> t{};
+        for (int c = 0; c < 256; ++c) t[c] = ClassOf(static_cast<char>(c), c == '0');
+        return t;
+    }();
+    for (int y = 1; y <= height_; ++y) {
+        const char* row  = tiles_.data() + static_cast<size_t>(y) * stride_;
+        uint8_t*    cls  = classes_.data() + static_cast<size_t>(y) * stride_;
+        uint64_t*   bits = solid_.data() + static_cast<size_t>(y) * words_;
+        for (int x = 1; x <= width_; ++x) cls[x] = class_of[static_cast<uint8_t>(row[x])];
+        for (int i = 0; i < words_; ++i) {
+            const int x0 = std::max(1, i * 64);
+            const int x1 = std::min(width_ + 1, i * 64 + 64);
+            uint64_t word = 0;
+            for (int x = x0; x < x1; ++x)
+                word |= static_cast<uint64_t>(row[x] == '0') << (x & 63);
+            bits[i] = word;
         }
-
-        result[tile_id] = props;
-        pos = tile_tag + 1;
     }
-    return result;
-}
-
-// Map a TMJ GID to a canonical World tile char.
-//   gid == 0         → air ' '
-//   otherwise        → look up tile_id = gid - firstgid in the TSX table
-static char GidToChar(int gid, int firstgid,
-                       const std::unordered_map<int, TileProps>& tsx) {
-    if (gid == 0) return ' ';
-    const int tile_id = gid - firstgid;
-    const auto it = tsx.find(tile_id);
-    if (it == tsx.end()) return ' ';
-    const std::string& t = it->second.type;
-    if (t == "platform") return '0';
-    if (t == "kill")     return 'K';
-    if (t == "end")      return 'E';
-    if (t == "spawn")    return 'X';
-    if (t == "checkpoint")  return 'C';
-    if (t == "chunk_entry") return 'I';
-    if (t == "chunk_exit")  return 'O';
-    return ' ';
+    return true;
 }
 
-// Map a TMJ GID to a solid flag.
-// NOTE: kill-type tiles are always non-solid regardless of the TSX "solid" property:
-// the player must be able to enter them so the kill-detection logic in ServerSession
-// can fire. Making them solid would cause the physics engine to push the player out
-// before any overlap check runs, so they would never die.
-static bool GidToSolid(int gid, int firstgid,
-                        const std::unordered_map<int, TileProps>& tsx) {
-    if (gid == 0) return false;
-    const int tile_id = gid - firstgid;
-    const auto it = tsx.find(tile_id);
-    if (it == tsx.end()) return false;
-    // Kill tiles are non-solid by design.
-    if (it->second.type == "kill") return false;
-    return it->second.solid;
+void World::InitPending(int w, int h) {
+    Allocate(w, h);
+    for (int y = 0; y < height_; ++y)
+        for (int x = 0; x < width_; ++x)
+            SetTile(x, y, PENDING_TILE, true);
 }
 
-// ============================================================================
-// World public interface
-// ============================================================================
-
-bool World::LoadFromGrid(int w, int h, const std::vector<std::string>& rows) {
-    if (w <= 0 || h <= 0) return false;
-    if (static_cast<int>(rows.size()) < h) return false;
-
-    rows_.clear();
-    solid_grid_.clear();
-    width_  = w;
-    height_ = h;
-
-    rows_.resize(height_);
-    solid_grid_.resize(height_);
-    for (int y = 0; y < height_; ++y) {
-        rows_[y] = rows[y];
-        if (static_cast<int>(rows_[y].size()) < width_)
-            rows_[y].resize(width_, ' ');
-        solid_grid_[y].resize(width_);
-        for (int x = 0; x < width_; ++x)
-            solid_grid_[y][x] = (rows_[y][x] == '0');
+void World::BlitRows(int x0, int y0, const std::vector<std::string>& rows) {
+    for (int y = 0; y < static_cast<int>(rows.size()); ++y) {
+        const int ty = y0 + y;
+        if (ty < 0 || ty >= height_) continue;
+        for (int x = 0; x < static_cast<int>(rows[y].size()); ++x) {
+            const int tx = x0 + x;
+            if (tx < 0 || tx >= width_) continue;
+            SetTile(tx, ty, rows[y][x], rows[y][x] == '0');
+        }
     }
-    return true;
 }
 
 bool World::LoadFromFile(const char* path) {
@@ -230,25 +113,78 @@ bool World::LoadFromFile(const char* path) {
     return LoadTxt(path);
 }
 
-bool World::IsSolid(int tx, int ty) const {
+uint8_t World::ClassOf(char ch, bool solid) {
+    uint8_t c = solid ? TILE_SOLID : 0;
+    switch (ch) {
+        case 'K':          c |= TILE_KILL;        break;
+        case 'E':          c |= TILE_EXIT;        break;
+        case 'C':          c |= TILE_CHECKPOINT;  break;
+        case 'X':          c |= TILE_SPAWN;       break;
+        case 'I':          c |= TILE_CHUNK_ENTRY; break;
+        case 'O':          c |= TILE_CHUNK_EXIT;  break;
+        case PENDING_TILE: c |= TILE_PENDING;     break;
+        default: break;
+    }
+    return c;
+}
+
+uint8_t World::QueryAABB(float x, float y, float w, float h) const {
+    const int tx0 = static_cast<int>(x)           / TILE_SIZE;
+    const int ty0 = static_cast<int>(y)           / TILE_SIZE;
+    const int tx1 = static_cast<int>(x + w - 1.f) / TILE_SIZE;
+    const int ty1 = static_cast<int>(y + h - 1.f) / TILE_SIZE;
+    // Player-sized boxes touch at most 2x2 tiles: four loads, no loop.
+    if (tx1 - tx0 <= 1 && ty1 - ty0 <= 1)
+        return GetClass(tx0, ty0) | GetClass(tx1, ty0) | GetClass(tx0, ty1) | GetClass(tx1, ty1);
+    uint8_t mask = 0;
+    for (int ty = ty0; ty <= ty1; ++ty)
+        for (int tx = tx0; tx <= tx1; ++tx)
+            mask |= GetClass(tx, ty);
+    return mask;
+}
+
+bool World::AnySolidInRow(int ty, int x0, int x1) const {
     if (ty < 0 || ty >= height_) return false;
-    if (tx < 0 || tx >= width_)  return false;
-    if (ty >= static_cast<int>(solid_grid_.size())) return false;
-    const auto& row = solid_grid_[ty];
-    if (tx >= static_cast<int>(row.size())) return false;
-    return row[tx];
+    x0 = std::max(x0, 0);
+    x1 = std::min(x1, width_ - 1);
+    if (x0 > x1) return false;
+
+    // Bit range [b0, b1] in padded coordinates, checked a word at a time.
+    const uint64_t* row = solid_.data() + static_cast<size_t>(ty + 1) * words_;
+    const int b0 = x0 + 1, b1 = x1 + 1;
+    const int w0 = b0 >> 6, w1 = b1 >> 6;
+    const uint64_t lo = ~uint64_t{0} << (b0 & 63);
+    const uint64_t hi = ~uint64_t{0} >> (63 - (b1 & 63));
+    if (w0 == w1) return (row[w0] & lo & hi) != 0;
+    if (row[w0] & lo) return true;
+    for (int i = w0 + 1; i < w1; ++i)
+        if (row[i]) return true;
+    return (row[w1] & hi) != 0;
 }
 
-char World::GetTile(int tx, int ty) const {
-    if (ty < 0 || ty >= height_) return ' ';
-    if (tx < 0 || tx >= width_)  return ' ';
-    return rows_[ty][tx];
+bool World::AnySolidInColumn(int tx, int y0, int y1) const {
+    if (tx < 0 || tx >= width_) return false;
+    y0 = std::max(y0, 0);
+    y1 = std::min(y1, height_ - 1);
+    const int      x     = tx + 1;
+    const uint64_t bit   = uint64_t{1} << (x & 63);
+    const uint64_t* word = solid_.data() + (x >> 6);
+    for (int y = y0; y <= y1; ++y)
+        if (word[static_cast<size_t>(y + 1) * words_] & bit) return true;
+    return false;
+}
+
+std::vector<std::string> World::GetRows() const {
+    std::vector<std::string> rows(height_);
+    for (int y = 0; y < height_; ++y)
+        rows[y].assign(Row(y), width_);
+    return rows;
 }
 
 void World::StripCheckpoints() {
     for (int y = 0; y < height_; ++y)
         for (int x = 0; x < width_; ++x)
-            if (rows_[y][x] == 'C') rows_[y][x] = ' ';
+            if (GetTile(x, y) == 'C') SetTile(x, y, ' ', IsSolid(x, y));
 }
 
 // ============================================================================
@@ -259,81 +195,36 @@ bool World::LoadTxt(const char* path) {
     std::ifstream file(path);
     if (!file.is_open()) return false;
 
-    rows_.clear();
-    solid_grid_.clear();
-    width_ = height_ = 0;
-
+    std::vector<std::string> lines;
+    int w = 0;
     std::string line;
     while (std::getline(file, line)) {
-        width_ = std::max(width_, static_cast<int>(line.size()));
-        rows_.push_back(std::move(line));
-    }
-
-    // Pad all rows to uniform width
-    for (auto& row : rows_) {
-        if (static_cast<int>(row.size()) < width_)
-            row.resize(width_, ' ');
-    }
-
-    height_ = static_cast<int>(rows_.size());
-
-    // Build solid grid: only '0' is solid in legacy format
-    solid_grid_.resize(height_);
-    for (int y = 0; y < height_; ++y) {
-        solid_grid_[y].resize(width_);
-        for (int x = 0; x < width_; ++x)
-            solid_grid_[y][x] = (rows_[y][x] == '0');
+        w = std::max(w, static_cast<int>(line.size()));
+        lines.push_back(std::move(line));
     }
 
-    return height_ > 0;
+    // Short rows are padded with air; only '0' is solid in legacy format
+    return LoadFromGrid(w, static_cast<int>(lines.size()), lines);
 }
 
 bool World::LoadTmj(const char* path) {
-    std::string json;
-    if (!ReadFile(path, json)) return false;
-
-    // --- Extract map dimensions ---
-    int map_w = 0, map_h = 0;
-    if (!JsonGetInt(json, "width",  map_w) ||
-        !JsonGetInt(json, "height", map_h) ||
-        map_w <= 0 || map_h <= 0) return false;
-
-    // --- Extract firstgid and tileset source path ---
-    int firstgid = 1;
-    JsonGetInt(json, "firstgid", firstgid);   // falls back to 1 on error
-
-    std::string tsx_src;
-    if (!JsonGetString(json, "source", tsx_src)) return false;
-
-    // Resolve TSX path relative to the TMJ file's directory
-    const std::string tsx_path = DirOf(std::string(path)) + "/" + tsx_src;
-
-    // --- Parse the TSX tile properties ---
-    const auto tsx = TsxParse(tsx_path);
-
-    // --- Extract tile data array ---
-    std::vector<int> data;
-    if (!TmjParseData(json, data)) return false;
-
-    const int expected = map_w * map_h;
-    if (static_cast<int>(data.size()) < expected) return false;
-
-    // --- Build rows_ and solid_grid_ ---
-    rows_.clear();
-    solid_grid_.clear();
-    width_  = map_w;
-    height_ = map_h;
-
-    rows_.resize(height_);
-    solid_grid_.resize(height_);
-
+    TiledMap map;
+    if (!LoadTiledMap(path, map)) return false;
+
+    // Tileset resolved relative to the TMJ file's directory. A missing TSX still
+    // loads the map (every tile becomes air), as before.
+    static const TiledTileset no_tiles;
+    const auto cached = LoadTiledTilesetCached(TiledResolvePath(path, map.tileset_source));
+    if (!cached)
+        printf("[world] WARNING: tileset '%s' not loaded\n", map.tileset_source.c_str());
+    const TiledTileset& tsx = cached ? *cached : no_tiles;
+
+    // --- Build tiles and solid bitset ---
+    Allocate(map.width, map.height);
     for (int y = 0; y < height_; ++y) {
-        rows_[y].resize(width_);
-        solid_grid_[y].resize(width_);
         for (int x = 0; x < width_; ++x) {
-            const int gid = data[y * width_ + x];
-            rows_[y][x]       = GidToChar (gid, firstgid, tsx);
-            solid_grid_[y][x] = GidToSolid(gid, firstgid, tsx);
+            const TiledTile t = tsx.Lookup(map.gids[static_cast<size_t>(y) * width_ + x], map.firstgid);
+            SetTile(x, y, t.ch, t.solid);
         }
     }
 
@@ -1,4 +1,6 @@
 #pragma once
+#include <algorithm>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -12,28 +14,91 @@
 //   'K' = kill             (non-solid by default; touching respawns the player)
 //   'X' = spawn            (non-solid; player start position)
 //   ' ' = air
+//   '?' = not received yet (PENDING_TILE, solid; only while a level streams in)
 //
 // For .tmj files the solid flag comes from the TileSet.tsx "solid" property,
 // so each tile type can independently be solid or non-solid.
+//
+// Storage: one row-major char array, one TileClass mask per tile and one solid bitset
+// (64-bit words per row), all with a one-tile border of air around the map. Lookups clamp
+// the coordinate into the border instead of branching, so IsSolid / GetTile / GetClass
+// cost one load each at any position.
+
+// Per-tile class bits, computed from the tile char (and solid flag) at load time.
+enum TileClass : uint8_t {
+    TILE_SOLID       = 1u << 0,
+    TILE_KILL        = 1u << 1,   // 'K'
+    TILE_EXIT        = 1u << 2,   // 'E'
+    TILE_CHECKPOINT  = 1u << 3,   // 'C'
+    TILE_SPAWN       = 1u << 4,   // 'X'
+    TILE_CHUNK_ENTRY = 1u << 5,   // 'I' (chunk templates only)
+    TILE_CHUNK_EXIT  = 1u << 6,   // 'O'
+    TILE_PENDING     = 1u << 7,   // PENDING_TILE
+};
+
 class World {
 public:
+    World() { Allocate(0, 0); }
+
     // Returns true if the file was opened and parsed successfully.
     // Accepts both .txt (legacy ASCII) and .tmj (Tiled JSON) paths.
     bool LoadFromFile(const char* path);
 
-    // Load from an in-memory char grid. solid_grid is reconstructed as (ch == '0').
+    // Load from an in-memory char grid. Solid flags are reconstructed as (ch == '0').
     // Used by the chunk-based level generator to load generated levels on both
     // server and client without writing temporary files.
     bool LoadFromGrid(int w, int h, const std::vector<std::string>& rows);
 
+    // Load from a flat row-major w*h char array plus a solid bitset (bit i = tile i,
+    // LSB first). Used for maps baked into levels.pack: no parsing, solid flags as authored.
+    bool LoadFromTiles(int w, int h, const char* tiles, const uint8_t* solid_bits);
+
+    // Take over a char grid already in the internal layout: (w + 2) x (h + 2), row-major,
+    // outer ring ' ' (see Row()). Solid flags as LoadFromGrid (ch == '0'). Used by
+    // LevelGenerator, which composes straight into this buffer: no rows, no copy.
+    bool LoadFromPadded(int w, int h, std::vector<char>&& padded);
+
+    // Region streaming (client): a w x h world made only of PENDING_TILE, filled in by
+    // BlitRows as regions arrive. Pending tiles are solid so nobody falls through them.
+    static constexpr char PENDING_TILE = '?';
+    void InitPending(int w, int h);
+
+    // Overwrite the rectangle starting at (x0, y0) with rows (clipped to the map) and
+    // rebuild its solid flags (ch == '0', as LoadFromGrid).
+    void BlitRows(int x0, int y0, const std::vector<std::string>& rows);
+
     // Returns true if tile (tx, ty) should block player movement.
     // For .txt: solid iff char == '0'.
     // For .tmj: solid iff the TSX "solid" property is true for that tile type.
     // Out-of-bounds coords always return false.
-    bool IsSolid(int tx, int ty) const;
+    bool IsSolid(int tx, int ty) const {
+        const int x = std::clamp(tx, -1, width_)  + 1;
+        const int y = std::clamp(ty, -1, height_) + 1;
+        return (solid_[static_cast<size_t>(y) * words_ + (x >> 6)] >> (x & 63)) & 1u;
+    }
 
     // Returns the canonical tile char at (tx, ty), or ' ' if out of bounds.
-    char GetTile(int tx, int ty) const;
+    char GetTile(int tx, int ty) const {
+        const int x = std::clamp(tx, -1, width_)  + 1;
+        const int y = std::clamp(ty, -1, height_) + 1;
+        return tiles_[static_cast<size_t>(y) * stride_ + x];
+    }
+
+    // TileClass bits of tile (tx, ty); 0 out of bounds.
+    uint8_t GetClass(int tx, int ty) const {
+        const int x = std::clamp(tx, -1, width_)  + 1;
+        const int y = std::clamp(ty, -1, height_) + 1;
+        return classes_[static_cast<size_t>(y) * stride_ + x];
+    }
+
+    // OR of the classes of every tile touched by the pixel box [x, x + w) x [y, y + h)
+    // (same corner rounding as the player AABB checks). One call answers finish, kill
+    // and checkpoint overlap for a player: QueryAABB(s.x, s.y, TILE_SIZE, TILE_SIZE).
+    uint8_t QueryAABB(float x, float y, float w, float h) const;
+
+    // Span queries (inclusive bounds, clipped to the map; empty span → false).
+    bool AnySolidInRow   (int ty, int x0, int x1) const;   // tiles (x0..x1, ty)
+    bool AnySolidInColumn(int tx, int y0, int y1) const;   // tiles (tx, y0..y1)
 
     int GetWidth()  const { return width_; }
     int GetHeight() const { return height_; }
@@ -42,14 +107,34 @@ public:
     // where checkpoints are not part of the gameplay.
     void StripCheckpoints();
 
-    const std::vector<std::string>&       GetRows()      const { return rows_; }
-    const std::vector<std::vector<bool>>& GetSolidGrid() const { return solid_grid_; }
+    // Tile chars of row ty (width_ chars, not NUL-terminated); ty must be in range.
+    const char* Row(int ty) const {
+        return tiles_.data() + static_cast<size_t>(ty + 1) * stride_ + 1;
+    }
+
+    // Compatibility copy of the char grid, one string per row (encoders, tools).
+    std::vector<std::string> GetRows() const;
 
 private:
-    std::vector<std::string>      rows_;        // char grid ('0','E','K','X',' ')
-    std::vector<std::vector<bool>> solid_grid_; // parallel solid-flag grid
+    std::vector<char>     tiles_;   // (width_ + 2) x (height_ + 2) chars, border = ' '
+    std::vector<uint8_t>  classes_; // TileClass bits, same layout, border = 0
+    std::vector<uint64_t> solid_;   // (height_ + 2) rows of words_ words, border bits = 0
     int width_  = 0;
     int height_ = 0;
+    int stride_ = 0;   // width_ + 2
+    int words_  = 0;   // 64-bit words per bitset row
+
+    void Allocate(int w, int h);   // air everywhere, nothing solid
+    static uint8_t ClassOf(char ch, bool solid);
+    void SetTile(int tx, int ty, char ch, bool solid) {
+        const size_t x = static_cast<size_t>(tx) + 1;
+        const size_t y = static_cast<size_t>(ty) + 1;
+        tiles_[y * stride_ + x]   = ch;
+        classes_[y * stride_ + x] = ClassOf(ch, solid);
+        uint64_t& word = solid_[y * words_ + (x >> 6)];
+        const uint64_t bit = uint64_t{1} << (x & 63);
+        word = solid ? (word | bit) : (word & ~bit);
+    }
 
     bool LoadTxt(const char* path);
     bool LoadTmj(const char* path);
@@ -0,0 +1,199 @@
+// ChunkLibrary.cpp — snapshot condiviso del chunk set + hot reload da disco.
+
+#include "ChunkLibrary.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Stop flag checked (and, without inotify, the directory scanned) at this period.
+constexpr int WATCH_PERIOD_MS = 250;
+// An editor save is several events (temp file, rename, tileset): reload once things are quiet.
+constexpr int SETTLE_MS       = 300;
+
+double MsSince(Clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+bool EndsWith(const char* s, const char* suffix) {
+    const size_t n = std::strlen(s), m = std::strlen(suffix);
+    return n >= m && std::strcmp(s + n - m, suffix) == 0;
+}
+
+// Files a chunk set depends on: the chunks themselves and the tileset next to them.
+bool IsChunkSource(const char* name) {
+    return EndsWith(name, ".tmj") || EndsWith(name, ".tsx");
+}
+
+#if !defined(__linux__)
+// Path, size and mtime of every source: changes whenever a file is saved, added or removed.
+uint64_t ScanFingerprint(const std::string& dir) {
+    uint64_t h = 0xCBF29CE484222325ull;
+    auto mix = [&h](const void* p, size_t n) {
+        const auto* b = static_cast<const uint8_t*>(p);
+        for (size_t i = 0; i < n; ++i) { h ^= b[i]; h *= 0x100000001B3ull; }
+    };
+    auto add = [&](const fs::path& p) {
+        std::error_code ec;
+        const std::string s   = p.generic_string();
+        const auto        sz  = fs::file_size(p, ec);
+        const auto        mt  = fs::last_write_time(p, ec).time_since_epoch().count();
+        mix(s.data(), s.size());
+        mix(&sz, sizeof(sz));
+        mix(&mt, sizeof(mt));
+    };
+    for (const std::string& f : ListTmjFiles(dir.c_str())) add(f);
+    std::error_code ec;
+    for (const auto& e : fs::directory_iterator(fs::path(dir).parent_path(), ec))
+        if (e.path().extension() == ".tsx") add(e.path());
+    return h;
+}
+#endif
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Snapshot
+// ---------------------------------------------------------------------------
+ChunkLibrary::ChunkLibrary(const char* dir, bool watch) : dir_(dir) {
+    auto store = std::make_shared<ChunkStore>();
+    store->LoadFromDirectory(dir_.c_str());
+    current_ = std::move(store);
+    if (watch) StartWatching();
+}
+
+ChunkLibrary::~ChunkLibrary() {
+    stop_ = true;
+    if (watcher_.joinable()) watcher_.join();
+}
+
+std::shared_ptr<const ChunkStore> ChunkLibrary::Current() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return current_;
+}
+
+void ChunkLibrary::StartWatching() {
+    if (watcher_.joinable()) return;
+    watcher_ = std::thread([this] { WatchLoop(); });
+}
+
+ChunkLibrary& ChunkLibrary::Shared() {
+    static ChunkLibrary library(CHUNKS_DIR, false);
+    return library;
+}
+
+bool ChunkLibrary::Reload() {
+    const auto t0 = Clock::now();
+    // The pack was validated against the sources at startup; after an edit it is stale.
+    auto store = std::make_shared<ChunkStore>();
+    const bool ok = store->LoadFromDirectory(dir_.c_str(), /*use_pack=*/false);
+    const auto old = Current();
+    const auto old_hash = static_cast<unsigned long long>(old->ContentHash());
+    if (!ok) {
+        printf("[ChunkLibrary] reload of '%s' has no start/mid/end chunks: keeping %016llx\n",
+               dir_.c_str(), old_hash);
+        return false;
+    }
+    if (store->ContentHash() == old->ContentHash()) {
+        printf("[ChunkLibrary] '%s' touched, chunk set unchanged\n", dir_.c_str());
+        return false;
+    }
+    const auto new_hash = static_cast<unsigned long long>(store->ContentHash());
+    const size_t count  = store->ChunkCount();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        current_ = std::move(store);
+    }
+    reloads_.fetch_add(1, std::memory_order_relaxed);
+    printf("[ChunkLibrary] chunk set %016llx --> %016llx (%zu chunks, %.1f ms): "
+           "used from the next generated level\n", old_hash, new_hash, count, MsSince(t0));
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Watcher
+// ---------------------------------------------------------------------------
+#if defined(__linux__)
+
+void ChunkLibrary::WatchLoop() {
+    const int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) {
+        printf("[ChunkLibrary] inotify unavailable: hot reload disabled\n");
+        return;
+    }
+    // Every directory under dir_ plus its parent (TileSet.tsx). Called again after each
+    // reload so new subdirectories are picked up; re-adding a watch is a no-op.
+    auto add_watches = [&] {
+        const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE;
+        inotify_add_watch(fd, fs::path(dir_).parent_path().string().c_str(), mask);
+        inotify_add_watch(fd, dir_.c_str(), mask);
+        std::error_code ec;
+        for (fs::recursive_directory_iterator it(dir_, ec), end; !ec && it != end; it.increment(ec))
+            if (it->is_directory(ec)) inotify_add_watch(fd, it->path().string().c_str(), mask);
+    };
+    add_watches();
+
+    bool              dirty = false;
+    Clock::time_point last_change;
+    alignas(inotify_event) char buf[4096];
+    while (!stop_) {
+        pollfd pfd{fd, POLLIN, 0};
+        if (poll(&pfd, 1, WATCH_PERIOD_MS) > 0) {
+            ssize_t n;
+            while ((n = read(fd, buf, sizeof(buf))) > 0) {
+                for (const char* p = buf; p < buf + n; ) {
+                    const auto* ev = reinterpret_cast<const inotify_event*>(p);
+                    if ((ev->mask & (IN_ISDIR | IN_Q_OVERFLOW)) ||
+                        (ev->len > 0 && IsChunkSource(ev->name))) {
+                        dirty       = true;
+                        last_change = Clock::now();
+                    }
+                    p += sizeof(inotify_event) + ev->len;
+                }
+            }
+        }
+        if (dirty && MsSince(last_change) >= SETTLE_MS) {
+            dirty = false;
+            add_watches();
+            Reload();
+        }
+    }
+    close(fd);
+}
+
+#else
+
+// No inotify: compare a fingerprint of the sources every WATCH_PERIOD_MS.
+void ChunkLibrary::WatchLoop() {
+    uint64_t          seen  = ScanFingerprint(dir_);
+    bool              dirty = false;
+    Clock::time_point last_change;
+    while (!stop_) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(WATCH_PERIOD_MS));
+        const uint64_t now = ScanFingerprint(dir_);
+        if (now != seen) {
+            seen        = now;
+            dirty       = true;
+            last_change = Clock::now();
+        }
+        if (dirty && MsSince(last_change) >= SETTLE_MS) {
+            dirty = false;
+            Reload();
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,57 @@
+#pragma once
+// SRP: one chunk set per process, shared by every room, the local server and the client.
+// Holds an immutable ChunkStore snapshot behind a shared_ptr. Hot reload is opt-in
+// (TileRace_Server --hot-reload): a background watcher then reloads the directory when
+// chunks or the tileset change on disk and swaps the new snapshot in. Readers keep
+// whatever snapshot they took (a generation worker finishes on the old one); the next
+// Current() returns the new one. No ENet or Raylib dependency.
+
+#include "ChunkStore.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+static constexpr const char* CHUNKS_DIR = "assets/levels/chunks";
+
+class ChunkLibrary {
+public:
+    // Load `dir` now (levels.pack if valid, see ChunkStore::LoadFromDirectory).
+    // watch = start the hot-reload thread at once (see StartWatching).
+    ChunkLibrary(const char* dir, bool watch);
+    ~ChunkLibrary();
+
+    ChunkLibrary(const ChunkLibrary&)            = delete;
+    ChunkLibrary& operator=(const ChunkLibrary&) = delete;
+
+    // Latest snapshot, never null (empty store if nothing loaded). Thread-safe.
+    std::shared_ptr<const ChunkStore> Current() const;
+
+    // Snapshots swapped in since construction.
+    uint32_t Reloads() const { return reloads_.load(std::memory_order_relaxed); }
+
+    // Reload from .tmj now (the pack no longer matches once a source changed).
+    // The snapshot is replaced only if the new set is usable and its ContentHash differs.
+    // true if a new snapshot was installed.
+    bool Reload();
+
+    // Start the hot-reload thread (inotify on Linux, polling elsewhere). No-op if it is
+    // already running. Not thread-safe: call it during startup, before the rooms exist.
+    void StartWatching();
+
+    // CHUNKS_DIR, loaded once on first call. A one-shot snapshot unless the process
+    // opts into StartWatching (the client never does).
+    static ChunkLibrary& Shared();
+
+private:
+    void WatchLoop();
+
+    std::string dir_;
+    mutable std::mutex                mutex_;      // guards current_ (pointer swap only)
+    std::shared_ptr<const ChunkStore> current_;
+    std::atomic<uint32_t>             reloads_{0};
+    std::atomic<bool>                 stop_{false};
+    std::thread                       watcher_;
+};
@@ -1,13 +1,12 @@
 // ChunkStore.cpp — loads all .tmj chunks from a directory, parses and classifies them.
 
 #include "ChunkStore.h"
-#include <fstream>
-#include <sstream>
+#include "LevelPack.h"
+#include "ThreadPool.h"
+#include "TiledParser.h"
 #include <cstdio>
 #include <cstring>
 #include <algorithm>
-#include <cctype>
-#include <unordered_map>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -19,7 +18,7 @@
 // Portable directory listing
 // ============================================================================
 
-static std::vector<std::string> ListTmjFiles(const std::string& dir) {
+std::vector<std::string> ListTmjFiles(const std::string& dir) {
     std::vector<std::string> result;
 
 #ifdef _WIN32
@@ -74,263 +73,65 @@ static std::vector<std::string> ListTmjFiles(const std::string& dir) {
     return result;
 }
 
-// ============================================================================
-// Minimal JSON / TMJ helpers (duplicated from World.cpp to keep ChunkStore self-contained)
-// ============================================================================
-
-static bool ReadFileStr(const char* path, std::string& out) {
-    std::ifstream f(path, std::ios::binary);
-    if (!f.is_open()) return false;
-    out.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
-    return true;
-}
-
-static std::string DirOfPath(const std::string& path) {
-    size_t pos = path.find_last_of("/\\");
-    return (pos == std::string::npos) ? std::string(".") : path.substr(0, pos);
-}
-
-static bool JGetInt(const std::string& json, const std::string& key, int& out) {
-    const std::string search = "\"" + key + "\"";
-    size_t pos = json.find(search);
-    if (pos == std::string::npos) return false;
-    pos += search.size();
-    while (pos < json.size() && (json[pos] == ' ' || json[pos] == ':' || json[pos] == '\t')) ++pos;
-    if (pos >= json.size()) return false;
-    // Handle negative numbers too
-    bool neg = false;
-    if (json[pos] == '-') { neg = true; ++pos; }
-    if (pos >= json.size() || !std::isdigit(static_cast<unsigned char>(json[pos]))) return false;
-    try { out = std::stoi(json.substr(neg ? pos - 1 : pos)); return true; }
-    catch (...) { return false; }
-}
-
-static bool JGetString(const std::string& json, const std::string& key, std::string& out) {
-    const std::string search = "\"" + key + "\"";
-    size_t pos = json.find(search);
-    if (pos == std::string::npos) return false;
-    pos += search.size();
-    while (pos < json.size() && (json[pos] == ' ' || json[pos] == ':' || json[pos] == '\t')) ++pos;
-    if (pos >= json.size() || json[pos] != '"') return false;
-    ++pos;
-    const size_t end = json.find('"', pos);
-    if (end == std::string::npos) return false;
-    out = json.substr(pos, end - pos);
-    for (size_t i = 0; i + 1 < out.size(); ) {
-        if (out[i] == '\\' && out[i + 1] == '/') { out.erase(i, 1); }
-        else ++i;
-    }
-    return true;
-}
-
-static bool ParseDataArray(const std::string& json, std::vector<int>& data) {
-    const size_t data_key = json.find("\"data\"");
-    if (data_key == std::string::npos) return false;
-    const size_t arr_open = json.find('[', data_key);
-    if (arr_open == std::string::npos) return false;
-    const size_t arr_close = json.find(']', arr_open);
-    if (arr_close == std::string::npos) return false;
-
-    size_t cur = arr_open + 1;
-    while (cur < arr_close) {
-        while (cur < arr_close &&
-               (json[cur] == ' ' || json[cur] == ',' ||
-                json[cur] == '\n' || json[cur] == '\r' || json[cur] == '\t')) ++cur;
-        if (cur >= arr_close) break;
-        size_t num_end = cur;
-        while (num_end < arr_close && std::isdigit(static_cast<unsigned char>(json[num_end]))) ++num_end;
-        if (num_end > cur) {
-            try { data.push_back(std::stoi(json.substr(cur, num_end - cur))); }
-            catch (...) { data.push_back(0); }
-            cur = num_end;
-        } else { ++cur; }
-    }
-    return !data.empty();
-}
-
-// ============================================================================
-// TSX parsing (same as World.cpp)
-// ============================================================================
-
-struct ChunkTileProps {
-    std::string type;
-    bool        solid = false;
-};
-
-static std::unordered_map<int, ChunkTileProps> ParseTsx(const std::string& tsx_path) {
-    std::unordered_map<int, ChunkTileProps> result;
-    std::string content;
-    if (!ReadFileStr(tsx_path.c_str(), content)) return result;
-
-    size_t pos = 0;
-    while (true) {
-        const size_t tile_tag = content.find("<tile id=\"", pos);
-        if (tile_tag == std::string::npos) break;
-        const size_t id_start = tile_tag + 10;
-        const size_t id_quote = content.find('"', id_start);
-        if (id_quote == std::string::npos) break;
-
-        int tile_id = 0;
-        try { tile_id = std::stoi(content.substr(id_start, id_quote - id_start)); }
-        catch (...) { pos = tile_tag + 1; continue; }
-
-        const size_t close_tag = content.find("</tile>", tile_tag);
-        const size_t block_end = (close_tag == std::string::npos) ? content.size() : close_tag;
-        const std::string block = content.substr(tile_tag, block_end - tile_tag);
-
-        ChunkTileProps props;
-        const size_t solid_name = block.find("name=\"solid\"");
-        if (solid_name != std::string::npos) {
-            const size_t val_pos = block.find("value=\"", solid_name);
-            if (val_pos != std::string::npos) {
-                const size_t v = val_pos + 7;
-                props.solid = (block.substr(v, 4) == "true");
-            }
-        }
-        const size_t type_name = block.find("name=\"type\"");
-        if (type_name != std::string::npos) {
-            const size_t val_pos = block.find("value=\"", type_name);
-            if (val_pos != std::string::npos) {
-                const size_t v = val_pos + 7;
-                const size_t q = block.find('"', v);
-                if (q != std::string::npos)
-                    props.type = block.substr(v, q - v);
-            }
-        }
-        result[tile_id] = props;
-        pos = tile_tag + 1;
-    }
-    return result;
-}
-
-static char TileToChar(int gid, int firstgid,
-                        const std::unordered_map<int, ChunkTileProps>& tsx) {
-    if (gid == 0) return ' ';
-    const int tile_id = gid - firstgid;
-    const auto it = tsx.find(tile_id);
-    if (it == tsx.end()) return ' ';
-    const std::string& t = it->second.type;
-    if (t == "platform")    return '0';
-    if (t == "kill")        return 'K';
-    if (t == "end")         return 'E';
-    if (t == "spawn")       return 'X';
-    if (t == "checkpoint")  return 'C';
-    if (t == "chunk_entry") return 'I';
-    if (t == "chunk_exit")  return 'O';
-    return ' ';
-}
-
-static bool TileToSolid(int gid, int firstgid,
-                          const std::unordered_map<int, ChunkTileProps>& tsx) {
-    if (gid == 0) return false;
-    const int tile_id = gid - firstgid;
-    const auto it = tsx.find(tile_id);
-    if (it == tsx.end()) return false;
-    if (it->second.type == "kill") return false;
-    return it->second.solid;
-}
-
-// ============================================================================
-// Parse TMJ map properties: chunk_role, difficulty, weight
-// ============================================================================
-
-// Find Nth occurrence of "key" in a "properties" array context.
-// This is a lightweight approach: search for property objects in the JSON.
-static void ParseMapProperties(const std::string& json, Chunk& chunk) {
-    // Default values
-    chunk.role = "any";
-    chunk.difficulty = 1;
-    chunk.weight = 1;
-
-    // Find the "properties" array
-    const size_t props_key = json.find("\"properties\"");
-    if (props_key == std::string::npos) return;
-    const size_t arr_open = json.find('[', props_key);
-    if (arr_open == std::string::npos) return;
-    const size_t arr_close = json.find(']', arr_open);
-    if (arr_close == std::string::npos) return;
-    const std::string props_block = json.substr(arr_open, arr_close - arr_open + 1);
-
-    // Parse each property object { "name":"...", "value":... }
-    size_t pos = 0;
-    while (true) {
-        const size_t name_key = props_block.find("\"name\"", pos);
-        if (name_key == std::string::npos) break;
-
-        // Get the property name
-        size_t p = name_key + 6;
-        while (p < props_block.size() && (props_block[p] == ' ' || props_block[p] == ':' || props_block[p] == '\t')) ++p;
-        if (p >= props_block.size() || props_block[p] != '"') { pos = name_key + 1; continue; }
-        ++p;
-        const size_t name_end = props_block.find('"', p);
-        if (name_end == std::string::npos) break;
-        const std::string prop_name = props_block.substr(p, name_end - p);
-
-        // Find the "value" for this property (search after the name)
-        const size_t val_key = props_block.find("\"value\"", name_end);
-        if (val_key == std::string::npos) { pos = name_end; continue; }
-        size_t v = val_key + 7;
-        while (v < props_block.size() && (props_block[v] == ' ' || props_block[v] == ':' || props_block[v] == '\t')) ++v;
-
-        if (prop_name == "chunk_role") {
-            if (v < props_block.size() && props_block[v] == '"') {
-                ++v;
-                const size_t ve = props_block.find('"', v);
-                if (ve != std::string::npos)
-                    chunk.role = props_block.substr(v, ve - v);
-            }
-        } else if (prop_name == "difficulty") {
-            try { chunk.difficulty = std::stoi(props_block.substr(v)); } catch (...) {}
-        } else if (prop_name == "weight") {
-            try { chunk.weight = std::stoi(props_block.substr(v)); } catch (...) {}
-        }
-
-        pos = val_key + 1;
-    }
-}
-
 // ============================================================================
 // ChunkStore implementation
 // ============================================================================
 
-bool ChunkStore::ParseChunk(const char* path, Chunk& out) {
-    std::string json;
-    if (!ReadFileStr(path, json)) return false;
-
-    int map_w = 0, map_h = 0;
-    if (!JGetInt(json, "width", map_w) || !JGetInt(json, "height", map_h) ||
-        map_w <= 0 || map_h <= 0) return false;
-
-    int firstgid = 1;
-    JGetInt(json, "firstgid", firstgid);
+// Same fields as ParseChunk, copied out of levels.pack.
+static void ChunkFromPacked(const PackedLevel& lvl, Chunk& out, ChunkTiles& tiles) {
+    out.width  = lvl.width;
+    out.height = lvl.height;
+    const size_t n = static_cast<size_t>(lvl.width) * lvl.height;
+    tiles.chars.assign(lvl.tiles, n);
+    tiles.solid.resize(n);
+    for (size_t i = 0; i < n; ++i) tiles.solid[i] = (lvl.solid_bits[i >> 3] >> (i & 7)) & 1;
+    out.entries.clear();
+    out.exits.clear();
+    for (int i = 0; i < lvl.entry_count; ++i) out.entries.push_back(lvl.Entry(i));
+    for (int i = 0; i < lvl.exit_count;  ++i) out.exits.push_back(lvl.Exit(i));
+    out.entry_tx = out.entries.empty() ? -1 : out.entries[0].first;
+    out.entry_ty = out.entries.empty() ? -1 : out.entries[0].second;
+    out.exit_tx  = out.exits.empty()   ? -1 : out.exits[0].first;
+    out.exit_ty  = out.exits.empty()   ? -1 : out.exits[0].second;
+    out.has_spawn      = (lvl.flags & PACK_HAS_SPAWN) != 0;
+    out.has_end        = (lvl.flags & PACK_HAS_END) != 0;
+    out.has_checkpoint = (lvl.flags & PACK_HAS_CHECKPOINT) != 0;
+    out.role.assign(lvl.role.data(), lvl.role.size());
+    out.difficulty = lvl.difficulty;
+    out.weight     = lvl.weight;
+    out.traversal      = lvl.traversal;
+    out.traversal_size = lvl.traversal_size;
+}
 
-    std::string tsx_src;
-    if (!JGetString(json, "source", tsx_src)) return false;
-    const std::string tsx_path = DirOfPath(std::string(path)) + "/" + tsx_src;
-    const auto tsx = ParseTsx(tsx_path);
+bool ChunkStore::ParseChunk(const char* path, Chunk& out, ChunkTiles& tiles) {
+    TiledMap map;
+    if (!LoadTiledMap(path, map)) return false;
+    const int map_w = map.width, map_h = map.height;
 
-    std::vector<int> data;
-    if (!ParseDataArray(json, data)) return false;
-    if (static_cast<int>(data.size()) < map_w * map_h) return false;
+    // Every chunk shares TileSet.tsx: parsed once, reused until the file changes.
+    static const TiledTileset no_tiles;
+    const auto cached = LoadTiledTilesetCached(TiledResolvePath(path, map.tileset_source));
+    const TiledTileset& tsx = cached ? *cached : no_tiles;
 
     // Build the chunk grids
     out.width  = map_w;
     out.height = map_h;
-    out.rows.resize(map_h);
-    out.solid_grid.resize(map_h);
+    tiles.chars.resize(static_cast<size_t>(map_w) * map_h);
+    tiles.solid.resize(static_cast<size_t>(map_w) * map_h);
+    out.entries.clear();
+    out.exits.clear();
     out.entry_tx = out.entry_ty = -1;
     out.exit_tx  = out.exit_ty  = -1;
     out.has_spawn = false;
     out.has_end   = false;
 
     for (int y = 0; y < map_h; ++y) {
-        out.rows[y].resize(map_w);
-        out.solid_grid[y].resize(map_w);
         for (int x = 0; x < map_w; ++x) {
-            const int gid = data[y * map_w + x];
-            const char ch = TileToChar(gid, firstgid, tsx);
-            out.rows[y][x]       = ch;
-            out.solid_grid[y][x] = TileToSolid(gid, firstgid, tsx);
+            const size_t i = static_cast<size_t>(y) * map_w + x;
+            const TiledTile t = tsx.Lookup(map.gids[i], map.firstgid);
+            const char ch = t.ch;
+            tiles.chars[i] = ch;
+            tiles.solid[i] = t.solid ? 1 : 0;
 
             if (ch == 'I') {
                 out.entries.push_back({x, y});
@@ -348,53 +149,54 @@ bool ChunkStore::ParseChunk(const char* path, Chunk& out) {
         }
     }
 
-    // Parse map custom properties
-    ParseMapProperties(json, out);
+    // Map custom properties: chunk_role, difficulty, weight
+    const std::string* role = map.Property("chunk_role");
+    out.role       = role ? *role : std::string("any");
+    out.difficulty = map.PropertyInt("difficulty", 1);
+    out.weight     = map.PropertyInt("weight", 1);
 
     return true;
 }
 
-void ChunkStore::Classify(Chunk chunk) {
+void ChunkStore::Classify(const Chunk& chunk) {
     const bool has_entry = (chunk.entry_tx >= 0);
     const bool has_exit  = (chunk.exit_tx  >= 0);
 
     // Helper: also populate checkpoint/normal mid sub-pools.
     auto add_to_mid = [this](const Chunk& c) {
         if (c.has_checkpoint)
-            mid_checkpoint_.push_back(c);
+            mid_checkpoint_.Add(c.id);
         else
-            mid_normal_.push_back(c);
+            mid_normal_.Add(c.id);
+        mid_.Add(c.id);
     };
 
     if (chunk.role == "start") {
-        start_.push_back(std::move(chunk));
+        start_.Add(chunk.id);
     } else if (chunk.role == "end") {
-        end_.push_back(std::move(chunk));
+        end_.Add(chunk.id);
     } else if (chunk.role == "mid") {
         add_to_mid(chunk);
-        mid_.push_back(std::move(chunk));
     } else {
         // role == "any": auto-classify based on tile content
         // A chunk may be added to multiple pools.
         bool classified = false;
         if (chunk.has_spawn && has_exit) {
-            start_.push_back(chunk);
+            start_.Add(chunk.id);
             classified = true;
         }
         if (chunk.has_end && has_entry) {
-            end_.push_back(chunk);
+            end_.Add(chunk.id);
             classified = true;
         }
         if (has_entry && has_exit && !chunk.has_spawn && !chunk.has_end) {
             add_to_mid(chunk);
-            mid_.push_back(chunk);
             classified = true;
         }
         if (!classified) {
             // Fallback: if it has both entry and exit, use as mid
             if (has_entry && has_exit) {
                 add_to_mid(chunk);
-                mid_.push_back(std::move(chunk));
             } else {
                 printf("[ChunkStore] WARNING: chunk with role='any' couldn't be classified, skipped\n");
             }
@@ -402,44 +204,189 @@ void ChunkStore::Classify(Chunk chunk) {
     }
 }
 
-bool ChunkStore::LoadFromDirectory(const char* dir) {
-    start_.clear();
-    mid_.clear();
-    end_.clear();
-    fork_start_.clear();
-    fork_end_.clear();
-    mid_checkpoint_.clear();
-    mid_normal_.clear();
+// ============================================================================
+// Weighted pools
+// ============================================================================
 
-    const auto files = ListTmjFiles(dir);
+void WeightedPositions::Add(int position, int weight) {
+    pos.push_back(position);
+    cum.push_back(Total() + std::max(1, weight));
+}
+
+int WeightedPositions::At(int roll) const {
+    const auto it = std::upper_bound(cum.begin(), cum.end(), roll);
+    return it == cum.end() ? pos.back() : pos[it - cum.begin()];
+}
+
+void ChunkPool::Finish(const Chunk* chunks) {
+    chunks_ = chunks;
+    all_    = {};
+    for (size_t i = 0; i < ids_.size(); ++i)
+        all_.Add(static_cast<int>(i), chunks_[ids_[i]].weight);
+
+    // Bands are keyed by distinct difficulties: [lo, hi] reduces to the first and last
+    // difficulty present inside it, so one table per pair (lo <= hi) covers every query.
+    difficulties_.clear();
+    for (int id : ids_) difficulties_.push_back(chunks_[id].difficulty);
+    std::sort(difficulties_.begin(), difficulties_.end());
+    difficulties_.erase(std::unique(difficulties_.begin(), difficulties_.end()),
+                        difficulties_.end());
+    const size_t n = difficulties_.size();
+    bands_.assign(n * n, {});
+    for (size_t lo = 0; lo < n; ++lo)
+        for (size_t hi = lo; hi < n; ++hi) {
+            WeightedPositions& band = bands_[lo * n + hi];
+            for (size_t i = 0; i < ids_.size(); ++i) {
+                const Chunk& c = chunks_[ids_[i]];
+                if (c.difficulty >= difficulties_[lo] && c.difficulty <= difficulties_[hi])
+                    band.Add(static_cast<int>(i), c.weight);
+            }
+        }
+}
+
+const WeightedPositions* ChunkPool::Band(int lo, int hi) const {
+    const auto first = std::lower_bound(difficulties_.begin(), difficulties_.end(), lo);
+    const auto last  = std::upper_bound(difficulties_.begin(), difficulties_.end(), hi);
+    if (first >= last) return nullptr;
+    const size_t n = difficulties_.size();
+    return &bands_[static_cast<size_t>(first - difficulties_.begin()) * n +
+                   static_cast<size_t>(last - difficulties_.begin() - 1)];
+}
+
+// FNV-1a 64 bit: byte-oriented, so the hash is the same on every platform.
+static void HashBytes(uint64_t& h, const void* data, size_t size) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        h ^= p[i];
+        h *= 0x100000001B3ull;
+    }
+}
+
+static void HashInt(uint64_t& h, int v) {
+    const uint8_t b[4] = {
+        static_cast<uint8_t>(v), static_cast<uint8_t>(v >> 8),
+        static_cast<uint8_t>(v >> 16), static_cast<uint8_t>(v >> 24) };
+    HashBytes(h, b, sizeof(b));
+}
+
+bool ChunkStore::LoadFromDirectory(const char* dir, bool use_pack) {
+    all_.clear();
+    arena_.clear();
+    content_hash_ = 0;
+    start_          = {};
+    mid_            = {};
+    end_            = {};
+    fork_start_     = {};
+    fork_end_       = {};
+    mid_checkpoint_ = {};
+    mid_normal_     = {};
+
+    // Sorted so chunk ids (and LevelRecipe placements) do not depend on directory order.
+    auto files = ListTmjFiles(dir);
+    std::sort(files.begin(), files.end());
     printf("[ChunkStore] scanning '%s': found %zu .tmj files\n", dir, files.size());
 
-    for (const auto& path : files) {
-        Chunk chunk;
-        if (ParseChunk(path.c_str(), chunk)) {
+    // --- Load: one independent job per file, fanned out across cores ---
+    // Chunks baked in levels.pack are copied from the mapping; anything the pack does not
+    // hold (new file, no pack, stale pack) is parsed from its .tmj.
+    const LevelPack* pack = use_pack ? LevelPack::Shared() : nullptr;
+    std::vector<Chunk>      loaded(files.size());
+    std::vector<ChunkTiles> loaded_tiles(files.size());
+    std::vector<uint8_t>    ok(files.size(), 0);
+    std::vector<uint8_t> from_pack(files.size(), 0);
+    size_t to_parse = 0;
+    {
+        PackedLevel lvl;
+        for (size_t i = 0; i < files.size(); ++i)
+            if (pack && pack->Find(files[i], lvl)) from_pack[i] = 1;
+            else ++to_parse;
+    }
+
+    // Threads only pay off with several .tmj per worker; pack copies are cheap.
+    static constexpr size_t PARSES_PER_THREAD = 8;
+    const size_t workers = std::min(ThreadPool::DefaultWorkers(), to_parse / PARSES_PER_THREAD);
+    ThreadPool pool(workers);
+    pool.ParallelFor(files.size(), [&](size_t i) {
+        PackedLevel lvl;
+        if (from_pack[i] && pack->Find(files[i], lvl)) {
+            ChunkFromPacked(lvl, loaded[i], loaded_tiles[i]);
+            ok[i] = 1;
+        } else {
+            ok[i] = ParseChunk(files[i].c_str(), loaded[i], loaded_tiles[i]) ? 1 : 0;
+        }
+    });
+
+    // --- Arena: every grid back to back, sized once so the chunk views never move ---
+    size_t arena_size = 0;
+    for (size_t i = 0; i < files.size(); ++i)
+        if (ok[i]) arena_size += 2 * loaded_tiles[i].chars.size();
+    arena_.resize(arena_size);
+    all_.reserve(files.size());
+
+    // --- Merge: file order, single thread → same ids, hash, pools and log as a serial load ---
+    uint64_t hash = 0xCBF29CE484222325ull;
+    size_t   arena_used = 0;
+    for (size_t i = 0; i < files.size(); ++i) {
+        const std::string& path = files[i];
+        Chunk& chunk = loaded[i];
+        if (ok[i]) {
+            const ChunkTiles& t = loaded_tiles[i];
+            char* dst = arena_.data() + arena_used;
+            std::memcpy(dst, t.chars.data(), t.chars.size());
+            std::memcpy(dst + t.chars.size(), t.solid.data(), t.solid.size());
+            arena_used += 2 * t.chars.size();
+            chunk.tiles = dst;
+            chunk.solid = reinterpret_cast<const uint8_t*>(dst + t.chars.size());
+            for (int y = 0; y < chunk.height; ++y)
+                for (int x = 0; x < chunk.width; ++x) {
+                    if (chunk.Tile(x, y) == ' ') continue;
+                    if (!chunk.HasContent()) {
+                        chunk.content_min_x = chunk.content_max_x = x;
+                        chunk.content_min_y = chunk.content_max_y = y;
+                    }
+                    chunk.content_min_x = std::min(chunk.content_min_x, x);
+                    chunk.content_max_x = std::max(chunk.content_max_x, x);
+                    chunk.content_max_y = y;
+                }
+
+            chunk.id = static_cast<int>(all_.size());
+            HashInt(hash, chunk.id);
+            HashInt(hash, chunk.width);
+            HashInt(hash, chunk.height);
+            for (int y = 0; y < chunk.height; ++y) {
+                const size_t row = static_cast<size_t>(y) * chunk.width;
+                HashBytes(hash, chunk.tiles + row, chunk.width);
+                HashBytes(hash, chunk.solid + row, chunk.width);   // one 0/1 byte per tile
+            }
+            all_.push_back(std::move(chunk));
+            const Chunk& stored = all_.back();
             printf("[ChunkStore]   loaded '%s' (%dx%d) role='%s' entry=(%d,%d) exit=(%d,%d)"
                    " entries=%d exits=%d checkpoint=%s\n",
-                   path.c_str(), chunk.width, chunk.height,
-                   chunk.role.c_str(),
-                   chunk.entry_tx, chunk.entry_ty,
-                   chunk.exit_tx, chunk.exit_ty,
-                   static_cast<int>(chunk.entries.size()),
-                   static_cast<int>(chunk.exits.size()),
-                   chunk.has_checkpoint ? "yes" : "no");
-            Classify(std::move(chunk));
+                   path.c_str(), stored.width, stored.height,
+                   stored.role.c_str(),
+                   stored.entry_tx, stored.entry_ty,
+                   stored.exit_tx, stored.exit_ty,
+                   static_cast<int>(stored.entries.size()),
+                   static_cast<int>(stored.exits.size()),
+                   stored.has_checkpoint ? "yes" : "no");
+            Classify(stored);
         } else {
             printf("[ChunkStore]   FAILED to parse '%s'\n", path.c_str());
         }
     }
 
+    content_hash_ = all_.empty() ? 0 : hash;
+    printf("[ChunkStore] %zu of %zu chunks from levels.pack, %zu parsed on %zu thread(s)\n",
+           files.size() - to_parse, files.size(), to_parse, pool.ThreadCount());
     printf("[ChunkStore] pools: %zu start, %zu mid (%zu checkpoint, %zu normal), %zu end\n",
            start_.size(), mid_.size(), mid_checkpoint_.size(), mid_normal_.size(), end_.size());
 
     // Compute min/max difficulty among mid chunks.
     if (!mid_.empty()) {
-        min_mid_diff_ = mid_[0].difficulty;
-        max_mid_diff_ = mid_[0].difficulty;
-        for (const auto& c : mid_) {
+        min_mid_diff_ = all_[mid_.ids_[0]].difficulty;
+        max_mid_diff_ = all_[mid_.ids_[0]].difficulty;
+        for (int id : mid_.ids_) {
+            const Chunk& c = all_[id];
             if (c.difficulty < min_mid_diff_) min_mid_diff_ = c.difficulty;
             if (c.difficulty > max_mid_diff_) max_mid_diff_ = c.difficulty;
         }
@@ -450,22 +397,28 @@ bool ChunkStore::LoadFromDirectory(const char* dir) {
     // Detect fork chunks (multi-exit / multi-entry) across all pools.
     DetectForkChunks();
 
+    // Weight sums and difficulty bands, once: picks are then binary searches.
+    for (ChunkPool* p : { &start_, &mid_, &end_, &fork_start_, &fork_end_,
+                          &mid_checkpoint_, &mid_normal_ })
+        p->Finish(all_.data());
+
     return IsReady();
 }
 
 void ChunkStore::DetectForkChunks() {
-    fork_start_.clear();
-    fork_end_.clear();
+    fork_start_ = {};
+    fork_end_   = {};
 
     // Scan all loaded chunks for multi-exit (fork start) and multi-entry (fork end).
     // A chunk with >1 exits can serve as a fork start point.
     // A chunk with >1 entries can serve as a fork merge point.
-    auto scan_pool = [this](const std::vector<Chunk>& pool) {
-        for (const auto& chunk : pool) {
+    auto scan_pool = [this](const ChunkPool& pool) {
+        for (int id : pool.ids_) {
+            const Chunk& chunk = all_[id];
             if (chunk.exits.size() > 1)
-                fork_start_.push_back(chunk);
+                fork_start_.Add(id);
             if (chunk.entries.size() > 1)
-                fork_end_.push_back(chunk);
+                fork_end_.Add(id);
         }
     };
 
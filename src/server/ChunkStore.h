@@ -1,20 +1,38 @@
 #pragma once
 // SRP: loads and classifies all chunk TMJ files from a directory at startup.
-// Stores parsed chunks (char grids + metadata) in memory for use by LevelGenerator.
+// Stores parsed chunks in memory for use by LevelGenerator: tile data lives once in a
+// contiguous arena, pools are id lists with precomputed weight sums.
 // No ENet or Raylib dependency.
 
 #include "World.h"
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <utility>
 
 // One chunk loaded in memory, parsed from a .tmj file.
 struct Chunk {
+    int id     = -1;  // stable index in load order (sorted file paths); see ChunkById
     int width  = 0;
     int height = 0;
 
-    std::vector<std::string>       rows;       // char grid ('0','E','K','X','C','I','O',' ')
-    std::vector<std::vector<bool>> solid_grid; // parallel solid-flag grid
+    // Row-major width*height views into the ChunkStore arena (valid while the store lives).
+    const char*    tiles = nullptr;  // char grid ('0','E','K','X','C','I','O',' ')
+    const uint8_t* solid = nullptr;  // parallel solid flags (0/1)
+
+    char Tile(int x, int y)    const { return tiles[static_cast<size_t>(y) * width + x]; }
+    bool IsSolid(int x, int y) const { return solid[static_cast<size_t>(y) * width + x] != 0; }
+
+    // Traversal summary baked into levels.pack (LevelValidator::SummarizeChunk), pointing
+    // into the mapping. nullptr when the chunk was parsed from its .tmj: the validator then
+    // simulates every action in it.
+    const uint8_t* traversal      = nullptr;
+    size_t         traversal_size = 0;
+
+    // Bounding box of the non-air tiles (empty when max < min): what a blit can touch.
+    int content_min_x = 0, content_min_y = 0;
+    int content_max_x = -1, content_max_y = -1;
+    bool HasContent() const { return content_min_x <= content_max_x; }
 
     // Primary entry / exit tile positions (-1 if absent).
     // These are the first 'I' and 'O' tiles found during scanning
@@ -44,51 +62,119 @@ struct Chunk {
     int  EntryCount()  const { return static_cast<int>(entries.size()); }
 };
 
+// Tile data of a chunk being parsed, before it is copied into the arena.
+struct ChunkTiles {
+    std::string          chars;   // width*height, row-major
+    std::vector<uint8_t> solid;   // width*height, 0/1
+};
+
+// Positions in a ChunkPool with running weight totals (max(1, weight) each).
+// At(roll) returns the position a scan subtracting weights in order would stop at,
+// with one binary search; roll must be in [0, Total()).
+struct WeightedPositions {
+    std::vector<int> pos;
+    std::vector<int> cum;   // cum[i] = weights of pos[0..i]
+
+    int Total() const { return cum.empty() ? 0 : cum.back(); }
+    int At(int roll) const;
+    void Add(int position, int weight);
+};
+
+// One pool: ids of chunks in the store's arena, in load order (duplicates allowed),
+// with weighted lookups over the whole pool and over every difficulty band.
+class ChunkPool {
+public:
+    size_t size()  const { return ids_.size(); }
+    bool   empty() const { return ids_.empty(); }
+    const Chunk& operator[](size_t i) const { return chunks_[ids_[i]]; }
+
+    const WeightedPositions& All() const { return all_; }
+    // Positions whose difficulty lies in [lo, hi], pool order. nullptr if none match.
+    const WeightedPositions* Band(int lo, int hi) const;
+
+private:
+    friend class ChunkStore;
+    void Add(int id) { ids_.push_back(id); }
+    void Finish(const Chunk* chunks);   // weight sums + one table per band of difficulties
+
+    const Chunk*                   chunks_ = nullptr;   // ChunkStore::all_.data()
+    std::vector<int>               ids_;
+    WeightedPositions              all_;
+    std::vector<int>               difficulties_;       // distinct, ascending
+    std::vector<WeightedPositions> bands_;              // [lo_i * count + hi_i], lo_i <= hi_i
+};
+
+// Every .tmj under `dir`, recursively, as "dir/sub/name.tmj" (unsorted).
+std::vector<std::string> ListTmjFiles(const std::string& dir);
+
 // Loads all .tmj chunk files from a directory and classifies them into
 // start, mid, end, fork_start, and fork_end pools.
 class ChunkStore {
 public:
+    // Pools and chunks point into the arena: movable, not copyable.
+    ChunkStore() = default;
+    ChunkStore(ChunkStore&&) = default;
+    ChunkStore& operator=(ChunkStore&&) = default;
+    ChunkStore(const ChunkStore&)            = delete;
+    ChunkStore& operator=(const ChunkStore&) = delete;
+
     // Scan `dir` for .tmj files, parse each into a Chunk, classify into pools.
     // Returns true if at least one start, one mid, and one end chunk were found.
-    bool LoadFromDirectory(const char* dir);
+    // use_pack = false ignores levels.pack (hot reload: the pack predates the edit).
+    bool LoadFromDirectory(const char* dir, bool use_pack = true);
 
-    const std::vector<Chunk>& StartChunks()     const { return start_; }
-    const std::vector<Chunk>& MidChunks()       const { return mid_; }
-    const std::vector<Chunk>& EndChunks()       const { return end_; }
-    const std::vector<Chunk>& ForkStartChunks() const { return fork_start_; }
-    const std::vector<Chunk>& ForkEndChunks()   const { return fork_end_; }
+    const ChunkPool& StartChunks()     const { return start_; }
+    const ChunkPool& MidChunks()       const { return mid_; }
+    const ChunkPool& EndChunks()       const { return end_; }
+    const ChunkPool& ForkStartChunks() const { return fork_start_; }
+    const ChunkPool& ForkEndChunks()   const { return fork_end_; }
 
     // Min / max difficulty found among mid chunks (for difficulty curve mapping).
     int MinMidDifficulty() const { return min_mid_diff_; }
     int MaxMidDifficulty() const { return max_mid_diff_; }
 
     bool IsReady() const { return !start_.empty() && !mid_.empty() && !end_.empty(); }
+    size_t ChunkCount() const { return all_.size(); }
+
+    // Every parsed chunk by id. nullptr if id is out of range.
+    const Chunk* ChunkById(int id) const {
+        return (id >= 0 && id < static_cast<int>(all_.size())) ? &all_[id] : nullptr;
+    }
+    // FNV-1a over ids, sizes, tile chars and solid flags: equal hashes mean a LevelRecipe
+    // rebuilds the same grid on both ends. 0 when nothing is loaded.
+    uint64_t ContentHash() const { return content_hash_; }
 
     // True if fork chunks are available (both fork-start and fork-end).
     bool HasForkChunks() const { return !fork_start_.empty(); }
 
     // Mid-chunk sub-pools based on checkpoint content.
-    const std::vector<Chunk>& MidCheckpointChunks() const { return mid_checkpoint_; }
-    const std::vector<Chunk>& MidNormalChunks()      const { return mid_normal_; }
+    const ChunkPool& MidCheckpointChunks() const { return mid_checkpoint_; }
+    const ChunkPool& MidNormalChunks()      const { return mid_normal_; }
     bool HasMidCheckpointChunks() const { return !mid_checkpoint_.empty(); }
 
+    // Parse a single .tmj chunk file: metadata into `out`, grids into `tiles`
+    // (out.tiles / out.solid stay null). Returns false on failure.
+    // Public for the level pack baker, which stores the same fields per .tmj.
+    static bool ParseChunk(const char* path, Chunk& out, ChunkTiles& tiles);
+
 private:
-    // Parse a single .tmj chunk file. Returns false on failure.
-    bool ParseChunk(const char* path, Chunk& out);
 
     // Classify chunk into start/mid/end pools based on role + content.
-    void Classify(Chunk chunk);
+    void Classify(const Chunk& chunk);
 
     // After all chunks are loaded, scan for fork chunks (multi-exit / multi-entry).
     void DetectForkChunks();
 
-    std::vector<Chunk> start_;
-    std::vector<Chunk> mid_;
-    std::vector<Chunk> end_;
-    std::vector<Chunk> fork_start_;      // chunks with multiple exits (fork entry points)
-    std::vector<Chunk> fork_end_;        // chunks with multiple entries (fork merge points)
-    std::vector<Chunk> mid_checkpoint_;  // mid chunks that contain 'C' tiles
-    std::vector<Chunk> mid_normal_;      // mid chunks without 'C' tiles
+    std::vector<Chunk> all_;             // indexed by Chunk::id
+    std::vector<char>  arena_;           // tiles then solid flags of every chunk, in id order
+    uint64_t           content_hash_ = 0;
+    ChunkPool start_;
+    ChunkPool mid_;
+    ChunkPool end_;
+    ChunkPool fork_start_;      // chunks with multiple exits (fork entry points)
+    ChunkPool fork_end_;        // chunks with multiple entries (fork merge points)
+    ChunkPool mid_checkpoint_;  // mid chunks that contain 'C' tiles
+    ChunkPool mid_normal_;      // mid chunks without 'C' tiles
     int min_mid_diff_ = 1;
     int max_mid_diff_ = 1;
 };
@@ -22,81 +22,56 @@
 #include <cstdio>
 #include <cmath>
 #include <climits>
-#include <unordered_map>
+#include <cstring>
 
 // ============================================================================
-// Weighted random pick (from a pre-filtered list of indices)
+// Weighted random pick (ChunkPool running weight sums → one binary search)
 // ============================================================================
 
-static int PickWeighted(const std::vector<Chunk>& pool, std::mt19937& rng) {
+static int PickFrom(const WeightedPositions& w, std::mt19937& rng) {
+    std::uniform_int_distribution<int> dist(0, w.Total() - 1);
+    return w.At(dist(rng));
+}
+
+static int PickWeighted(const ChunkPool& pool, std::mt19937& rng) {
     if (pool.size() == 1) return 0;
-    int total_weight = 0;
-    for (const auto& c : pool) total_weight += std::max(1, c.weight);
-    std::uniform_int_distribution<int> dist(0, total_weight - 1);
-    int roll = dist(rng);
-    for (int i = 0; i < static_cast<int>(pool.size()); ++i) {
-        roll -= std::max(1, pool[i].weight);
-        if (roll < 0) return i;
-    }
-    return static_cast<int>(pool.size()) - 1;
+    return PickFrom(pool.All(), rng);
 }
 
 // Pick a random mid chunk whose difficulty is within [min_d, max_d].
 // Falls back to the full pool if no chunk matches the filter.
-static int PickMidByDifficulty(const std::vector<Chunk>& mids,
+static int PickMidByDifficulty(const ChunkPool& mids,
                                 int min_d, int max_d, std::mt19937& rng) {
-    // Build a filtered list of eligible indices
-    std::vector<int> eligible;
-    int total_weight = 0;
-    for (int i = 0; i < static_cast<int>(mids.size()); ++i) {
-        if (mids[i].difficulty >= min_d && mids[i].difficulty <= max_d) {
-            eligible.push_back(i);
-            total_weight += std::max(1, mids[i].weight);
-        }
-    }
-    // Fallback: if nothing matches, use the entire pool
-    if (eligible.empty()) return PickWeighted(mids, rng);
-
-    // Weighted pick from eligible
-    std::uniform_int_distribution<int> dist(0, total_weight - 1);
-    int roll = dist(rng);
-    for (int idx : eligible) {
-        roll -= std::max(1, mids[idx].weight);
-        if (roll < 0) return idx;
-    }
-    return eligible.back();
+    const WeightedPositions* band = mids.Band(min_d, max_d);
+    if (!band) return PickWeighted(mids, rng);
+    return PickFrom(*band, rng);
 }
 
 // ============================================================================
-// Sparse grid for compositing
+// Two-pass compositing
 // ============================================================================
-
-struct TileCell {
-    char ch    = ' ';
-    bool solid = false;
+// Pass 1 (the Build* functions) only decides where each chunk goes: BlitChunk records
+// the placement and grows the bounding box from the chunk's precomputed content box.
+// Pass 2 (FinalizeGrid) allocates the final grid once, in World's padded layout, copies
+// the chunks in placement order and hands the buffer to World.
+
+// Every blit in order: the placements are the level's LevelRecipe.
+struct ComposeGrid {
+    std::vector<ChunkPlacement> placements;
+    std::vector<const Chunk*>   chunks;       // parallel to placements
 };
 
-static int64_t GridKey(int x, int y) {
-    return (static_cast<int64_t>(y) << 32) | static_cast<uint32_t>(x);
-}
-
-// Blit a chunk's non-air tiles onto the sparse grid at the given offset.
-static void BlitChunk(std::unordered_map<int64_t, TileCell>& grid,
+// Queue a chunk's non-air tiles for the given offset.
+static void BlitChunk(ComposeGrid& grid,
                        const Chunk& chunk, int off_x, int off_y,
                        int& min_x, int& min_y, int& max_x, int& max_y) {
-    for (int cy = 0; cy < chunk.height; ++cy) {
-        for (int cx = 0; cx < chunk.width; ++cx) {
-            const char ch = chunk.rows[cy][cx];
-            if (ch == ' ') continue; // don't overwrite with air
-            const int wx = off_x + cx;
-            const int wy = off_y + cy;
-            grid[GridKey(wx, wy)] = { ch, chunk.solid_grid[cy][cx] };
-            min_x = std::min(min_x, wx);
-            min_y = std::min(min_y, wy);
-            max_x = std::max(max_x, wx);
-            max_y = std::max(max_y, wy);
-        }
-    }
+    grid.placements.push_back({ static_cast<uint16_t>(chunk.id), off_x, off_y });
+    grid.chunks.push_back(&chunk);
+    if (!chunk.HasContent()) return;
+    min_x = std::min(min_x, off_x + chunk.content_min_x);
+    min_y = std::min(min_y, off_y + chunk.content_min_y);
+    max_x = std::max(max_x, off_x + chunk.content_max_x);
+    max_y = std::max(max_y, off_y + chunk.content_max_y);
 }
 
 // ============================================================================
@@ -137,10 +112,10 @@ static BBox ComputeBranchBBox(const std::vector<const Chunk*>& chunks,
             off_y = prev_exit_wy + 1;
         }
 
-        for (int cy = 0; cy < c->height; ++cy)
-            for (int cx = 0; cx < c->width; ++cx)
-                if (c->rows[cy][cx] != ' ')
-                    bb.Expand(off_x + cx, off_y + cy);
+        if (c->HasContent()) {
+            bb.Expand(off_x + c->content_min_x, off_y + c->content_min_y);
+            bb.Expand(off_x + c->content_max_x, off_y + c->content_max_y);
+        }
 
         if (c->exit_tx >= 0) {
             prev_exit_wx = off_x + c->exit_tx;
@@ -155,7 +130,7 @@ static BBox ComputeBranchBBox(const std::vector<const Chunk*>& chunks,
 // Returns the last exit world position.
 // If out_entries is non-null, records each chunk's entry world position.
 static std::pair<int,int> PlaceLinearSequence(
-    std::unordered_map<int64_t, TileCell>& grid,
+    ComposeGrid& grid,
     const std::vector<const Chunk*>& chunks,
     int start_wx, int start_wy,
     int extra_off_x,
@@ -223,67 +198,41 @@ int LevelGenerator::MaxArrivals(float t) {
 // Pick a fork-start chunk with at most max_exits exits
 // ============================================================================
 
-static int PickForkStart(const std::vector<Chunk>& pool, int max_exits,
-                          std::mt19937& rng) {
-    std::vector<int> eligible;
-    int total_weight = 0;
-    for (int i = 0; i < static_cast<int>(pool.size()); ++i) {
-        if (pool[i].ExitCount() <= max_exits) {
-            eligible.push_back(i);
+// Weighted pick among the chunks of `pool` accepted by `fits`; -1 if none.
+// Fork pools are a handful of chunks: two passes over the pool, no lists.
+template <typename Fits>
+static int PickFiltered(const ChunkPool& pool, Fits fits, std::mt19937& rng) {
+    int total_weight = 0, last = -1;
+    for (size_t i = 0; i < pool.size(); ++i)
+        if (fits(pool[i])) {
             total_weight += std::max(1, pool[i].weight);
+            last = static_cast<int>(i);
         }
-    }
-    if (eligible.empty()) return -1;
+    if (last < 0) return -1;
 
     std::uniform_int_distribution<int> dist(0, total_weight - 1);
     int roll = dist(rng);
-    for (int idx : eligible) {
-        roll -= std::max(1, pool[idx].weight);
-        if (roll < 0) return idx;
+    for (size_t i = 0; i < pool.size(); ++i) {
+        if (!fits(pool[i])) continue;
+        roll -= std::max(1, pool[i].weight);
+        if (roll < 0) return static_cast<int>(i);
     }
-    return eligible.back();
+    return last;
+}
+
+static int PickForkStart(const ChunkPool& pool, int max_exits,
+                          std::mt19937& rng) {
+    return PickFiltered(pool, [&](const Chunk& c) { return c.ExitCount() <= max_exits; }, rng);
 }
 
 // Pick a fork-end chunk with exactly n_entries entries (or closest match)
-static int PickForkEnd(const std::vector<Chunk>& pool, int n_entries,
+static int PickForkEnd(const ChunkPool& pool, int n_entries,
                         std::mt19937& rng) {
     // Prefer exact match
-    std::vector<int> exact;
-    int exact_weight = 0;
-    for (int i = 0; i < static_cast<int>(pool.size()); ++i) {
-        if (pool[i].EntryCount() == n_entries) {
-            exact.push_back(i);
-            exact_weight += std::max(1, pool[i].weight);
-        }
-    }
-    if (!exact.empty()) {
-        std::uniform_int_distribution<int> dist(0, exact_weight - 1);
-        int roll = dist(rng);
-        for (int idx : exact) {
-            roll -= std::max(1, pool[idx].weight);
-            if (roll < 0) return idx;
-        }
-        return exact.back();
-    }
-
+    const int exact = PickFiltered(pool, [&](const Chunk& c) { return c.EntryCount() == n_entries; }, rng);
+    if (exact >= 0) return exact;
     // Fallback: any fork_end with >= n_entries
-    std::vector<int> fallback;
-    int fb_weight = 0;
-    for (int i = 0; i < static_cast<int>(pool.size()); ++i) {
-        if (pool[i].EntryCount() >= n_entries) {
-            fallback.push_back(i);
-            fb_weight += std::max(1, pool[i].weight);
-        }
-    }
-    if (fallback.empty()) return -1;
-
-    std::uniform_int_distribution<int> dist(0, fb_weight - 1);
-    int roll = dist(rng);
-    for (int idx : fallback) {
-        roll -= std::max(1, pool[idx].weight);
-        if (roll < 0) return idx;
-    }
-    return fallback.back();
+    return PickFiltered(pool, [&](const Chunk& c) { return c.EntryCount() >= n_entries; }, rng);
 }
 
 // ============================================================================
@@ -317,7 +266,7 @@ static const Chunk* PickMidChunk(const ChunkStore& store, int mid_num,
 // ============================================================================
 
 static void BuildAndPlaceLinear(
-    std::unordered_map<int64_t, TileCell>& grid,
+    ComposeGrid& grid,
     const ChunkStore& store, int start_idx, int end_idx,
     int mid_count, int band_lo, int band_hi,
     int checkpoint_interval,
@@ -366,7 +315,7 @@ static void BuildAndPlaceLinear(
 // ============================================================================
 
 static bool BuildAndPlaceBranching(
-    std::unordered_map<int64_t, TileCell>& grid,
+    ComposeGrid& grid,
     const ChunkStore& store, int start_idx, int end_idx,
     int mid_count, int band_lo, int band_hi,
     int max_paths, int max_arrivals,
@@ -558,56 +507,60 @@ static bool BuildAndPlaceBranching(
 // Finalize grid → World
 // ============================================================================
 
-static bool FinalizeGrid(std::unordered_map<int64_t, TileCell>& grid,
+// Final rectangular grid with 5-tile solid border + 5-tile margin
+static constexpr int GRID_BORDER = 5;
+static constexpr int GRID_MARGIN = 5;
+
+static bool FinalizeGrid(const ComposeGrid& grid,
                           int min_x, int min_y, int max_x, int max_y,
                           World& world) {
-    // Strip entry/exit marker tiles (I, O → air).
-    // 'C' tiles from checkpoint chunks are preserved.
-    for (auto& [key, cell] : grid) {
-        if (cell.ch == 'I' || cell.ch == 'O') {
-            cell.ch    = ' ';
-            cell.solid = false;
-        }
-    }
-
-    // Build the final rectangular grid with 5-tile solid border + 5-tile margin
-    const int border = 5;
-    const int margin = 5;
-    const int pad    = border + margin;
+    const int border = GRID_BORDER;
+    const int pad    = GRID_BORDER + GRID_MARGIN;
     const int content_w = max_x - min_x + 1;
     const int content_h = max_y - min_y + 1;
     const int final_w = content_w + 2 * pad;
     const int final_h = content_h + 2 * pad;
 
-    std::vector<std::string> rows(final_h);
+    // World's layout: one extra ring of air around the map (see World::Row).
+    const size_t stride = static_cast<size_t>(final_w) + 2;
+    std::vector<char> tiles(stride * (final_h + 2), ' ');
+    auto row = [&](int y) { return tiles.data() + (static_cast<size_t>(y) + 1) * stride + 1; };
+
     for (int y = 0; y < final_h; ++y) {
-        rows[y].resize(final_w, ' ');
-        for (int x = 0; x < final_w; ++x) {
-            if (x < border || x >= final_w - border ||
-                y < border || y >= final_h - border) {
-                rows[y][x] = '0';
-                continue;
-            }
-            if (x < pad || x >= final_w - pad ||
-                y < pad || y >= final_h - pad) {
-                continue;
+        char* r = row(y);
+        if (y < border || y >= final_h - border) {
+            std::memset(r, '0', final_w);
+        } else {
+            std::memset(r, '0', border);
+            std::memset(r + final_w - border, '0', border);
+        }
+    }
+
+    // Chunks in blit order: later non-air tiles win. Entry/exit markers (I, O) become
+    // air; 'C' tiles from checkpoint chunks are preserved.
+    for (size_t i = 0; i < grid.chunks.size(); ++i) {
+        const Chunk& c = *grid.chunks[i];
+        if (!c.HasContent()) continue;
+        const int base_x = grid.placements[i].x - min_x + pad;
+        const int base_y = grid.placements[i].y - min_y + pad;
+        for (int cy = c.content_min_y; cy <= c.content_max_y; ++cy) {
+            const char* src = c.tiles + static_cast<size_t>(cy) * c.width;
+            char*       dst = row(base_y + cy) + base_x;
+            for (int cx = c.content_min_x; cx <= c.content_max_x; ++cx) {
+                const char ch = src[cx];
+                if (ch == ' ') continue; // don't overwrite with air
+                dst[cx] = (ch == 'I' || ch == 'O') ? ' ' : ch;
             }
-            const int wx = min_x + (x - pad);
-            const int wy = min_y + (y - pad);
-            const auto it = grid.find(GridKey(wx, wy));
-            if (it != grid.end())
-                rows[y][x] = it->second.ch;
         }
     }
 
     // Kill strip at the very bottom (inside the border)
     for (int y = final_h - border - 1; y >= final_h - border - 2 && y >= border; --y)
-        for (int x = border; x < final_w - border; ++x)
-            rows[y][x] = 'K';
+        std::memset(row(y) + border, 'K', final_w - 2 * border);
 
     printf("[LevelGenerator] final map: %d x %d tiles\n", final_w, final_h);
 
-    return world.LoadFromGrid(final_w, final_h, rows);
+    return world.LoadFromPadded(final_w, final_h, std::move(tiles));
 }
 
 // ============================================================================
@@ -615,7 +568,7 @@ static bool FinalizeGrid(std::unordered_map<int64_t, TileCell>& grid,
 // ============================================================================
 
 bool LevelGenerator::Generate(const ChunkStore& store, const GeneratorParams& params,
-                               World& world) {
+                               World& world, LevelRecipe* recipe) {
     if (!store.IsReady()) {
         printf("[LevelGenerator] ERROR: ChunkStore not ready\n");
         return false;
@@ -658,7 +611,7 @@ bool LevelGenerator::Generate(const ChunkStore& store, const GeneratorParams& pa
     const int checkpoint_interval = (mid_count >= 8) ? 5 : 0;
 
     // --- Sparse grid ---
-    std::unordered_map<int64_t, TileCell> grid;
+    ComposeGrid grid;
     int min_x = INT_MAX, min_y = INT_MAX;
     int max_x = INT_MIN, max_y = INT_MIN;
 
@@ -672,7 +625,7 @@ bool LevelGenerator::Generate(const ChunkStore& store, const GeneratorParams& pa
             min_x, min_y, max_x, max_y);
         if (!ok) {
             printf("[LevelGenerator] branching failed, falling back to linear\n");
-            grid.clear();
+            grid = ComposeGrid{};
             min_x = INT_MAX; min_y = INT_MAX;
             max_x = INT_MIN; max_y = INT_MIN;
             BuildAndPlaceLinear(grid, store, start_idx, end_idx,
@@ -693,5 +646,59 @@ bool LevelGenerator::Generate(const ChunkStore& store, const GeneratorParams& pa
         printf("[LevelGenerator] checkpoint chunks interspersed every %d mids (pool=%zu)\n",
                checkpoint_interval, store.MidCheckpointChunks().size());
 
+    if (recipe) {
+        recipe->seed              = seed;
+        recipe->chunk_hash        = store.ContentHash();
+        recipe->strip_checkpoints = false;
+        recipe->placements        = grid.placements;
+    }
     return FinalizeGrid(grid, min_x, min_y, max_x, max_y, world);
 }
+
+// ============================================================================
+// LevelGenerator::Rebuild — replay the blits of a recipe (no RNG involved)
+// ============================================================================
+
+bool LevelGenerator::Rebuild(const ChunkStore& store, const LevelRecipe& recipe,
+                             World& world) {
+    if (recipe.chunk_hash != store.ContentHash() || recipe.placements.empty()) {
+        printf("[LevelGenerator] recipe rejected: chunk set %016llx, local %016llx\n",
+               static_cast<unsigned long long>(recipe.chunk_hash),
+               static_cast<unsigned long long>(store.ContentHash()));
+        return false;
+    }
+
+    ComposeGrid grid;
+    int min_x = INT_MAX, min_y = INT_MAX;
+    int max_x = INT_MIN, max_y = INT_MIN;
+    for (const ChunkPlacement& p : recipe.placements) {
+        const Chunk* c = store.ChunkById(p.chunk_id);
+        if (!c) return false;
+        BlitChunk(grid, *c, p.x, p.y, min_x, min_y, max_x, max_y);
+    }
+    if (min_x > max_x || min_y > max_y) return false;   // only air
+
+    if (!FinalizeGrid(grid, min_x, min_y, max_x, max_y, world)) return false;
+    if (recipe.strip_checkpoints) world.StripCheckpoints();
+    return true;
+}
+
+// ============================================================================
+// LevelGenerator::PlacementOrigin — where FinalizeGrid puts composition (0, 0)
+// ============================================================================
+
+bool LevelGenerator::PlacementOrigin(const ChunkStore& store,
+                                     const std::vector<ChunkPlacement>& placements,
+                                     int& dx, int& dy) {
+    int min_x = INT_MAX, min_y = INT_MAX;
+    for (const ChunkPlacement& p : placements) {
+        const Chunk* c = store.ChunkById(p.chunk_id);
+        if (!c || !c->HasContent()) continue;
+        min_x = std::min(min_x, p.x + c->content_min_x);
+        min_y = std::min(min_y, p.y + c->content_min_y);
+    }
+    if (min_x == INT_MAX) return false;
+    dx = GRID_BORDER + GRID_MARGIN - min_x;
+    dy = GRID_BORDER + GRID_MARGIN - min_y;
+    return true;
+}
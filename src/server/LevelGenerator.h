@@ -7,6 +7,7 @@
 // No ENet or Raylib dependency.
 
 #include "ChunkStore.h"
+#include "LevelRecipe.h"
 #include "World.h"
 #include "Protocol.h"
 #include <cstdint>
@@ -22,8 +23,20 @@ struct GeneratorParams {
 class LevelGenerator {
 public:
     // Generate a level from the chunks in `store` and load it into `world`.
+    // When recipe is non-null it receives the chunk placements of the result.
     // Returns true on success.
-    static bool Generate(const ChunkStore& store, const GeneratorParams& params, World& world);
+    static bool Generate(const ChunkStore& store, const GeneratorParams& params, World& world,
+                         LevelRecipe* recipe = nullptr);
+
+    // Rebuild the level described by recipe (client side). Fails when the recipe was
+    // made from a different chunk set (ContentHash) or names an unknown chunk id.
+    static bool Rebuild(const ChunkStore& store, const LevelRecipe& recipe, World& world);
+
+    // Translation from placement (composition) coordinates to tiles of the World that
+    // Generate / Rebuild make from these placements. false if none has content.
+    static bool PlacementOrigin(const ChunkStore& store,
+                                const std::vector<ChunkPlacement>& placements,
+                                int& dx, int& dy);
 
 private:
     // Choose how many mid chunks based on level progression.
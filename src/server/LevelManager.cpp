@@ -1,16 +1,24 @@
 // LevelManager.cpp — implementazione di caricamento livello e spawn.
 
 #include "LevelManager.h"
+#include "LevelPack.h"      // LoadWorldFile: levels.pack, poi .tmj
 #include "LevelValidator.h"
 #include "Protocol.h"     // MAX_GENERATED_LEVELS
 #include "SpawnFinder.h"  // FindCenterSpawn (src/common)
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdio>
 #include <random>
+#include <utility>
+#include <vector>
 
 bool LevelManager::Load(const char* path) {
     World tmp;
-    if (!tmp.LoadFromFile(path)) return false;
-    world_ = tmp;
+    if (!LoadWorldFile(tmp, path)) return false;
+    world_      = tmp;
+    has_recipe_ = false;
 
     const SpawnPos sp = FindCenterSpawn(world_);
     spawn_x_ = sp.x;
@@ -18,61 +26,186 @@ bool LevelManager::Load(const char* path) {
     return true;
 }
 
+void LevelManager::StripCheckpoints() {
+    world_.StripCheckpoints();
+    recipe_.strip_checkpoints = true;
+}
+
+// ---------------------------------------------------------------------------
+// Generate — tentativi speculativi in parallelo
+// ---------------------------------------------------------------------------
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int MAX_RETRIES = 10;
+// Attempts in flight at once: the caller plus up to 3 workers. Several rooms may be
+// generating at the same time, so speculation does not take every core: the rest go to
+// the BFS frontier (see FrontierPool).
+constexpr size_t MAX_PARALLEL_ATTEMPTS = 4;
+// Work one attempt's validation may do, in simulated ticks (~0.2 s of CPU). A validation
+// that spends it is UNDECIDED and the attempt loses like an invalid one. The budget is
+// counted, not timed, so which attempts lose follows from the seed alone. Validations
+// seen so far need at most ~300k ticks (median ~5k).
+constexpr int64_t ATTEMPT_TICK_BUDGET = 1000000;
+// Safety cut-off on wall-clock time, counted from each attempt's own start. Only a
+// machine stalled far beyond the tick budget hits it, and then the winner may depend on
+// timing.
+constexpr int ATTEMPT_DEADLINE_MS = 2000;
+
+// Generation threads shared by every room of the process (and the local server), created
+// on first use. One Generate at a time gets the attempt workers and one BFS layer at a
+// time the frontier workers; concurrent callers run on their own thread (ThreadPool::
+// ParallelFor). Attempt and frontier workers together fill the machine once.
+ThreadPool& AttemptPool() {
+    static ThreadPool pool(std::min(ThreadPool::DefaultWorkers(), MAX_PARALLEL_ATTEMPTS - 1));
+    return pool;
+}
+
+ThreadPool& FrontierPool() {
+    static ThreadPool pool(ThreadPool::DefaultWorkers() - (AttemptPool().ThreadCount() - 1));
+    return pool;
+}
+
+double MsSince(Clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+// Seed of attempt i: the base seed first, then splitmix64 steps, so the whole sequence
+// (and therefore the winner, unless an attempt hits ATTEMPT_DEADLINE_MS) follows from the
+// base seed alone.
+uint32_t AttemptSeed(uint32_t base, int attempt) {
+    if (attempt == 0) return base;
+    uint64_t z = base + 0x9E3779B97F4A7C15ull * static_cast<uint64_t>(attempt);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+    const auto s = static_cast<uint32_t>(z);
+    return s ? s : 1u;   // 0 means "random" to LevelGenerator
+}
+
+struct Attempt {
+    enum State : uint8_t { SKIPPED, FAILED, INVALID, UNDECIDED, VALID, CANCELLED };
+
+    World             world;
+    LevelRecipe       recipe;
+    State             state = SKIPPED;
+    double            ms    = 0.0;
+    std::atomic<bool> cancel{false};
+};
+
+} // namespace
+
 bool LevelManager::Generate(int level_num, const ChunkStore& store, uint32_t seed,
                             bool validate, int total_levels) {
-    static constexpr int MAX_RETRIES = 10;
+    const auto t0 = Clock::now();
 
     GeneratorParams params;
     params.level_num    = level_num;
     params.total_levels = std::max(1, total_levels);
     params.seed         = seed;
+    while (params.seed == 0) params.seed = static_cast<uint32_t>(std::random_device{}());
+
+    // Indices are handed out in order, so attempt i starts no later than attempt i+1.
+    // An attempt may only win if every lower one ran to completion and failed: the
+    // result is the one a serial loop over the same seeds would return.
+    std::vector<Attempt> attempts(MAX_RETRIES);
+    std::atomic<int>     winner{MAX_RETRIES};
+
+    auto run = [&](size_t idx) {
+        const int i = static_cast<int>(idx);
+        Attempt&  a = attempts[idx];
+        if (winner.load() < i) return;   // skipped
 
-    World last_good;   // keep last generated in case all validations fail
-    bool  any_generated = false;
-
-    for (int attempt = 0; attempt < MAX_RETRIES; ++attempt) {
-        // After the first attempt, randomise the seed.
-        if (attempt > 0)
-            params.seed = static_cast<uint32_t>(std::random_device{}());
-
-        World tmp;
-        if (!LevelGenerator::Generate(store, params, tmp))
-            continue;
-
-        any_generated = true;
-        last_good = tmp;
-
-        if (!validate || LevelValidator::Validate(tmp)) {
-            world_ = tmp;
-            const SpawnPos sp = FindCenterSpawn(world_);
-            spawn_x_ = sp.x;
-            spawn_y_ = sp.y;
-            printf("[LevelManager] generated level %d  (attempt %d/%d)  spawn=(%.0f, %.0f)  size=%dx%d%s\n",
-                   level_num, attempt + 1, MAX_RETRIES, spawn_x_, spawn_y_,
-                   world_.GetWidth(), world_.GetHeight(),
-                   validate ? "" : "  [validation skipped]");
-            return true;
+        const auto     ta = Clock::now();
+        GeneratorParams p = params;
+        p.seed            = AttemptSeed(params.seed, i);
+        if (!LevelGenerator::Generate(store, p, a.world, &a.recipe)) {
+            a.state = Attempt::FAILED;
+            a.ms    = MsSince(ta);
+            return;
         }
-        printf("[LevelManager] level %d FAILED validation (attempt %d/%d)\n",
-               level_num, attempt + 1, MAX_RETRIES);
-    }
+        LevelValidator::Result result = LevelValidator::Result::VALID;
+        if (validate) {
+            LevelValidator::Options opts;
+            opts.store     = &store;
+            opts.recipe    = &a.recipe;
+            opts.cancel    = &a.cancel;
+            opts.deadline  = ta + std::chrono::milliseconds(ATTEMPT_DEADLINE_MS);
+            opts.max_ticks = ATTEMPT_TICK_BUDGET;
+            opts.pool      = &FrontierPool();
+            result         = LevelValidator::Validate(a.world, opts);
+        }
+        if (result == LevelValidator::Result::VALID) {
+            a.state = Attempt::VALID;
+            int w = winner.load();
+            while (i < w && !winner.compare_exchange_weak(w, i)) {}
+            for (int j = i + 1; j < MAX_RETRIES; ++j) attempts[j].cancel.store(true);
+        } else if (result == LevelValidator::Result::INVALID) {
+            a.state = Attempt::INVALID;
+        } else {
+            a.state = a.cancel.load() ? Attempt::CANCELLED : Attempt::UNDECIDED;
+        }
+        a.ms = MsSince(ta);
+    };
 
-    // If validation is disabled, keep the previous permissive fallback.
-    if (!validate && any_generated) {
-        printf("[LevelManager] WARNING: all %d attempts failed validation for level %d — using last\n",
-               MAX_RETRIES, level_num);
-        world_ = last_good;
-        const SpawnPos sp = FindCenterSpawn(world_);
-        spawn_x_ = sp.x;
-        spawn_y_ = sp.y;
-        return true;
+    // Without validation the first attempt practically always succeeds: nothing to race.
+    size_t threads = 1;
+    if (validate) threads = AttemptPool().ParallelFor(MAX_RETRIES, run);
+    else for (size_t i = 0; i < MAX_RETRIES; ++i) run(i);
+
+    stats_         = GenerateStats{};
+    stats_.threads = threads;
+    stats_.winner  = winner.load() < MAX_RETRIES ? winner.load() : -1;
+    for (int i = 0; i < MAX_RETRIES; ++i) {
+        const Attempt& a = attempts[i];
+        switch (a.state) {
+            case Attempt::SKIPPED:   stats_.skipped++;   continue;
+            case Attempt::CANCELLED: stats_.cancelled++; break;
+            case Attempt::UNDECIDED: stats_.undecided++; break;
+            case Attempt::FAILED:
+            case Attempt::INVALID:   stats_.invalid++;   break;
+            case Attempt::VALID:                         break;
+        }
+        stats_.launched++;
+        stats_.busy_ms += a.ms;
+        if (stats_.winner >= 0 && i > stats_.winner) continue;
+        if (a.state == Attempt::INVALID)
+            printf("[LevelManager] level %d FAILED validation (attempt %d/%d)\n",
+                   level_num, i + 1, MAX_RETRIES);
+        else if (a.state == Attempt::UNDECIDED)
+            printf("[LevelManager] level %d UNDECIDED within %lld ticks / %d ms (attempt %d/%d)\n",
+                   level_num, static_cast<long long>(ATTEMPT_TICK_BUDGET), ATTEMPT_DEADLINE_MS,
+                   i + 1, MAX_RETRIES);
     }
+    stats_.wall_ms = MsSince(t0);
 
-    if (validate && any_generated) {
-        printf("[LevelManager] level %d discarded: no solvable variant found in %d attempts\n",
-               level_num, MAX_RETRIES);
+    if (stats_.winner < 0) {
+        if (validate && stats_.invalid + stats_.undecided > 0)
+            printf("[LevelManager] level %d discarded: no solvable variant found in %d attempts\n",
+                   level_num, MAX_RETRIES);
+        return false;
     }
-    return false;
+
+    Attempt& won = attempts[stats_.winner];
+    stats_.winner_ms = won.ms;
+    world_      = std::move(won.world);
+    recipe_     = std::move(won.recipe);
+    has_recipe_ = true;
+    const SpawnPos sp = FindCenterSpawn(world_);
+    spawn_x_ = sp.x;
+    spawn_y_ = sp.y;
+    printf("[LevelManager] generated level %d  (attempt %d/%d)  spawn=(%.0f, %.0f)  size=%dx%d%s\n",
+           level_num, stats_.winner + 1, MAX_RETRIES, spawn_x_, spawn_y_,
+           world_.GetWidth(), world_.GetHeight(),
+           validate ? "" : "  [validation skipped]");
+    if (validate)
+        printf("[LevelManager] level %d attempts: %d run, %d undecided, %d cancelled, %d skipped"
+               " on %zu thread(s)  wall=%.1f ms  winner=%.1f ms  busy=%.1f ms\n",
+               level_num, stats_.launched, stats_.undecided, stats_.cancelled, stats_.skipped,
+               stats_.threads,
+               stats_.wall_ms, stats_.winner_ms, stats_.busy_ms);
+    return true;
 }
 
 std::string LevelManager::BuildPath(int num) {
@@ -8,6 +8,20 @@
 #include <string>
 #include <cstdint>
 
+// Outcome of the speculative attempts behind the last Generate() call.
+struct GenerateStats {
+    int    winner    = -1;   // attempt index that was kept (-1 = none)
+    int    launched  = 0;    // attempts that started generating
+    int    invalid   = 0;    // generated but failed validation (or failed to generate)
+    int    undecided = 0;    // validation ran out of its tick budget (or deadline, node budget)
+    int    cancelled = 0;    // stopped because an earlier seed had already won
+    int    skipped   = 0;    // never started: an earlier seed had already won
+    size_t threads   = 1;    // threads that ran attempts (caller included)
+    double wall_ms   = 0.0;  // whole Generate() call
+    double winner_ms = 0.0;  // generate + validate of the kept attempt
+    double busy_ms   = 0.0;  // sum over launched attempts (CPU spent)
+};
+
 class LevelManager {
 public:
     // Load map from path. Returns false if the file cannot be read.
@@ -15,6 +29,9 @@ public:
 
     // Generate a level from chunks. Returns false on failure.
     // When validate=false, the physics-based level validator is skipped (online mode).
+    // With validation, attempts run concurrently with seeds derived from `seed` (0 = random);
+    // the first valid one in seed order wins. Attempts are bounded by a tick budget, so a
+    // given seed always gives the same level unless one hits the wall-clock safety cut-off.
     // total_levels drives the difficulty ramp horizon used by LevelGenerator.
     bool Generate(int level_num, const ChunkStore& store, uint32_t seed = 0,
                   bool validate = true,
@@ -28,8 +45,20 @@ public:
     const World& GetWorld() const { return world_; }
     World&       GetWorldMut()    { return world_; }  // mutable access for mode-specific post-processing
 
+    // Race / versus post-processing; also recorded in the recipe.
+    void StripCheckpoints();
+
+    // Chunk placements of the generated level (nullptr for file-loaded maps).
+    const LevelRecipe* Recipe() const { return has_recipe_ ? &recipe_ : nullptr; }
+
+    // Attempt counts and latencies of the last Generate() call.
+    const GenerateStats& LastGenerateStats() const { return stats_; }
+
 private:
-    World world_;
+    World       world_;
+    LevelRecipe recipe_;
+    bool        has_recipe_ = false;
+    GenerateStats stats_;
     float spawn_x_ = 0.f;
     float spawn_y_ = 0.f;
 };
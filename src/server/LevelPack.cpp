@@ -0,0 +1,423 @@
+// LevelPack.cpp — bake (build time) e lettura mmap (runtime) di levels.pack.
+//
+// Layout (little-endian, nativo: il pack è prodotto sulla macchina che compila):
+//   PackHeader
+//   PackSource[source_count]   ogni file letto dal bake (.tmj + .tsx) con size e hash
+//   PackRecord[level_count]    ordinati per path (ricerca binaria)
+//   dati: path, role, tiles (w*h char), solid bitset, entry/exit (u16 tx, u16 ty),
+//         riassunto di attraversamento dei chunk (LevelValidator::SummarizeChunk, allineato a 8)
+
+#include "LevelPack.h"
+#include "ChunkLibrary.h"   // CHUNKS_DIR
+#include "ChunkStore.h"
+#include "LevelValidator.h"
+#include "TiledParser.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr char PACK_MAGIC[4] = { 'T', 'R', 'L', 'P' };
+
+struct PackHeader {
+    char     magic[4];
+    uint32_t version;
+    uint32_t source_count;
+    uint32_t level_count;
+    uint32_t sources_off;
+    uint32_t levels_off;
+    uint32_t file_size;
+    uint32_t reserved;
+};
+static_assert(sizeof(PackHeader) == 32, "PackHeader layout");
+
+struct PackSource {
+    uint64_t hash;
+    uint64_t size;
+    uint32_t path_off;
+    uint32_t path_len;
+};
+static_assert(sizeof(PackSource) == 24, "PackSource layout");
+
+struct PackRecord {
+    uint32_t path_off, path_len;
+    uint32_t role_off, role_len;
+    uint32_t tiles_off;
+    uint32_t solid_off;
+    uint32_t links_off;
+    uint32_t traversal_off, traversal_len;   // len 0: nessun riassunto (tilemap)
+    uint16_t width, height;
+    uint16_t entry_count, exit_count;
+    int32_t  difficulty;
+    int32_t  weight;
+    uint32_t flags;
+};
+static_assert(sizeof(PackRecord) == 56, "PackRecord layout");   // multiplo di 8: i dati restano allineati
+
+// Checksum per la staleness, non crittografico: 8 byte per passo.
+uint64_t HashContent(const uint8_t* p, size_t n) {
+    uint64_t h = 0xCBF29CE484222325ull ^ n;
+    for (; n >= 8; p += 8, n -= 8) {
+        uint64_t w;
+        std::memcpy(&w, p, 8);
+        h = (h ^ w) * 0x9E3779B97F4A7C15ull;
+        h ^= h >> 29;
+    }
+    while (n--) h = (h ^ *p++) * 0x100000001B3ull;
+    return h;
+}
+
+bool ReadBytes(const std::string& path, std::string& out) {
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    if (!f.is_open()) return false;
+    const std::streamoff size = f.tellg();
+    if (size < 0) return false;
+    out.resize(static_cast<size_t>(size));
+    f.seekg(0);
+    return static_cast<bool>(f.read(out.data(), size));
+}
+
+template <typename T>
+T ReadAt(const uint8_t* base, size_t off) {
+    T v;
+    std::memcpy(&v, base + off, sizeof(T));
+    return v;
+}
+
+bool InRange(size_t off, size_t len, size_t size) {
+    return off <= size && len <= size - off;
+}
+
+} // namespace
+
+// ============================================================================
+// Mapping
+// ============================================================================
+
+LevelPack::~LevelPack() { Close(); }
+
+void LevelPack::Close() {
+    if (data_) {
+#ifdef _WIN32
+        UnmapViewOfFile(data_);
+        CloseHandle(static_cast<HANDLE>(map_));
+#else
+        munmap(const_cast<uint8_t*>(data_), size_);
+#endif
+    }
+    data_ = nullptr;
+    size_ = 0;
+    map_  = nullptr;
+    level_count_ = 0;
+    levels_off_  = 0;
+}
+
+bool LevelPack::Open(const char* path) {
+    Close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER fsize{};
+    if (!GetFileSizeEx(file, &fsize) || fsize.QuadPart < static_cast<LONGLONG>(sizeof(PackHeader))) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping) return false;
+    const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) { CloseHandle(mapping); return false; }
+    data_ = static_cast<const uint8_t*>(view);
+    size_ = static_cast<size_t>(fsize.QuadPart);
+    map_  = mapping;
+#else
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(PackHeader))) {
+        close(fd);
+        return false;
+    }
+    void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) return false;
+    data_ = static_cast<const uint8_t*>(view);
+    size_ = static_cast<size_t>(st.st_size);
+#endif
+
+    // --- Header ---
+    const PackHeader hdr = ReadAt<PackHeader>(data_, 0);
+    if (std::memcmp(hdr.magic, PACK_MAGIC, 4) != 0 || hdr.version != LEVEL_PACK_VERSION ||
+        hdr.file_size != size_ ||
+        !InRange(hdr.sources_off, size_t{hdr.source_count} * sizeof(PackSource), size_) ||
+        !InRange(hdr.levels_off,  size_t{hdr.level_count}  * sizeof(PackRecord), size_)) {
+        printf("[LevelPack] '%s': bad header or version (want v%u), ignored\n", path, LEVEL_PACK_VERSION);
+        Close();
+        return false;
+    }
+    level_count_ = static_cast<int>(hdr.level_count);
+    levels_off_  = hdr.levels_off;
+
+    // --- Records in bounds (Find can then trust them) ---
+    PackedLevel lvl;
+    for (int i = 0; i < level_count_; ++i) {
+        if (!Level(i, lvl)) {
+            printf("[LevelPack] '%s': record %d out of bounds, ignored\n", path, i);
+            Close();
+            return false;
+        }
+    }
+
+    // --- Staleness: every source the bake read must still hash the same ---
+    std::string bytes;
+    for (uint32_t i = 0; i < hdr.source_count; ++i) {
+        const PackSource src = ReadAt<PackSource>(data_, hdr.sources_off + i * sizeof(PackSource));
+        if (!InRange(src.path_off, src.path_len, size_)) { Close(); return false; }
+        const std::string src_path(reinterpret_cast<const char*>(data_) + src.path_off, src.path_len);
+        if (!ReadBytes(src_path, bytes) || bytes.size() != src.size ||
+            HashContent(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size()) != src.hash) {
+            printf("[LevelPack] '%s' is stale ('%s' changed since the bake), using .tmj files\n",
+                   path, src_path.c_str());
+            Close();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool LevelPack::Level(int i, PackedLevel& out) const {
+    const PackRecord r = ReadAt<PackRecord>(data_, levels_off_ + static_cast<size_t>(i) * sizeof(PackRecord));
+    const size_t tiles = size_t{r.width} * r.height;
+    const size_t links = (size_t{r.entry_count} + r.exit_count) * 4;
+    if (!InRange(r.path_off, r.path_len, size_) || !InRange(r.role_off, r.role_len, size_) ||
+        !InRange(r.tiles_off, tiles, size_) || !InRange(r.solid_off, (tiles + 7) / 8, size_) ||
+        !InRange(r.links_off, links, size_) || !InRange(r.traversal_off, r.traversal_len, size_) ||
+        r.traversal_off % 8 != 0) return false;
+
+    const char* chars = reinterpret_cast<const char*>(data_);
+    out.path        = std::string_view(chars + r.path_off, r.path_len);
+    out.role        = std::string_view(chars + r.role_off, r.role_len);
+    out.width       = r.width;
+    out.height      = r.height;
+    out.tiles       = chars + r.tiles_off;
+    out.solid_bits  = data_ + r.solid_off;
+    out.links       = data_ + r.links_off;
+    out.traversal      = r.traversal_len ? data_ + r.traversal_off : nullptr;
+    out.traversal_size = r.traversal_len;
+    out.entry_count = r.entry_count;
+    out.exit_count  = r.exit_count;
+    out.difficulty  = r.difficulty;
+    out.weight      = r.weight;
+    out.flags       = r.flags;
+    return true;
+}
+
+bool LevelPack::Find(std::string_view path, PackedLevel& out) const {
+    if (!data_) return false;
+    // Record ordinati per path al bake: ricerca binaria.
+    int lo = 0, hi = level_count_;
+    while (lo < hi) {
+        const int mid = (lo + hi) / 2;
+        const PackRecord r = ReadAt<PackRecord>(data_, levels_off_ + static_cast<size_t>(mid) * sizeof(PackRecord));
+        const std::string_view key(reinterpret_cast<const char*>(data_) + r.path_off, r.path_len);
+        if (key < path) lo = mid + 1;
+        else            hi = mid;
+    }
+    return lo < level_count_ && Level(lo, out) && out.path == path;
+}
+
+const LevelPack* LevelPack::Shared() {
+    static LevelPack pack;
+    static const bool ok = [] {
+        if (!pack.Open(LEVEL_PACK_PATH)) {
+            printf("[LevelPack] no usable '%s', loading .tmj files\n", LEVEL_PACK_PATH);
+            return false;
+        }
+        printf("[LevelPack] mapped '%s': %d levels\n", LEVEL_PACK_PATH, pack.LevelCount());
+        return true;
+    }();
+    return ok ? &pack : nullptr;
+}
+
+// ============================================================================
+// Bake
+// ============================================================================
+
+bool BakeLevelPack(const char* levels_dir, const char* out_path) {
+    auto files = ListTmjFiles(levels_dir);
+    std::sort(files.begin(), files.end());   // ordine dei record = ordine di Find
+
+    std::vector<std::string> sources;
+    std::vector<uint8_t>     data;            // blob dopo i record, offset relativi
+    std::vector<PackRecord>  records;
+    std::vector<std::string> baked_paths;
+    std::vector<uint8_t>     summary;
+    const std::string        chunks_prefix = std::string(CHUNKS_DIR) + "/";
+    size_t                   summaries = 0, summary_bytes = 0;
+    double                   summary_ms = 0.0;
+
+    auto put = [&data](const void* p, size_t n) {
+        const uint32_t off = static_cast<uint32_t>(data.size());
+        data.insert(data.end(), static_cast<const uint8_t*>(p), static_cast<const uint8_t*>(p) + n);
+        return off;
+    };
+
+    for (const std::string& path : files) {
+        Chunk      c;
+        ChunkTiles tiles;
+        TiledMap   map;
+        if (!ChunkStore::ParseChunk(path.c_str(), c, tiles) || !LoadTiledMap(path.c_str(), map) ||
+            c.width > 0xFFFF || c.height > 0xFFFF) {
+            printf("[LevelPack] skipped '%s' (parse failed)\n", path.c_str());
+            continue;
+        }
+        sources.push_back(path);
+        sources.push_back(std::filesystem::path(TiledResolvePath(path, map.tileset_source))
+                              .lexically_normal().generic_string());
+
+        PackRecord r{};
+        r.path_off = put(path.data(), path.size());
+        r.path_len = static_cast<uint32_t>(path.size());
+        r.role_off = put(c.role.data(), c.role.size());
+        r.role_len = static_cast<uint32_t>(c.role.size());
+        r.width  = static_cast<uint16_t>(c.width);
+        r.height = static_cast<uint16_t>(c.height);
+
+        r.tiles_off = static_cast<uint32_t>(data.size());
+        put(tiles.chars.data(), tiles.chars.size());
+
+        std::vector<uint8_t> bits((tiles.solid.size() + 7) / 8, 0);
+        for (size_t i = 0; i < tiles.solid.size(); ++i)
+            if (tiles.solid[i]) bits[i >> 3] |= static_cast<uint8_t>(1u << (i & 7));
+        r.solid_off = put(bits.data(), bits.size());
+
+        r.links_off   = static_cast<uint32_t>(data.size());
+        r.entry_count = static_cast<uint16_t>(c.entries.size());
+        r.exit_count  = static_cast<uint16_t>(c.exits.size());
+        for (const auto* list : { &c.entries, &c.exits })
+            for (const auto& [tx, ty] : *list) {
+                const uint8_t b[4] = { static_cast<uint8_t>(tx), static_cast<uint8_t>(tx >> 8),
+                                       static_cast<uint8_t>(ty), static_cast<uint8_t>(ty >> 8) };
+                put(b, 4);
+            }
+
+        // Solo i chunk: il validatore compone i loro riassunti, le tilemap fisse non servono.
+        c.tiles = tiles.chars.data();
+        c.solid = tiles.solid.data();
+        const auto ts = std::chrono::steady_clock::now();
+        if (path.compare(0, chunks_prefix.size(), chunks_prefix) == 0 &&
+            LevelValidator::SummarizeChunk(c, summary)) {
+            summary_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - ts).count();
+            data.resize((data.size() + 7) & ~size_t{7}, 0);
+            r.traversal_off = put(summary.data(), summary.size());
+            r.traversal_len = static_cast<uint32_t>(summary.size());
+            summaries++;
+            summary_bytes += summary.size();
+        }
+
+        r.difficulty = c.difficulty;
+        r.weight     = c.weight;
+        r.flags      = (c.has_spawn ? PACK_HAS_SPAWN : 0u) | (c.has_end ? PACK_HAS_END : 0u) |
+                       (c.has_checkpoint ? PACK_HAS_CHECKPOINT : 0u);
+        records.push_back(r);
+    }
+
+    std::sort(sources.begin(), sources.end());
+    sources.erase(std::unique(sources.begin(), sources.end()), sources.end());
+
+    std::vector<PackSource> src_records;
+    std::string bytes;
+    for (const std::string& s : sources) {
+        if (!ReadBytes(s, bytes)) {
+            printf("[LevelPack] cannot read source '%s'\n", s.c_str());
+            return false;
+        }
+        PackSource ps{};
+        ps.hash     = HashContent(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size());
+        ps.size     = bytes.size();
+        ps.path_off = put(s.data(), s.size());
+        ps.path_len = static_cast<uint32_t>(s.size());
+        src_records.push_back(ps);
+    }
+
+    // --- Layout: header | sources | records | data (offset ribasati) ---
+    const uint32_t sources_off = sizeof(PackHeader);
+    const uint32_t levels_off  = sources_off + static_cast<uint32_t>(src_records.size() * sizeof(PackSource));
+    const uint32_t data_off    = levels_off  + static_cast<uint32_t>(records.size() * sizeof(PackRecord));
+    for (PackSource& s : src_records) s.path_off += data_off;
+    for (PackRecord& r : records) {
+        r.path_off  += data_off;
+        r.role_off  += data_off;
+        r.tiles_off += data_off;
+        r.solid_off += data_off;
+        r.links_off += data_off;
+        if (r.traversal_len) r.traversal_off += data_off;
+    }
+
+    PackHeader hdr{};
+    std::memcpy(hdr.magic, PACK_MAGIC, 4);
+    hdr.version      = LEVEL_PACK_VERSION;
+    hdr.source_count = static_cast<uint32_t>(src_records.size());
+    hdr.level_count  = static_cast<uint32_t>(records.size());
+    hdr.sources_off  = sources_off;
+    hdr.levels_off   = levels_off;
+    hdr.file_size    = data_off + static_cast<uint32_t>(data.size());
+
+    // Scritto a parte e rinominato: un processo che sta mappando il vecchio pack non vede
+    // mai un file a metà.
+    const std::string tmp = std::string(out_path) + ".tmp";
+    {
+        std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+        if (!f.is_open()) {
+            printf("[LevelPack] cannot write '%s'\n", tmp.c_str());
+            return false;
+        }
+        f.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+        f.write(reinterpret_cast<const char*>(src_records.data()),
+                static_cast<std::streamsize>(src_records.size() * sizeof(PackSource)));
+        f.write(reinterpret_cast<const char*>(records.data()),
+                static_cast<std::streamsize>(records.size() * sizeof(PackRecord)));
+        f.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        if (!f) return false;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, out_path, ec);
+    if (ec) {
+        printf("[LevelPack] cannot replace '%s': %s\n", out_path, ec.message().c_str());
+        return false;
+    }
+
+    printf("[LevelPack] baked %zu levels from %zu sources -> '%s' (%u bytes)\n",
+           records.size(), src_records.size(), out_path, hdr.file_size);
+    printf("[LevelPack] %zu chunk traversal summaries, %zu bytes, %.0f ms\n", summaries, summary_bytes,
+           summary_ms);
+    return true;
+}
+
+// ============================================================================
+// LoadWorldFile
+// ============================================================================
+
+bool LoadWorldFile(World& world, const char* path) {
+    PackedLevel lvl;
+    const LevelPack* pack = LevelPack::Shared();
+    if (pack && pack->Find(path, lvl))
+        return world.LoadFromTiles(lvl.width, lvl.height, lvl.tiles, lvl.solid_bits);
+    return world.LoadFromFile(path);
+}
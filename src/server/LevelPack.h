@@ -0,0 +1,92 @@
+#pragma once
+// SRP: read-only view of levels.pack, the build-time bake of every .tmj under assets/levels
+// (chunks and fixed tilemaps). Memory-mapped once per process; ChunkStore and map loading
+// read tiles, solid bits, entry/exit lists and properties straight out of it, no parsing.
+// Chunks also carry the validator's traversal summary, computed at bake time.
+// A pack whose sources changed since the bake (content hash) is ignored: callers fall back
+// to the .tmj files. No ENet or Raylib dependency.
+
+#include "World.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+
+static constexpr const char* LEVEL_PACK_PATH    = "assets/levels/levels.pack";
+static constexpr uint32_t    LEVEL_PACK_VERSION = 2;   // bump on any layout change
+
+// Flags of a baked level.
+enum : uint32_t {
+    PACK_HAS_SPAWN      = 1u << 0,
+    PACK_HAS_END        = 1u << 1,
+    PACK_HAS_CHECKPOINT = 1u << 2,
+};
+
+// One baked .tmj, pointing into the mapping (valid while the pack is alive).
+struct PackedLevel {
+    std::string_view path;        // as the game opens it, e.g. "assets/levels/chunks/03/a.tmj"
+    std::string_view role;        // chunk_role property ("any" if absent)
+    int         width  = 0;
+    int         height = 0;
+    const char*    tiles      = nullptr;   // width*height chars, row-major
+    const uint8_t* solid_bits = nullptr;   // bit i = tile i, LSB first
+    const uint8_t* links      = nullptr;   // (entry_count + exit_count) × {u16 tx, u16 ty} LE
+    const uint8_t* traversal  = nullptr;   // LevelValidator::SummarizeChunk, 8-aligned (chunks only)
+    size_t         traversal_size = 0;
+    int         entry_count = 0;
+    int         exit_count  = 0;
+    int         difficulty  = 1;
+    int         weight      = 1;
+    uint32_t    flags       = 0;           // PACK_HAS_*
+
+    bool Solid(int x, int y) const {
+        const size_t i = static_cast<size_t>(y) * width + x;
+        return (solid_bits[i >> 3] >> (i & 7)) & 1;
+    }
+    std::pair<int,int> Entry(int i) const { return Link(i); }
+    std::pair<int,int> Exit(int i)  const { return Link(entry_count + i); }
+
+private:
+    std::pair<int,int> Link(int i) const {
+        const uint8_t* p = links + 4 * i;
+        return { p[0] | (p[1] << 8), p[2] | (p[3] << 8) };
+    }
+};
+
+class LevelPack {
+public:
+    LevelPack() = default;
+    ~LevelPack();
+    LevelPack(const LevelPack&)            = delete;
+    LevelPack& operator=(const LevelPack&) = delete;
+
+    // Map `path` and check header, bounds and every recorded source's content hash.
+    // false (and nothing mapped) if missing, from another version, or stale.
+    bool Open(const char* path);
+
+    // Baked level by exact path. false if the pack does not contain it.
+    bool Find(std::string_view path, PackedLevel& out) const;
+
+    int LevelCount() const { return level_count_; }
+
+    // LEVEL_PACK_PATH, opened and validated on first use. nullptr if unusable.
+    static const LevelPack* Shared();
+
+private:
+    void Close();
+    bool Level(int i, PackedLevel& out) const;
+
+    const uint8_t* data_  = nullptr;
+    size_t         size_  = 0;
+    void*          map_   = nullptr;   // Win32 mapping handle (unused on POSIX)
+    int            level_count_ = 0;
+    size_t         levels_off_  = 0;
+};
+
+// Bake every .tmj under `levels_dir` into `out_path`, with a traversal summary for each
+// chunk under CHUNKS_DIR. Used by TileRace_PackTool.
+bool BakeLevelPack(const char* levels_dir, const char* out_path);
+
+// World from levels.pack when it holds `path`, otherwise World::LoadFromFile.
+bool LoadWorldFile(World& world, const char* path);
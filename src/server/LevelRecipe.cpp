@@ -0,0 +1,48 @@
+// LevelRecipe.cpp — codifica compatta della ricetta di un livello generato.
+
+#include "LevelRecipe.h"
+#include <utility>
+
+// Limite di sicurezza in lettura: un livello reale usa qualche decina di chunk.
+static constexpr uint32_t MAX_RECIPE_PLACEMENTS = 4096;
+
+void WriteLevelRecipe(BitWriter& w, const LevelRecipe& recipe) {
+    w.WriteBits(recipe.seed, 32);
+    w.WriteBits(static_cast<uint32_t>(recipe.chunk_hash), 32);
+    w.WriteBits(static_cast<uint32_t>(recipe.chunk_hash >> 32), 32);
+    w.WriteBool(recipe.strip_checkpoints);
+    w.WriteVarUint(static_cast<uint32_t>(recipe.placements.size()));
+    int32_t px = 0, py = 0;
+    for (const ChunkPlacement& p : recipe.placements) {
+        w.WriteVarUint(p.chunk_id);
+        w.WriteVarInt(p.x - px);
+        w.WriteVarInt(p.y - py);
+        px = p.x;
+        py = p.y;
+    }
+}
+
+bool ReadLevelRecipe(BitReader& r, LevelRecipe& out) {
+    LevelRecipe recipe;
+    recipe.seed = r.ReadBits(32);
+    const uint64_t lo = r.ReadBits(32);
+    const uint64_t hi = r.ReadBits(32);
+    recipe.chunk_hash        = lo | (hi << 32);
+    recipe.strip_checkpoints = r.ReadBool();
+    const uint32_t count = r.ReadVarUint();
+    if (r.Overflowed() || count > MAX_RECIPE_PLACEMENTS) return false;
+    recipe.placements.resize(count);
+    int32_t px = 0, py = 0;
+    for (ChunkPlacement& p : recipe.placements) {
+        const uint32_t id = r.ReadVarUint();
+        if (id > 0xFFFFu) return false;
+        p.chunk_id = static_cast<uint16_t>(id);
+        p.x = px + r.ReadVarInt();
+        p.y = py + r.ReadVarInt();
+        px = p.x;
+        py = p.y;
+    }
+    if (r.Overflowed()) return false;
+    out = std::move(recipe);
+    return true;
+}
@@ -0,0 +1,27 @@
+#pragma once
+// Compact description of a generated level: which chunks were blitted where, in order.
+// Rebuilding from a recipe (LevelGenerator::Rebuild) needs only the ChunkStore — no RNG —
+// so it gives the same World on every platform as long as both ends hold the same chunk
+// set (ChunkStore::ContentHash). No ENet or Raylib dependency.
+#include "BitStream.h"
+#include <cstdint>
+#include <vector>
+
+struct ChunkPlacement {
+    uint16_t chunk_id = 0;   // ChunkStore::ChunkById
+    int32_t  x        = 0;   // offset of the chunk's top-left tile (composition space)
+    int32_t  y        = 0;
+};
+
+struct LevelRecipe {
+    uint32_t seed              = 0;      // generator seed (diagnostics only)
+    uint64_t chunk_hash        = 0;      // ChunkStore::ContentHash of the generating store
+    bool     strip_checkpoints = false;  // race / versus post-processing applied
+    std::vector<ChunkPlacement> placements;
+};
+
+// Bit-packed layout: u32 seed, u64 chunk_hash, 1 bit strip_checkpoints, varuint count,
+// then per placement varuint chunk_id + varint dx, dy relative to the previous placement
+// (consecutive chunks are stitched, so the deltas stay small).
+void WriteLevelRecipe(BitWriter& w, const LevelRecipe& recipe);
+bool ReadLevelRecipe (BitReader& r, LevelRecipe& out);   // false on malformed input
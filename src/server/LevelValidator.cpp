@@ -10,8 +10,13 @@
 #include "Player.h"
 #include "SpawnFinder.h"
 #include "Physics.h"
-#include <unordered_set>
-#include <queue>
+#include "LevelGenerator.h"   // PlacementOrigin
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <type_traits>
 #include <vector>
 #include <cstdio>
 #include <cmath>
@@ -115,21 +120,6 @@ static InputFrame MakeInput(const ActionDef& act, int tick, const PlayerState& p
     return f;
 }
 
-// ============================================================================
-// Tile-overlap helpers
-// ============================================================================
-
-static bool OverlapsTileType(float px, float py, const World& world, char type) {
-    const int tx0 = static_cast<int>(px)                    / TILE_SIZE;
-    const int ty0 = static_cast<int>(py)                    / TILE_SIZE;
-    const int tx1 = static_cast<int>(px + TILE_SIZE - 1.f)  / TILE_SIZE;
-    const int ty1 = static_cast<int>(py + TILE_SIZE - 1.f)  / TILE_SIZE;
-    for (int ty = ty0; ty <= ty1; ++ty)
-        for (int tx = tx0; tx <= tx1; ++tx)
-            if (world.GetTile(tx, ty) == type) return true;
-    return false;
-}
-
 // ============================================================================
 // Single-action simulation
 // ============================================================================
@@ -137,105 +127,703 @@ static bool OverlapsTileType(float px, float py, const World& world, char type)
 static constexpr int   MAX_SIM_TICKS = static_cast<int>(3.0f / FIXED_DT);  // 3 s of simulated time (scales with FIXED_DT)
 static constexpr int   MAX_BFS_NODES = 50000;
 
+// Ground tiles found by runs, appended to a buffer that outlives them (see ValidatorScratch).
+using Landings = std::vector<std::pair<int, int>>;
+
+// One run's ground tiles are landings[first, first + count).
 struct SimResult {
-    bool reached_end = false;
-    std::vector<std::pair<int, int>> ground_tiles;
+    bool     reached_end = false;
+    uint32_t first       = 0;
+    uint32_t count       = 0;
+    uint32_t ticks       = 0;   // Player::Simulate calls made by this run
+    uint32_t summarized  = 0;   // ticks read from a chunk summary instead
 };
 
-static SimResult SimulateAction(const ActionDef& act, int start_tx, int start_ty,
-                                 const World& world) {
-    SimResult result;
+// A point a best-first search can branch from: the full player (state and jump latch)
+// with its coarse key. Key = tile of the player's top-left corner + StateIndex.
+struct SearchState {
+    Player  player;
+    int     tx = 0, ty = 0;
+    uint8_t sub = 0;
+};
+
+// vel_y in buckets of half a jump impulse: rising fast, rising, level, falling, falling fast.
+static constexpr int VY_BUCKETS      = 5;
+static constexpr int STATES_PER_TILE = VY_BUCKETS * 2 /*dash_ready*/ * 3 /*wall: none, left, right*/;
+
+static uint8_t StateIndex(const PlayerState& ps) {
+    const int vy   = std::clamp(static_cast<int>(std::floor(ps.vel_y / (JUMP_FORCE * 0.5f))) + 2,
+                                0, VY_BUCKETS - 1);
+    const int wall = ps.on_wall_left ? 1 : ps.on_wall_right ? 2 : 0;
+    return static_cast<uint8_t>((vy * 2 + (ps.dash_ready ? 1 : 0)) * 3 + wall);
+}
 
+// Validator loop state between two ticks of one run.
+struct SimCursor {
     Player player;
+    int    tick         = 0;
+    bool   loop_done    = false;   // only the final exit check is left
+    bool   was_airborne = false;
+    int    ground_ticks = 0;
+    int    stale_ticks  = 0;
+    float  last_x = 0.f, last_y = 0.f;
+};
+
+// Tiles Player::Simulate may read during one tick that starts at ps: the player box moved
+// by up to one anti-tunnelling step (TILE_SIZE - 1 px per axis) plus a corner-correction
+// nudge, grown by the wall probes and the 1 px ground probe.
+struct TileBox {
+    int min_x = INT_MAX, min_y = INT_MAX;
+    int max_x = INT_MIN, max_y = INT_MIN;
+
+    static TileBox Around(const PlayerState& ps) {
+        constexpr float STEP_X = (TILE_SIZE - 1) + (CORNER_CORRECTION_PX + 1);
+        constexpr float STEP_Y =  TILE_SIZE - 1;
+        const float x0 = ps.x - STEP_X - 1.f - WALL_PROBE_REACH;
+        const float x1 = ps.x + STEP_X + TILE_SIZE + WALL_PROBE_REACH;
+        const float y0 = ps.y - STEP_Y;
+        const float y1 = ps.y + STEP_Y + TILE_SIZE;
+        return { static_cast<int>(std::floor(x0 / TILE_SIZE)), static_cast<int>(std::floor(y0 / TILE_SIZE)),
+                 static_cast<int>(std::floor(x1 / TILE_SIZE)), static_cast<int>(std::floor(y1 / TILE_SIZE)) };
+    }
+    bool Holds(const TileBox& b) const {
+        return b.min_x >= min_x && b.min_y >= min_y && b.max_x <= max_x && b.max_y <= max_y;
+    }
+    void Add(const TileBox& b) {
+        min_x = std::min(min_x, b.min_x);
+        min_y = std::min(min_y, b.min_y);
+        max_x = std::max(max_x, b.max_x);
+        max_y = std::max(max_y, b.max_y);
+    }
+};
+
+static SimCursor StartCursor(int start_tx, int start_ty) {
+    SimCursor c;
     PlayerState ps{};
     ps.x          = static_cast<float>(start_tx * TILE_SIZE);
     ps.y          = static_cast<float>(start_ty * TILE_SIZE);
     ps.on_ground  = true;
     ps.dash_ready = true;
-    player.SetState(ps);
+    c.player.SetState(ps);
+    c.last_x = ps.x;
+    c.last_y = ps.y;
+    return c;
+}
 
-    bool was_airborne = false;
-    int  ground_ticks = 0;      // consecutive ground ticks after becoming airborne
-    float last_x = ps.x, last_y = ps.y;
-    int stale_ticks = 0;
+// How RunAction returned.
+enum class RunEnd : uint8_t {
+    DONE,     // the run is over (result final)
+    LEFT,     // the next tick would read a tile outside `bound`; c is at that tick
+    PAUSED,   // c reached tick `pause_at`; calling again continues the run
+};
 
-    std::unordered_set<int64_t> seen_tiles;
+// Run action `act` started at (start_tx, start_ty) from cursor c until it ends.
+// New ground tiles are appended to `landings`, whose tail is result's range.
+// reach (optional) receives the tiles the run read. bound (optional): stop before the
+// first tick that would read a tile outside it. pause_at (optional): stop before tick
+// pause_at. states (optional): branch points met on the way (new ground tile, apex with
+// the dash still charged, first tick on a wall), one per key.
+static RunEnd RunAction(const ActionDef& act, int start_tx, int start_ty, const World& world,
+                        SimCursor& c, Landings& landings, SimResult& result,
+                        TileBox* reach = nullptr, const TileBox* bound = nullptr, int pause_at = -1,
+                        std::vector<SearchState>* states = nullptr) {
+    while (!c.loop_done) {
+        if (c.tick >= MAX_SIM_TICKS) { c.loop_done = true; break; }
+        if (c.tick == pause_at) return RunEnd::PAUSED;
+        const PlayerState& cur = c.player.GetState();
+        const TileBox      box = TileBox::Around(cur);
+        if (bound && !bound->Holds(box)) return RunEnd::LEFT;
+        if (reach) reach->Add(box);
 
-    for (int tick = 0; tick < MAX_SIM_TICKS; ++tick) {
-        const PlayerState& cur = player.GetState();
+        const uint8_t touched = world.QueryAABB(cur.x, cur.y, TILE_SIZE, TILE_SIZE);
 
         // --- Check for 'E' tile ---
-        if (OverlapsTileType(cur.x, cur.y, world, 'E')) {
+        if (touched & TILE_EXIT) {
             result.reached_end = true;
-            return result;
+            return RunEnd::DONE;
         }
 
         // --- Kill tile → abort this trajectory ---
-        if (OverlapsTileType(cur.x, cur.y, world, 'K'))
-            break;
-
         // --- Out of bounds → abort ---
-        if (cur.x < 0.f || cur.y < 0.f ||
+        if ((touched & TILE_KILL) ||
+            cur.x < 0.f || cur.y < 0.f ||
             cur.x > world.GetWidth()  * TILE_SIZE ||
-            cur.y > world.GetHeight() * TILE_SIZE)
+            cur.y > world.GetHeight() * TILE_SIZE) {
+            c.loop_done = true;
             break;
+        }
 
         // --- Generate input and simulate one tick ---
-        const InputFrame input = MakeInput(act, tick, cur);
-        player.Simulate(input, world);
+        const float      prev_vy   = cur.vel_y;
+        const bool       prev_wall = cur.on_wall_left || cur.on_wall_right;
+        const InputFrame input     = MakeInput(act, c.tick, cur);
+        c.player.Simulate(input, world);
+        ++c.tick;
+        ++result.ticks;
 
-        const PlayerState& after = player.GetState();
+        const PlayerState& after = c.player.GetState();
 
-        // --- Record ground tiles ---
+        // --- Record ground tiles (a handful per run: a linear scan dedups) ---
+        bool branch = false;
         if (after.on_ground) {
-            int gtx = static_cast<int>(after.x) / TILE_SIZE;
-            int gty = static_cast<int>(after.y) / TILE_SIZE;
-            if (gtx != start_tx || gty != start_ty) {
-                int64_t key = (static_cast<int64_t>(gty) << 32) |
-                               static_cast<uint32_t>(gtx);
-                if (seen_tiles.find(key) == seen_tiles.end()) {
-                    seen_tiles.insert(key);
-                    result.ground_tiles.push_back({gtx, gty});
-                }
+            const std::pair<int, int> g{ static_cast<int>(after.x) / TILE_SIZE,
+                                         static_cast<int>(after.y) / TILE_SIZE };
+            if ((g.first != start_tx || g.second != start_ty) &&
+                std::find(landings.begin() + result.first, landings.end(), g) == landings.end()) {
+                landings.push_back(g);
+                result.count++;
+                branch = true;
             }
+        } else if (after.dash_active_ticks == 0) {
+            branch = (prev_vy < 0.f && after.vel_y >= 0.f && after.dash_ready) ||
+                     (!prev_wall && (after.on_wall_left || after.on_wall_right));
+        }
+        if (states && branch) {
+            SearchState st;
+            st.player = c.player;
+            st.tx     = static_cast<int>(after.x) / TILE_SIZE;
+            st.ty     = static_cast<int>(after.y) / TILE_SIZE;
+            st.sub    = StateIndex(after);
+            if (std::none_of(states->begin(), states->end(), [&](const SearchState& o) {
+                    return o.tx == st.tx && o.ty == st.ty && o.sub == st.sub; }))
+                states->push_back(st);
         }
 
         // --- Termination heuristics ---
-        if (!after.on_ground) was_airborne = true;
+        if (!after.on_ground) c.was_airborne = true;
 
-        if (was_airborne && after.on_ground) ground_ticks++;
-        else ground_ticks = 0;
+        if (c.was_airborne && after.on_ground) c.ground_ticks++;
+        else c.ground_ticks = 0;
 
         // Landed after flight: give 5 extra ticks to slide, then stop
-        if (was_airborne && ground_ticks >= 5) break;
-
         // Stuck detection (not moving)
-        if (std::fabs(after.x - last_x) < 0.1f && std::fabs(after.y - last_y) < 0.1f)
-            stale_ticks++;
+        if (std::fabs(after.x - c.last_x) < 0.1f && std::fabs(after.y - c.last_y) < 0.1f)
+            c.stale_ticks++;
         else
-            stale_ticks = 0;
-        last_x = after.x;
-        last_y = after.y;
-        if (stale_ticks > 15) break;
+            c.stale_ticks = 0;
+        c.last_x = after.x;
+        c.last_y = after.y;
+        if ((c.was_airborne && c.ground_ticks >= 5) || c.stale_ticks > 15) c.loop_done = true;
     }
 
     // Check end tile one last time after loop
-    const PlayerState& final_ps = player.GetState();
-    if (OverlapsTileType(final_ps.x, final_ps.y, world, 'E'))
+    const PlayerState& final_ps = c.player.GetState();
+    const TileBox      box      = TileBox::Around(final_ps);
+    if (bound && !bound->Holds(box)) return RunEnd::LEFT;
+    if (reach) reach->Add(box);
+    if (world.QueryAABB(final_ps.x, final_ps.y, TILE_SIZE, TILE_SIZE) & TILE_EXIT)
         result.reached_end = true;
+    return RunEnd::DONE;
+}
 
+static SimResult SimulateAction(const ActionDef& act, int start_tx, int start_ty,
+                                 const World& world, Landings& landings) {
+    SimResult result;
+    result.first = static_cast<uint32_t>(landings.size());
+    SimCursor c = StartCursor(start_tx, start_ty);
+    RunAction(act, start_tx, start_ty, world, c, landings, result);
     return result;
 }
 
 // ============================================================================
-// LevelValidator::Validate — BFS over ground tile positions
+// Chunk traversal summaries — baked into levels.pack, composed per level
+// ============================================================================
+//
+// What every macro-action does inside one chunk, simulated with the chunk alone in an
+// empty map (SummarizeChunk, run by BakeLevelPack). One node per standable tile,
+// NUM_ACTIONS edges per node in action order. An edge holds as long as the level's tiles
+// inside its box equal the chunk's own ('I'/'O' read as air). Neighbouring chunks overlap
+// and overwrite some of those tiles, so a run also keeps checkpoints: the cursor every
+// CHECKPOINT_TICKS ticks with the box read so far. When the whole run is not clean in the
+// level, the validator resumes the latest checkpoint that is. A run that leaves the chunk
+// ends with one more checkpoint, the tick before it would read an outside tile (the seam).
+//
+// Blob layout (native endian like the rest of the pack, every part 4-byte aligned):
+//   TraversalHeader
+//   int32               node[width*height]      first edge of the tile, -1 = not a node
+//   TraversalEdge       edges[edge_count]
+//   TraversalCheckpoint checkpoints[checkpoint_count]
+//   SimCursor           cursors[checkpoint_count]   positions in chunk pixels
+//   int16               landings[landing_count][2]  ground tiles (x, y), chunk coordinates
+
+// Air around a chunk simulated alone: runs stop before reading it.
+static constexpr int SUMMARY_MARGIN = 2;
+// Ticks between two checkpoints of a run.
+static constexpr int CHECKPOINT_TICKS = 8;
+// Edge boxes are int16.
+static constexpr int MAX_SUMMARY_SIDE = 4096;
+
+// Chunk tiles read by a run (empty when max < min).
+struct TraversalBox {
+    int16_t min_x = 0, min_y = 0, max_x = -1, max_y = -1;
+};
+
+struct TraversalHeader {
+    uint32_t stamp;           // TraversalStamp() of the build that baked it
+    uint16_t width, height;
+    uint32_t edge_count, checkpoint_count, landing_count;
+};
+
+struct TraversalEdge {
+    uint32_t     first       = 0;   // first landing
+    uint32_t     checkpoint  = 0;   // first checkpoint
+    uint16_t     count       = 0;   // landings, in the order the simulation found them
+    uint16_t     ticks       = 0;   // ticks of the whole run (complete only)
+    uint16_t     checkpoints = 0;
+    uint8_t      complete    = 0;   // 0: the run left the chunk, only checkpoints apply
+    uint8_t      reached_end = 0;
+    TraversalBox box;               // read by the whole run (complete only)
+};
+
+struct TraversalCheckpoint {
+    uint16_t     ticks = 0;         // cursor tick
+    uint16_t     count = 0;         // landings found before it (a prefix of the edge's)
+    TraversalBox box;               // read before it
+};
+static_assert(sizeof(TraversalHeader) == 20 && sizeof(TraversalEdge) == 24 &&
+              sizeof(TraversalCheckpoint) == 12, "traversal layout");
+static_assert(std::is_trivially_copyable_v<SimCursor> && sizeof(SimCursor) % 4 == 0,
+              "cursors are stored bytewise");
+
+// Fingerprint of what a summary depends on besides its chunk: the layout above, the
+// action table and run limits, and the physics (every action run in a small probe room).
+// A summary baked by a build with another stamp is ignored and its chunk simulated.
+static uint32_t TraversalStamp() {
+    static const uint32_t stamp = [] {
+        static const std::vector<std::string> ROOM = {
+            "0000000000000000",
+            "0              0",
+            "0              0",
+            "0       000    0",
+            "0              0",
+            "0  00          0",
+            "0              0",
+            "0              0",
+            "0000000000000000",
+        };
+        World room;
+        room.LoadFromGrid(static_cast<int>(ROOM[0].size()), static_cast<int>(ROOM.size()), ROOM);
+
+        uint64_t h = 0xCBF29CE484222325ull;
+        auto mix   = [&h](uint64_t v) { h = (h ^ v) * 0x100000001B3ull; };
+        auto mix_f = [&mix](float f) { uint32_t b; std::memcpy(&b, &f, 4); mix(b); };
+        mix(sizeof(TraversalEdge)); mix(sizeof(TraversalCheckpoint)); mix(sizeof(SimCursor));
+        mix(NUM_ACTIONS); mix(MAX_SIM_TICKS); mix(SUMMARY_MARGIN); mix(CHECKPOINT_TICKS);
+        Landings lands;
+        for (int ai = 0; ai < NUM_ACTIONS; ++ai) {
+            SimResult r;
+            SimCursor c = StartCursor(3, 7);
+            lands.clear();
+            RunAction(ACTIONS[ai], 3, 7, room, c, lands, r);
+            const PlayerState& ps = c.player.GetState();
+            mix_f(ps.x); mix_f(ps.y); mix_f(ps.vel_x); mix_f(ps.vel_y); mix_f(ps.move_vel_x);
+            mix(r.ticks); mix(r.reached_end);
+            for (auto [gx, gy] : lands) { mix(static_cast<uint32_t>(gx)); mix(static_cast<uint32_t>(gy)); }
+        }
+        return static_cast<uint32_t>(h ^ (h >> 32));
+    }();
+    return stamp;
+}
+
+bool LevelValidator::SummarizeChunk(const Chunk& chunk, std::vector<uint8_t>& out) {
+    out.clear();
+    const int w = chunk.width, h = chunk.height;
+    if (w <= 0 || h <= 0 || w > MAX_SUMMARY_SIDE || h > MAX_SUMMARY_SIDE) return false;
+
+    std::vector<int32_t>             node(static_cast<size_t>(w) * h, -1);
+    std::vector<TraversalEdge>       edges;
+    std::vector<TraversalCheckpoint> checkpoints;
+    std::vector<SimCursor>           cursors;
+    std::vector<int16_t>             landings;   // (x, y) pairs
+
+    // The chunk as FinalizeGrid writes it ('I'/'O' become air), alone in an empty map.
+    const int m = SUMMARY_MARGIN;
+    std::vector<std::string> rows(h + 2 * m, std::string(w + 2 * m, ' '));
+    for (int y = 0; y < h; ++y)
+        for (int x = 0; x < w; ++x) {
+            const char ch = chunk.Tile(x, y);
+            rows[y + m][x + m] = (ch == 'I' || ch == 'O') ? ' ' : ch;
+        }
+    World iso;
+    iso.LoadFromGrid(w + 2 * m, h + 2 * m, rows);
+    const TileBox bound{ m, m, w + m - 1, h + m - 1 };
+    const float   shift = static_cast<float>(m * TILE_SIZE);
+    Landings      lands;
+
+    // Chunk coordinates of what the run read so far.
+    auto to_box = [m](const TileBox& b) {
+        return TraversalBox{ static_cast<int16_t>(b.min_x - m), static_cast<int16_t>(b.min_y - m),
+                             static_cast<int16_t>(b.max_x - m), static_cast<int16_t>(b.max_y - m) };
+    };
+    auto add_checkpoint = [&](SimCursor c, const SimResult& r, const TileBox& reach) {
+        PlayerState ps = c.player.GetState();
+        ps.x -= shift;
+        ps.y -= shift;
+        c.player.SetState(ps);
+        c.last_x -= shift;
+        c.last_y -= shift;
+        cursors.push_back(c);
+        checkpoints.push_back({ static_cast<uint16_t>(c.tick), static_cast<uint16_t>(r.count),
+                                to_box(reach) });
+    };
+
+    // Nodes: free tiles with ground under the player's box whose first tick reads only
+    // chunk tiles.
+    for (int y = 0; y < h; ++y)
+        for (int x = 0; x < w; ++x) {
+            const int ix = x + m, iy = y + m;
+            if (iso.IsSolid(ix, iy) || !(iso.IsSolid(ix, iy + 1) || iso.IsSolid(ix + 1, iy + 1)))
+                continue;
+            if (!bound.Holds(TileBox::Around(StartCursor(ix, iy).player.GetState())))
+                continue;
+            node[static_cast<size_t>(y) * w + x] = static_cast<int32_t>(edges.size());
+            for (int ai = 0; ai < NUM_ACTIONS; ++ai) {
+                SimResult     r;
+                TileBox       reach;
+                SimCursor     c = StartCursor(ix, iy);
+                TraversalEdge e;
+                e.checkpoint = static_cast<uint32_t>(checkpoints.size());
+                lands.clear();
+                RunEnd end;
+                int    pause = CHECKPOINT_TICKS;
+                while ((end = RunAction(ACTIONS[ai], ix, iy, iso, c, lands, r, &reach, &bound, pause)) ==
+                       RunEnd::PAUSED) {
+                    add_checkpoint(c, r, reach);
+                    pause += CHECKPOINT_TICKS;
+                }
+                if (end == RunEnd::DONE) {
+                    e.complete    = 1;
+                    e.reached_end = r.reached_end ? 1 : 0;
+                    e.ticks       = static_cast<uint16_t>(r.ticks);
+                    e.box         = to_box(reach);
+                } else if (checkpoints.size() == e.checkpoint || checkpoints.back().ticks != c.tick) {
+                    add_checkpoint(c, r, reach);   // the seam
+                }
+                e.checkpoints = static_cast<uint16_t>(checkpoints.size() - e.checkpoint);
+                e.first = static_cast<uint32_t>(landings.size() / 2);
+                e.count = static_cast<uint16_t>(r.count);
+                for (auto [gx, gy] : lands) {
+                    landings.push_back(static_cast<int16_t>(gx - m));
+                    landings.push_back(static_cast<int16_t>(gy - m));
+                }
+                edges.push_back(e);
+            }
+        }
+
+    TraversalHeader hdr{};
+    hdr.stamp            = TraversalStamp();
+    hdr.width            = static_cast<uint16_t>(w);
+    hdr.height           = static_cast<uint16_t>(h);
+    hdr.edge_count       = static_cast<uint32_t>(edges.size());
+    hdr.checkpoint_count = static_cast<uint32_t>(checkpoints.size());
+    hdr.landing_count    = static_cast<uint32_t>(landings.size() / 2);
+    auto put = [&out](const void* p, size_t n) {
+        out.insert(out.end(), static_cast<const uint8_t*>(p), static_cast<const uint8_t*>(p) + n);
+    };
+    put(&hdr, sizeof(hdr));
+    put(node.data(), node.size() * sizeof(int32_t));
+    put(edges.data(), edges.size() * sizeof(TraversalEdge));
+    put(checkpoints.data(), checkpoints.size() * sizeof(TraversalCheckpoint));
+    put(cursors.data(), cursors.size() * sizeof(SimCursor));
+    put(landings.data(), landings.size() * sizeof(int16_t));
+    return true;
+}
+
+// A baked summary read in place from the mapping. Offsets inside the blob are trusted
+// like the pack's tile data (the bake wrote them); Open checks the header and the size.
+class ChunkTraversal {
+public:
+    // false if the chunk has no summary or it was baked by a different build.
+    bool Open(const Chunk& chunk) {
+        if (!chunk.traversal || chunk.traversal_size < sizeof(TraversalHeader)) return false;
+        TraversalHeader hdr;
+        std::memcpy(&hdr, chunk.traversal, sizeof(hdr));
+        if (hdr.stamp != TraversalStamp() || hdr.width != chunk.width || hdr.height != chunk.height)
+            return false;
+        const size_t nodes   = size_t{hdr.width} * hdr.height * sizeof(int32_t);
+        const size_t edges   = size_t{hdr.edge_count} * sizeof(TraversalEdge);
+        const size_t points  = size_t{hdr.checkpoint_count} * sizeof(TraversalCheckpoint);
+        const size_t cursors = size_t{hdr.checkpoint_count} * sizeof(SimCursor);
+        const size_t lands   = size_t{hdr.landing_count} * 2 * sizeof(int16_t);
+        if (sizeof(hdr) + nodes + edges + points + cursors + lands != chunk.traversal_size)
+            return false;
+        width        = hdr.width;
+        height       = hdr.height;
+        node_        = chunk.traversal + sizeof(hdr);
+        edges_       = node_ + nodes;
+        checkpoints_ = edges_ + edges;
+        cursors_     = checkpoints_ + points;
+        landings_    = cursors_ + cursors;
+        return true;
+    }
+
+    int width = 0, height = 0;
+
+    int32_t Node(int x, int y) const { return Load<int32_t>(node_, static_cast<size_t>(y) * width + x); }
+    TraversalEdge       Edge(uint32_t i)       const { return Load<TraversalEdge>(edges_, i); }
+    TraversalCheckpoint Checkpoint(uint32_t i) const { return Load<TraversalCheckpoint>(checkpoints_, i); }
+    SimCursor           Cursor(uint32_t i)     const { return Load<SimCursor>(cursors_, i); }
+    std::pair<int, int> Landing(uint32_t i) const {
+        return { Load<int16_t>(landings_, 2 * size_t{i}), Load<int16_t>(landings_, 2 * size_t{i} + 1) };
+    }
+
+private:
+    template <typename T>
+    static T Load(const uint8_t* base, size_t i) {
+        T v;
+        std::memcpy(&v, base + i * sizeof(T), sizeof(T));
+        return v;
+    }
+
+    const uint8_t* node_        = nullptr;
+    const uint8_t* edges_       = nullptr;
+    const uint8_t* checkpoints_ = nullptr;
+    const uint8_t* cursors_     = nullptr;
+    const uint8_t* landings_    = nullptr;
+};
+
+// A placed chunk as the validator sees it: where it landed in the world and which of its
+// tiles still read as the chunk's own.
+struct PlacedTraversal {
+    ChunkTraversal t;
+    int ox = 0, oy = 0;            // world tile of chunk (0, 0)
+    std::vector<int> dirty;        // (w+1)*(h+1) prefix sums of tiles that differ
+
+    bool Contains(int tx, int ty) const {
+        return tx >= ox && ty >= oy && tx < ox + t.width && ty < oy + t.height;
+    }
+    // No differing tile in the (chunk coordinate) box.
+    bool Clean(const TraversalBox& b) const {
+        const int s = t.width + 1;
+        return dirty[(b.max_y + 1) * s + b.max_x + 1] - dirty[b.min_y * s + b.max_x + 1]
+             - dirty[(b.max_y + 1) * s + b.min_x]     + dirty[b.min_y * s + b.min_x] == 0;
+    }
+};
+
+// Fill placed[0 .. n) with the placements whose chunk has a usable summary and return n.
+// Entries past n keep their buffers for the next level.
+static size_t PlaceTraversals(const World& world, const ChunkStore& store,
+                              const LevelRecipe& recipe, std::vector<PlacedTraversal>& placed) {
+    size_t n  = 0;
+    int    dx = 0, dy = 0;
+    if (!LevelGenerator::PlacementOrigin(store, recipe.placements, dx, dy)) return 0;
+    for (const ChunkPlacement& p : recipe.placements) {
+        const Chunk* c = store.ChunkById(p.chunk_id);
+        if (!c) continue;
+        if (n == placed.size()) placed.emplace_back();
+        PlacedTraversal& pt = placed[n];
+        if (!pt.t.Open(*c)) continue;
+        ++n;
+        pt.ox = p.x + dx;
+        pt.oy = p.y + dy;
+        const int w = c->width, h = c->height, s = w + 1;
+        pt.dirty.assign(static_cast<size_t>(s) * (h + 1), 0);
+        for (int y = 0; y < h; ++y)
+            for (int x = 0; x < w; ++x) {
+                const int  wx = pt.ox + x, wy = pt.oy + y;
+                const char ch = c->Tile(x, y);
+                const char own = (ch == 'I' || ch == 'O') ? ' ' : ch;
+                const bool differs = wx < 0 || wy < 0 ||
+                                     wx >= world.GetWidth() || wy >= world.GetHeight() ||
+                                     world.GetTile(wx, wy) != own;
+                pt.dirty[(y + 1) * s + x + 1] = pt.dirty[y * s + x + 1] + pt.dirty[(y + 1) * s + x]
+                                              - pt.dirty[y * s + x] + (differs ? 1 : 0);
+            }
+    }
+    return n;
+}
+
+// Placed chunks consulted per BFS node (chunk rectangles overlap a few deep at seams).
+static constexpr int MAX_OWNERS = 8;
+
+struct ActionOutcome {
+    enum Source : uint8_t { SUMMARIZED, RESUMED, SIMULATED };
+    Source    source = SIMULATED;
+    SimResult result;
+};
+
+// ============================================================================
+// ValidatorScratch — per-thread memory reused from level to level
 // ============================================================================
+//
+// Every buffer keeps its capacity between calls, so once a thread has validated a
+// level as large as the current one, Validate makes no heap allocation.
+
+struct ValidatorScratch {
+    // --- BFS (the thread that called Validate; pool threads only fill their nodes' slots) ---
+    std::vector<uint64_t>            visited;       // bitmap, see VisitedTiles
+    std::vector<std::pair<int, int>> outside;       // queued tiles beyond the bitmap
+    std::vector<std::pair<int, int>> current, next; // BFS layers
+    std::vector<ActionOutcome>       outcomes;      // NUM_ACTIONS per node of `current`
+    // Ground tiles found from each node of `current`, filled by whichever thread expands
+    // it. High-water mark: only the first current.size() are live.
+    std::vector<Landings>            node_landings;
+    std::vector<PlacedTraversal>     placed;        // high-water mark: only a prefix is live
+
+    // --- Best-first search (the thread that called Validate) ---
+    std::vector<int32_t>                 dist;      // tiles to the nearest 'E', see DistanceToExit
+    std::vector<std::pair<int, int>>     flood;     // flood-fill queue
+    std::vector<SearchState>             nodes;     // every state queued, by sequence number
+    std::vector<std::pair<int32_t, uint32_t>> open; // heap of (distance, sequence)
+    std::vector<SearchState>             found;     // branch points of the current run
+    Landings                             landings;  // ground tiles of the current run
+};
+
+static thread_local ValidatorScratch t_scratch;
+
+// ============================================================================
+// Node expansion — the 17 actions from one ground tile
+// ============================================================================
+
+// Run every action from (tx, ty) into out[0 .. NUM_ACTIONS), their ground tiles into
+// `landings`. Reads only world and the summaries: safe to call from several threads at once.
+static void ExpandNode(const World& world, const PlacedTraversal* placed, size_t n_placed,
+                       int tx, int ty, Landings& landings, ActionOutcome* out) {
+    landings.clear();
+
+    // Summary nodes of every placed chunk that has one for this tile: overlapping
+    // chunks change each other's tiles, so each action takes the first edge that is clean
+    // as a whole, else the clean checkpoint that got furthest.
+    const PlacedTraversal* owners[MAX_OWNERS];
+    int32_t                nodes[MAX_OWNERS];
+    int                    n_owners = 0;
+    for (size_t i = 0; i < n_placed && n_owners < MAX_OWNERS; ++i) {
+        const PlacedTraversal& p = placed[i];
+        if (!p.Contains(tx, ty)) continue;
+        const int32_t n = p.t.Node(tx - p.ox, ty - p.oy);
+        if (n < 0) continue;
+        owners[n_owners] = &p;
+        nodes[n_owners++] = n;
+    }
+
+    for (int ai = 0; ai < NUM_ACTIONS; ++ai) {
+        const PlacedTraversal* pt = nullptr;
+        TraversalEdge          e;
+        uint32_t               resume = 0;   // checkpoint index, pt set and e incomplete
+        TraversalCheckpoint    cp;
+        for (int o = 0; o < n_owners; ++o) {
+            const ChunkTraversal& t    = owners[o]->t;
+            const TraversalEdge   cand = t.Edge(static_cast<uint32_t>(nodes[o] + ai));
+            if (cand.complete && owners[o]->Clean(cand.box)) {
+                pt = owners[o];
+                e  = cand;
+                break;
+            }
+            // Latest clean checkpoint; boxes only grow, so stop at the first clean one.
+            for (uint32_t k = cand.checkpoints; k-- > 0;) {
+                const TraversalCheckpoint c = t.Checkpoint(cand.checkpoint + k);
+                if (pt && c.ticks <= cp.ticks) break;
+                if (!owners[o]->Clean(c.box)) continue;
+                pt     = owners[o];
+                e      = cand;
+                e.complete = 0;
+                resume = cand.checkpoint + k;
+                cp     = c;
+                break;
+            }
+        }
+
+        ActionOutcome& o      = out[ai];
+        SimResult&     result = o.result;
+        if (pt) {
+            const uint32_t count = e.complete ? e.count : cp.count;
+            result             = SimResult{};
+            result.first       = static_cast<uint32_t>(landings.size());
+            result.count       = count;
+            for (uint32_t i = e.first; i < e.first + count; ++i) {
+                const auto [lx, ly] = pt->t.Landing(i);
+                landings.push_back({ pt->ox + lx, pt->oy + ly });
+            }
+            if (e.complete) {
+                o.source           = ActionOutcome::SUMMARIZED;
+                result.summarized  = e.ticks;
+                result.reached_end = e.reached_end != 0;
+            } else {
+                // Continue the stored run in the real level from the checkpoint.
+                o.source          = ActionOutcome::RESUMED;
+                result.summarized = cp.ticks;
+                SimCursor   c  = pt->t.Cursor(resume);
+                PlayerState ps = c.player.GetState();
+                const float sx = static_cast<float>(pt->ox * TILE_SIZE);
+                const float sy = static_cast<float>(pt->oy * TILE_SIZE);
+                ps.x += sx;
+                ps.y += sy;
+                c.player.SetState(ps);
+                c.last_x += sx;
+                c.last_y += sy;
+                RunAction(ACTIONS[ai], tx, ty, world, c, landings, result);
+            }
+        } else {
+            o.source = ActionOutcome::SIMULATED;
+            result   = SimulateAction(ACTIONS[ai], tx, ty, world, landings);
+        }
+    }
+}
+
+// Keys already queued in this validation: `per_tile` bits per tile of the map plus a
+// margin (a key is a tile and a sub-state below per_tile), a short list for anything
+// beyond (landings stay inside the solid border in practice). Both live in the scratch;
+// clearing the bits is a memset of w*h*per_tile/8 bytes.
+class VisitedTiles {
+public:
+    VisitedTiles(const World& world, ValidatorScratch& s, int per_tile = 1)
+        : s_(s), w_(world.GetWidth() + 2 * MARGIN), h_(world.GetHeight() + 2 * MARGIN),
+          per_tile_(per_tile) {
+        s_.visited.assign((static_cast<size_t>(w_) * h_ * per_tile_ + 63) / 64, 0);
+        s_.outside.clear();
+    }
+
+    // true if (tx, ty, sub) was not visited yet (and now is).
+    bool Insert(int tx, int ty, int sub = 0) {
+        const int x = tx + MARGIN, y = ty + MARGIN;
+        if (x >= 0 && y >= 0 && x < w_ && y < h_) {
+            const size_t   i   = (static_cast<size_t>(y) * w_ + x) * per_tile_ + sub;
+            const uint64_t bit = uint64_t{1} << (i & 63);
+            if (s_.visited[i >> 6] & bit) return false;
+            s_.visited[i >> 6] |= bit;
+        } else {
+            const std::pair<int, int> t{tx, ty * per_tile_ + sub};
+            if (std::find(s_.outside.begin(), s_.outside.end(), t) != s_.outside.end()) return false;
+            s_.outside.push_back(t);
+        }
+        ++count_;
+        return true;
+    }
+    size_t Count() const { return count_; }
+
+private:
+    static constexpr int MARGIN = 2;
+    ValidatorScratch& s_;
+    int               w_, h_, per_tile_;
+    size_t            count_ = 0;
+};
+
+using Clock  = std::chrono::steady_clock;
+using Result = LevelValidator::Result;
 
-bool LevelValidator::Validate(const World& world) {
+// Whether the search has run out of Options::max_ticks. Checked only at points that do
+// not depend on thread timing (between BFS layers, before each best-first node), so the
+// outcome follows from the level alone. Summarized ticks count: a full simulation would
+// have run them.
+static bool TicksSpent(const LevelValidator::Options& opts, const LevelValidator::Stats& stats) {
+    return opts.max_ticks > 0 && stats.simulated_ticks + stats.summarized_ticks >= opts.max_ticks;
+}
+
+// Why a search must stop before its verdict, nullptr to keep going. Both conditions stay
+// true once they hold (the flag is never cleared, time only moves forward).
+static const char* StopReason(const LevelValidator::Options& opts) {
+    if (opts.cancel && opts.cancel->load(std::memory_order_relaxed)) return "cancelled";
+    if (opts.deadline != Clock::time_point::max() && Clock::now() >= opts.deadline)
+        return "deadline passed";
+    return nullptr;
+}
+
+// Spawn tile of `world`, false (and a log line) if it has no spawn or no 'E' tile.
+static bool FindStart(const World& world, int& spawn_tx, int& spawn_ty) {
     // --- Find spawn ---
     const SpawnPos spawn = FindCenterSpawn(world);
-    const int spawn_tx = static_cast<int>(spawn.x) / TILE_SIZE;
-    const int spawn_ty = static_cast<int>(spawn.y) / TILE_SIZE;
+    spawn_tx = static_cast<int>(spawn.x) / TILE_SIZE;
+    spawn_ty = static_cast<int>(spawn.y) / TILE_SIZE;
     if (spawn.x == 0.f && spawn.y == 0.f) {
         printf("[LevelValidator] ERROR: no spawn found\n");
         return false;
@@ -250,45 +838,274 @@ bool LevelValidator::Validate(const World& world) {
         printf("[LevelValidator] ERROR: no 'E' tile found\n");
         return false;
     }
+    return true;
+}
+
+// ============================================================================
+// LevelValidator::Validate — BFS over ground tile positions
+// ============================================================================
+//
+// Level-synchronous: each layer (the nodes found while expanding the previous one, in
+// discovery order) is expanded in parallel, then merged on this thread in layer order.
+// The merge replays exactly what the serial FIFO did: same expansion count, same first
+// node and action to reach 'E', same MAX_BFS_NODES cut-off. A stop request (cancel or
+// deadline) seen during a layer drops the whole layer: the result is UNDECIDED.
+
+// One layer handed to the pool. The job is captured by pointer so the std::function
+// stays in its small buffer (no allocation per layer).
+struct LayerJob {
+    const World*               world;
+    const PlacedTraversal*     placed;
+    size_t                     n_placed;
+    const std::pair<int, int>* nodes;
+    Landings*                  landings;
+    ActionOutcome*             out;
+    const LevelValidator::Options* opts;
+    std::atomic<bool>*             stopped;   // set by the first thread that sees StopReason
+
+    void operator()(size_t i) const {
+        if (stopped->load(std::memory_order_relaxed)) return;
+        if (StopReason(*opts)) {
+            stopped->store(true, std::memory_order_relaxed);
+            return;
+        }
+        ExpandNode(*world, placed, n_placed, nodes[i].first, nodes[i].second, landings[i],
+                   out + i * NUM_ACTIONS);
+    }
+};
+
+static Result RunValidation(const World& world, ValidatorScratch& s, size_t n_placed,
+                            const LevelValidator::Options& opts, LevelValidator::Stats& stats) {
+    int spawn_tx = 0, spawn_ty = 0;
+    if (!FindStart(world, spawn_tx, spawn_ty)) return Result::INVALID;
 
     // --- BFS ---
-    auto key = [](int tx, int ty) -> int64_t {
-        return (static_cast<int64_t>(ty) << 32) | static_cast<uint32_t>(tx);
+    VisitedTiles visited(world, s);
+    s.current.clear();
+    visited.Insert(spawn_tx, spawn_ty);
+    s.current.push_back({spawn_tx, spawn_ty});
+
+    int& expansions = stats.expansions;
+    int  counts[3]  = {};   // actions per ActionOutcome::Source
+    int  layers     = 0;
+    size_t threads = 1;   // most threads any layer ran on
+
+    auto report = [&](const char* verdict) {
+        printf("[LevelValidator] %s (%d actions from %zu chunk summaries, %d resumed at seams,"
+               " %d simulated; %lld ticks simulated, %lld summarized; %d layers on %zu thread(s))\n",
+               verdict, counts[ActionOutcome::SUMMARIZED], n_placed, counts[ActionOutcome::RESUMED],
+               counts[ActionOutcome::SIMULATED], static_cast<long long>(stats.simulated_ticks),
+               static_cast<long long>(stats.summarized_ticks), layers, threads);
     };
+    char   verdict[96];
+    size_t cut = 0;   // nodes of the last layer left out by MAX_BFS_NODES
+
+    while (!s.current.empty() && expansions < MAX_BFS_NODES && !TicksSpent(opts, stats)) {
+        // Nodes past the budget are never expanded serially: do not compute them either.
+        const size_t n = std::min(s.current.size(), static_cast<size_t>(MAX_BFS_NODES - expansions));
+        s.outcomes.resize(n * NUM_ACTIONS);
+        if (s.node_landings.size() < n) s.node_landings.resize(n);
+        std::atomic<bool> stopped{false};
+        const LayerJob job{ &world, s.placed.data(), n_placed, s.current.data(),
+                            s.node_landings.data(), s.outcomes.data(), &opts, &stopped };
+        if (opts.pool && n > 1)
+            threads = std::max(threads, opts.pool->ParallelFor(n, [j = &job](size_t i) { (*j)(i); }));
+        else for (size_t i = 0; i < n && !stopped.load(std::memory_order_relaxed); ++i) job(i);
 
-    std::unordered_set<int64_t> visited;
-    std::queue<std::pair<int, int>> frontier;
+        if (stopped.load(std::memory_order_relaxed)) {
+            stats.visited = visited.Count();
+            stats.pending = s.current.size();
+            std::snprintf(verdict, sizeof(verdict), "UNDECIDED — %s after %d BFS expansions",
+                          StopReason(opts), expansions);
+            report(verdict);
+            return Result::UNDECIDED;
+        }
+        ++layers;
+        cut = s.current.size() - n;
 
-    visited.insert(key(spawn_tx, spawn_ty));
-    frontier.push({spawn_tx, spawn_ty});
+        s.next.clear();
+        for (size_t i = 0; i < n; ++i) {
+            ++expansions;
+            const Landings& landings = s.node_landings[i];
+            for (int ai = 0; ai < NUM_ACTIONS; ++ai) {
+                const ActionOutcome& o = s.outcomes[i * NUM_ACTIONS + ai];
+                const SimResult&     r = o.result;
+                counts[o.source]++;
+                stats.simulated_ticks  += r.ticks;
+                stats.summarized_ticks += r.summarized;
+                if (r.reached_end) {
+                    stats.visited = visited.Count();
+                    std::snprintf(verdict, sizeof(verdict),
+                                  "VALID — reached 'E' after %d BFS expansions", expansions);
+                    report(verdict);
+                    return Result::VALID;
+                }
+                for (uint32_t k = r.first; k < r.first + r.count; ++k) {
+                    const auto [gtx, gty] = landings[k];
+                    if (visited.Insert(gtx, gty))
+                        s.next.push_back({gtx, gty});
+                }
+            }
+        }
+        s.current.swap(s.next);
+    }
 
-    int expansions = 0;
+    stats.visited = visited.Count();
+    stats.pending = s.current.size() + cut;
+    if (stats.pending > 0) {
+        std::snprintf(verdict, sizeof(verdict), "UNDECIDED — %s budget spent after %d BFS expansions",
+                      TicksSpent(opts, stats) ? "tick" : "node", expansions);
+        report(verdict);
+        return Result::UNDECIDED;
+    }
+    std::snprintf(verdict, sizeof(verdict), "INVALID — exhausted %d BFS nodes, %zu tiles visited",
+                  expansions, visited.Count());
+    report(verdict);
+    return Result::INVALID;
+}
 
-    while (!frontier.empty() && expansions < MAX_BFS_NODES) {
-        auto [tx, ty] = frontier.front();
-        frontier.pop();
-        ++expansions;
+// ============================================================================
+// Best-first search over player states
+// ============================================================================
+//
+// Nodes are SearchStates instead of tile-aligned standing starts: every action runs from
+// the state the player actually reached (momentum, jump latch, dash charge), and runs
+// branch mid-air too, so jump-then-dash and wall chains become reachable. The open node
+// with the fewest tiles to an 'E' goes first (ties: queued first). Serial: the pool and
+// chunk summaries (which assume standing starts) are not used.
 
-        for (int ai = 0; ai < NUM_ACTIONS; ++ai) {
-            SimResult result = SimulateAction(ACTIONS[ai], tx, ty, world);
+static constexpr int32_t NO_PATH = INT32_MAX;
 
-            if (result.reached_end) {
-                printf("[LevelValidator] VALID — reached 'E' after %d BFS expansions\n",
-                       expansions);
-                return true;
+// Tiles to the nearest 'E' through free tiles (4-neighbour flood fill from every 'E';
+// solid and kill tiles block). NO_PATH where the flood did not reach.
+static void DistanceToExit(const World& world, ValidatorScratch& s) {
+    const int w = world.GetWidth(), h = world.GetHeight();
+    s.dist.assign(static_cast<size_t>(w) * h, NO_PATH);
+    s.flood.clear();
+    for (int ty = 0; ty < h; ++ty)
+        for (int tx = 0; tx < w; ++tx)
+            if (world.GetClass(tx, ty) & TILE_EXIT) {
+                s.dist[static_cast<size_t>(ty) * w + tx] = 0;
+                s.flood.push_back({tx, ty});
             }
+    static constexpr int DX[4] = { 1, -1, 0, 0 }, DY[4] = { 0, 0, 1, -1 };
+    for (size_t head = 0; head < s.flood.size(); ++head) {
+        const auto [x, y] = s.flood[head];
+        const int32_t d   = s.dist[static_cast<size_t>(y) * w + x] + 1;
+        for (int k = 0; k < 4; ++k) {
+            const int nx = x + DX[k], ny = y + DY[k];
+            if (nx < 0 || ny < 0 || nx >= w || ny >= h) continue;
+            int32_t& nd = s.dist[static_cast<size_t>(ny) * w + nx];
+            if (nd != NO_PATH || (world.GetClass(nx, ny) & (TILE_SOLID | TILE_KILL))) continue;
+            nd = d;
+            s.flood.push_back({nx, ny});
+        }
+    }
+}
 
-            for (auto [gtx, gty] : result.ground_tiles) {
-                int64_t k = key(gtx, gty);
-                if (visited.find(k) == visited.end()) {
-                    visited.insert(k);
-                    frontier.push({gtx, gty});
-                }
+static Result RunBestFirst(const World& world, ValidatorScratch& s,
+                           const LevelValidator::Options& opts, LevelValidator::Stats& stats) {
+    int spawn_tx = 0, spawn_ty = 0;
+    if (!FindStart(world, spawn_tx, spawn_ty)) return Result::INVALID;
+
+    DistanceToExit(world, s);
+    const int w = world.GetWidth(), h = world.GetHeight();
+    auto distance = [&](int tx, int ty) {
+        return (tx < 0 || ty < 0 || tx >= w || ty >= h)
+             ? NO_PATH : s.dist[static_cast<size_t>(ty) * w + tx];
+    };
+    // std::push_heap keeps the largest first: "larger" = further, then queued later.
+    auto later = [](const std::pair<int32_t, uint32_t>& a, const std::pair<int32_t, uint32_t>& b) {
+        return a > b;
+    };
+
+    VisitedTiles visited(world, s, STATES_PER_TILE);
+    s.nodes.clear();
+    s.open.clear();
+    auto push = [&](const SearchState& st) {
+        if (!visited.Insert(st.tx, st.ty, st.sub)) return;
+        s.nodes.push_back(st);
+        s.open.push_back({ distance(st.tx, st.ty), static_cast<uint32_t>(s.nodes.size() - 1) });
+        std::push_heap(s.open.begin(), s.open.end(), later);
+    };
+    {
+        SearchState start;
+        start.player = StartCursor(spawn_tx, spawn_ty).player;
+        start.tx     = spawn_tx;
+        start.ty     = spawn_ty;
+        start.sub    = StateIndex(start.player.GetState());
+        push(start);
+    }
+
+    int& expansions = stats.expansions;
+    auto report = [&](const char* verdict) {
+        printf("[LevelValidator] %s (best-first: %lld ticks simulated, %zu states queued)\n",
+               verdict, static_cast<long long>(stats.simulated_ticks), visited.Count());
+    };
+    char verdict[96];
+
+    while (!s.open.empty() && expansions < MAX_BFS_NODES && !TicksSpent(opts, stats)) {
+        if (const char* why = StopReason(opts)) {
+            stats.visited = visited.Count();
+            stats.pending = s.open.size();
+            std::snprintf(verdict, sizeof(verdict), "UNDECIDED — %s after %d best-first expansions",
+                          why, expansions);
+            report(verdict);
+            return Result::UNDECIDED;
+        }
+        std::pop_heap(s.open.begin(), s.open.end(), later);
+        const SearchState node = s.nodes[s.open.back().second];   // copy: push() may reallocate
+        s.open.pop_back();
+        ++expansions;
+
+        for (int ai = 0; ai < NUM_ACTIONS; ++ai) {
+            SimCursor c;
+            c.player = node.player;
+            c.last_x = node.player.GetState().x;
+            c.last_y = node.player.GetState().y;
+            SimResult r;
+            r.first = static_cast<uint32_t>(s.landings.size());
+            s.found.clear();
+            RunAction(ACTIONS[ai], node.tx, node.ty, world, c, s.landings, r, nullptr, nullptr, -1, &s.found);
+            s.landings.resize(r.first);
+            stats.simulated_ticks += r.ticks;
+            if (r.reached_end) {
+                stats.visited = visited.Count();
+                std::snprintf(verdict, sizeof(verdict),
+                              "VALID — reached 'E' after %d best-first expansions", expansions);
+                report(verdict);
+                return Result::VALID;
             }
+            for (const SearchState& st : s.found) push(st);
         }
     }
 
-    printf("[LevelValidator] INVALID — exhausted %d BFS nodes, %zu tiles visited\n",
-           expansions, visited.size());
-    return false;
+    stats.visited = visited.Count();
+    stats.pending = s.open.size();
+    if (stats.pending > 0) {
+        std::snprintf(verdict, sizeof(verdict), "UNDECIDED — %s budget spent after %d best-first expansions",
+                      TicksSpent(opts, stats) ? "tick" : "node", expansions);
+        report(verdict);
+        return Result::UNDECIDED;
+    }
+    std::snprintf(verdict, sizeof(verdict), "INVALID — exhausted %d best-first nodes", expansions);
+    report(verdict);
+    return Result::INVALID;
+}
+
+LevelValidator::Result LevelValidator::Validate(const World& world, const Options& opts) {
+    const auto        t0 = Clock::now();
+    ValidatorScratch& s  = t_scratch;
+    Stats             stats;
+    Result            result;
+    if (opts.search == Search::BEST_FIRST) {
+        result = RunBestFirst(world, s, opts, stats);
+    } else {
+        const size_t n_placed = (opts.store && opts.recipe)
+                              ? PlaceTraversals(world, *opts.store, *opts.recipe, s.placed) : 0;
+        result = RunValidation(world, s, n_placed, opts, stats);
+    }
+    stats.wall_ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    if (opts.stats) *opts.stats = stats;
+    return result;
 }
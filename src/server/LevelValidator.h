@@ -1,14 +1,76 @@
 #pragma once
 // SRP: validates generated levels by simulating an AI agent through them.
 // Uses the real Player::Simulate physics to BFS over reachable tile positions.
-// Returns true if a path from spawn ('X') to end ('E') exists.
+// Reports whether a path from spawn ('X') to end ('E') exists, or that it could not tell
+// within the caller's deadline.
 // No ENet or Raylib dependency.
 
 #include "World.h"
+#include "ChunkStore.h"
+#include "LevelRecipe.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
 
 class LevelValidator {
 public:
-    // Returns true if the level has a viable path from spawn to any 'E' tile
-    // using the full game physics (jump, dash, wall-jump, dash-jump).
-    static bool Validate(const World& world);
+    enum class Result : uint8_t {
+        VALID,       // a path from spawn to an 'E' tile was found
+        INVALID,     // every reachable node was expanded without one (or no spawn / no 'E')
+        UNDECIDED,   // stopped first: cancel, deadline, max_ticks or the MAX_BFS_NODES budget
+    };
+
+    enum class Search : uint8_t {
+        BFS,          // FIFO over standing starts on ground tiles (generator default)
+        BEST_FIRST,   // over player states, nearest-to-'E' first; serial, no summaries
+    };
+
+    // Cost of one Validate call.
+    struct Stats {
+        int     expansions      = 0;   // nodes whose actions were run
+        int64_t simulated_ticks = 0;   // Player::Simulate calls
+        int64_t summarized_ticks = 0;  // ticks read from chunk summaries instead
+        size_t  visited         = 0;   // tiles (BFS) or state keys (best-first) queued
+        size_t  pending         = 0;   // queued but never expanded (UNDECIDED only)
+        double  wall_ms         = 0.0;
+    };
+
+    struct Options {
+        using TimePoint = std::chrono::steady_clock::time_point;
+
+        // Level generated from `store` with these placements: actions that stay inside one
+        // chunk whose tiles the level left untouched are read from the chunk's traversal
+        // summary (Chunk::traversal, baked into levels.pack); runs that cross a seam are
+        // resumed in the level from where the summary stopped. Chunks without a summary
+        // are simulated as before. Same result as without.
+        const ChunkStore*        store    = nullptr;
+        const LevelRecipe*       recipe   = nullptr;
+        // Polled before each node: once the flag is set or the deadline has passed, the
+        // search stops and returns UNDECIDED.
+        const std::atomic<bool>* cancel   = nullptr;
+        TimePoint                deadline = TimePoint::max();
+        // Ticks after which the search returns UNDECIDED (0 = no limit). Summarized ticks
+        // count as if simulated, so the outcome does not depend on which chunks have a
+        // summary. Unlike the deadline it does not depend on machine load: checked between
+        // BFS layers, so it may be overshot by one layer.
+        int64_t                  max_ticks = 0;
+        // Expand each BFS layer across the pool's threads (on the caller alone when another
+        // batch has the workers). Same result as without.
+        ThreadPool*              pool     = nullptr;
+        Search                   search   = Search::BFS;
+        Stats*                   stats    = nullptr;   // filled on return if set
+    };
+
+    // Whether the level has a viable path from spawn to any 'E' tile using the full
+    // game physics (jump, dash, wall-jump, dash-jump).
+    static Result Validate(const World& world, const Options& opts);
+    static Result Validate(const World& world) { return Validate(world, Options{}); }
+
+    // Traversal summary of `chunk` (tiles set) for Chunk::traversal: what each action does
+    // from each standable tile with the chunk alone in an empty map. Build time only
+    // (BakeLevelPack), ~1 ms per chunk. Cleared and false if the chunk is too large.
+    static bool SummarizeChunk(const Chunk& chunk, std::vector<uint8_t>& out);
 };
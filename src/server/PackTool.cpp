@@ -0,0 +1,11 @@
+// PackTool.cpp — entry point di build: compila assets/levels in levels.pack.
+// Uso: TileRace_PackTool [levels_dir] [out.pack], lanciato dalla cartella bin
+// (i path nel pack sono quelli che il gioco apre a runtime).
+
+#include "LevelPack.h"
+
+int main(int argc, char** argv) {
+    const char* levels_dir = argc > 1 ? argv[1] : "assets/levels";
+    const char* out_path   = argc > 2 ? argv[2] : LEVEL_PACK_PATH;
+    return BakeLevelPack(levels_dir, out_path) ? 0 : 1;
+}
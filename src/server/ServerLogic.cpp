@@ -1,17 +1,49 @@
 ﻿// ServerLogic.cpp — loop ENet autoritativo (TileRace_Server + LocalServer).
-// Responsabilità: creare l'host ENet, servire gli eventi, delegare a ServerSession.
+// Responsabilità: creare l'host ENet, servire gli eventi, instradarli alle stanze
+// (una ServerSession ciascuna) e far girare i tick delle stanze sul ThreadPool.
 // Tutta la logica di sessione vive in ServerSession.
 
 #include "ServerLogic.h"
 #include "ServerSession.h"
 #include "Protocol.h"
+#include "Physics.h"   // FIXED_DT
+#include "ThreadPool.h"
+#include "ChunkLibrary.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
 #include <cstdio>
 #include <cstring>
-#include <cctype>
+#include <memory>
+#include <vector>
 #include <enet/enet.h>
 
+// Massimo numero di tick recuperati in un singolo ciclo dopo un ritardo.
+static constexpr int MAX_CATCHUP_TICKS = 5;
+// Intervallo del report del tempo CPU per stanza (solo con più stanze).
+static constexpr uint32_t ROOM_REPORT_MS = 10'000u;
+
+namespace {
+
+// Una stanza = una ServerSession indipendente sullo stesso host ENet.
+// peer->data punta alla stanza del peer (nullptr = connessione rifiutata).
+struct Room {
+    int                            id = 0;
+    std::unique_ptr<ServerSession> session;
+    bool                           level_changed = false;  // in questo ciclo
+    double                         busy_ms       = 0.0;    // tempo di thread dall'ultimo report
+};
+
+using Clock = std::chrono::steady_clock;
+
+double MsSince(Clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+} // namespace
+
 void RunServer(uint16_t port, const char* map_path, std::atomic<bool>& stop_flag,
-               bool skip_lobby, GameMode initial_mode) {
+               bool skip_lobby, GameMode initial_mode, int max_rooms) {
     printf("[server] TileRace v%s  (protocol %u)\n", GAME_VERSION, PROTOCOL_VERSION);
 
     // Estrai il numero di livello iniziale dal nome del file
@@ -27,8 +59,32 @@ void RunServer(uint16_t port, const char* map_path, std::atomic<bool>& stop_flag
         }
     }
 
-    ServerSession session(map_path, initial_level, skip_lobby, initial_mode);
-    if (!session.IsReady()) {
+    // ENet limita i peer per host a ENET_PROTOCOL_MAXIMUM_PEER_ID.
+    const int room_limit = static_cast<int>(ENET_PROTOCOL_MAXIMUM_PEER_ID / MAX_CLIENTS);
+    max_rooms = std::clamp(max_rooms, 1, room_limit);
+
+    // Chunk caricati una sola volta per processo (anche tra più LocalServer), condivisi da
+    // tutte le stanze; ricaricati in background solo con TileRace_Server --hot-reload.
+    ChunkLibrary& chunk_library = ChunkLibrary::Shared();
+    if (!chunk_library.Current()->IsReady()) {
+        printf("[server] WARNING: no chunks loaded — level generation disabled\n");
+    }
+
+    std::vector<std::unique_ptr<Room>> rooms;
+    auto create_room = [&]() -> Room* {
+        auto room = std::make_unique<Room>();
+        room->id      = static_cast<int>(rooms.size());
+        room->session = std::make_unique<ServerSession>(
+            chunk_library, map_path, initial_level, skip_lobby, initial_mode);
+        if (!room->session->IsReady()) return nullptr;
+        rooms.push_back(std::move(room));
+        if (max_rooms > 1)
+            printf("[server] room %d aperta (%zu/%d)\n",
+                   rooms.back()->id, rooms.size(), max_rooms);
+        return rooms.back().get();
+    };
+
+    if (!create_room()) {
         fprintf(stderr, "[server] ERRORE: mappa non trovata: %s\n", map_path);
         return;
     }
@@ -36,9 +92,10 @@ void RunServer(uint16_t port, const char* map_path, std::atomic<bool>& stop_flag
     ENetAddress address{};
     address.host = ENET_HOST_ANY;
     address.port = port;
+    const size_t peer_count = static_cast<size_t>(max_rooms) * MAX_CLIENTS;
     ENetHost* server = enet_host_create(
         &address,
-        static_cast<size_t>(MAX_CLIENTS),
+        peer_count,
         static_cast<size_t>(CHANNEL_COUNT),
         0, 0);
     if (!server) {
@@ -46,25 +103,61 @@ void RunServer(uint16_t port, const char* map_path, std::atomic<bool>& stop_flag
                 "[server] ERRORE: enet_host_create fallita (porta %u occupata?)\n", port);
         return;
     }
-    printf("[server] in ascolto su UDP porta %u  (max %zu client)\n",
-           port, static_cast<size_t>(MAX_CLIENTS));
+
+    // I tick delle stanze girano in parallelo; con una sola stanza tutto resta inline.
+    ThreadPool pool(max_rooms > 1 ? ThreadPool::DefaultWorkers() : 0u);
+    printf("[server] in ascolto su UDP porta %u  (max %zu client, %d stanze, %zu thread)\n",
+           port, peer_count, max_rooms, pool.ThreadCount());
+
+    // Nuova connessione → prima stanza con posti liberi e lobby aperta,
+    // altrimenti una nuova stanza (fino a max_rooms).
+    auto route_connect = [&]() -> Room* {
+        for (auto& r : rooms)
+            if (r->session->CanAccept()) return r.get();
+        if (static_cast<int>(rooms.size()) < max_rooms) return create_room();
+        return nullptr;
+    };
+
+    // Tick a frequenza fissa: gli input vengono solo accodati durante il service,
+    // la simulazione avanza di un passo ogni FIXED_DT (accumulatore in ms).
+    const double tick_ms      = static_cast<double>(FIXED_DT) * 1000.0;
+    double       tick_acc_ms  = 0.0;
+    uint32_t     last_tick_ms = enet_time_get();
+    uint32_t     report_ms    = last_tick_ms;
 
     ENetEvent event;
     while (!stop_flag) {
-        // Servi tutti gli eventi disponibili in questo ciclo.
+        // Attendi eventi solo fino alla scadenza del prossimo tick.
+        const uint32_t wait_ms = (tick_acc_ms < tick_ms)
+            ? static_cast<uint32_t>(tick_ms - tick_acc_ms) : 0u;
+
+        // Servi tutti gli eventi disponibili in questo ciclo (thread ENet).
         // Se un handler restituisce true (cambio livello avvenuto), smetti
-        // di processare altri eventi questo ciclo per evitare stato inconsistente.
+        // di processare altri eventi questo ciclo per evitare stato inconsistente;
+        // quella stanza salta anche i tick di questo ciclo.
+        for (auto& r : rooms) r->level_changed = false;
         bool level_changed = false;
-        while (!level_changed && enet_host_service(server, &event, 16) > 0) {
+        int  rc = enet_host_service(server, &event, wait_ms);
+        while (!level_changed && rc > 0) {
+            Room* room = static_cast<Room*>(event.peer->data);
+            const Clock::time_point t0 = Clock::now();
             switch (event.type) {
 
             case ENET_EVENT_TYPE_CONNECT:
-                session.OnConnect(server, event.peer);
+                room = route_connect();
+                event.peer->data = room;
+                if (room) {
+                    room->session->OnConnect(server, event.peer);
+                } else {
+                    printf("[server] CONNECT rifiutato (tutte le stanze occupate) %08x:%u\n",
+                           event.peer->address.host, event.peer->address.port);
+                    enet_peer_disconnect(event.peer, DISCONNECT_SERVER_BUSY);
+                }
                 break;
 
             case ENET_EVENT_TYPE_RECEIVE:
-                if (event.packet->dataLength >= 1)
-                    level_changed = session.OnReceive(
+                if (room && event.packet->dataLength >= 1)
+                    level_changed = room->session->OnReceive(
                         server, event.peer,
                         event.packet->data,
                         event.packet->dataLength);
@@ -72,17 +165,63 @@ void RunServer(uint16_t port, const char* map_path, std::atomic<bool>& stop_flag
                 break;
 
             case ENET_EVENT_TYPE_DISCONNECT:
-                level_changed = session.OnDisconnect(server, event.peer);
+                if (room) level_changed = room->session->OnDisconnect(server, event.peer);
+                event.peer->data = nullptr;
                 break;
 
             default:
                 break;
             }
+            if (room) {
+                room->busy_ms      += MsSince(t0);
+                room->level_changed = room->level_changed || level_changed;
+            }
+            if (!level_changed) rc = enet_host_service(server, &event, 0);
+        }
+
+        // Passi di simulazione maturati. Dopo uno stallo lungo (es. host sovraccarico)
+        // il ritardo viene scartato invece di recuperarlo tutto insieme.
+        const uint32_t now_ms = enet_time_get();
+        tick_acc_ms += static_cast<double>(now_ms - last_tick_ms);
+        last_tick_ms = now_ms;
+        if (tick_acc_ms > tick_ms * MAX_CATCHUP_TICKS) tick_acc_ms = tick_ms;
+        int due_ticks = 0;
+        while (tick_acc_ms >= tick_ms) { tick_acc_ms -= tick_ms; ++due_ticks; }
+
+        // Tick delle stanze in parallelo. Ogni stanza tocca solo i propri peer
+        // (enet_peer_send); il flush dell'host avviene qui, dopo il batch.
+        if (due_ticks > 0) {
+            pool.ParallelFor(rooms.size(), [&](size_t i) {
+                Room& r = *rooms[i];
+                const Clock::time_point t0 = Clock::now();
+                for (int t = 0; t < due_ticks && !r.level_changed; ++t)
+                    r.level_changed = r.session->Tick(server);
+                r.busy_ms += MsSince(t0);
+            });
+        }
+
+        // Controllo timer (results timeout): eseguito una volta per ciclo, sul thread ENet
+        // (può disconnettere i peer a fine sessione).
+        for (auto& r : rooms) {
+            if (r->level_changed) continue;
+            const Clock::time_point t0 = Clock::now();
+            r->session->CheckTimers(server);
+            r->busy_ms += MsSince(t0);
         }
+        enet_host_flush(server);
 
-        // Controllo timer (results timeout): eseguito una volta per ciclo.
-        if (!level_changed)
-            session.CheckTimers(server);
+        // Report periodico del tempo CPU per stanza.
+        if (max_rooms > 1 && now_ms - report_ms >= ROOM_REPORT_MS) {
+            const double span_s = static_cast<double>(now_ms - report_ms) / 1000.0;
+            for (auto& r : rooms) {
+                if (r->session->PlayerCount() > 0 || r->busy_ms > 0.0)
+                    printf("[server] room %d: %zu player  cpu %.2f ms/s (%.2f%% core)\n",
+                           r->id, r->session->PlayerCount(),
+                           r->busy_ms / span_s, r->busy_ms / span_s / 10.0);
+                r->busy_ms = 0.0;
+            }
+            report_ms = now_ms;
+        }
     }
 
     enet_host_destroy(server);
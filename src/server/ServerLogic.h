@@ -7,5 +7,13 @@
 // Returns only when stop_flag is set to true.
 // When skip_lobby is true the server generates level 1 immediately (no lobby).
 // initial_mode sets the starting game mode (RACE for offline, VERSUS for online).
+// max_rooms > 1 hosts that many independent sessions (rooms) on the same port: a new
+// connection joins the first room whose lobby is open with a free slot, and a new room
+// is opened when none is. Room ticks run in parallel on a ThreadPool sized to the
+// core count; per-room CPU time is logged every 10 s.
 void RunServer(uint16_t port, const char* map_path, std::atomic<bool>& stop_flag,
-               bool skip_lobby = false, GameMode initial_mode = GameMode::VERSUS);
+               bool skip_lobby = false, GameMode initial_mode = GameMode::VERSUS,
+               int max_rooms = 1);
+
+// Rooms hosted by the dedicated server (TileRace_Server) unless overridden on the command line.
+static constexpr int DEFAULT_SERVER_ROOMS = 32;
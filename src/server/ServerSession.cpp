@@ -4,18 +4,50 @@
 #include "PlayerReset.h"  // SpawnReset, CheckpointReset
 #include "SpawnFinder.h"   // FindCenterCheckpoint
 #include "Physics.h"      // TILE_SIZE, FIXED_DT
+#include "WireCodec.h"    // DecodeInputPacket, QuantizePlayerState
+#include "LevelCodec.h"   // EncodeLevelGrid, EncodeLevelRegions
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <cstdio>
+#include <chrono>
 #include <cstring>
 #include <vector>
 
+// ---------------------------------------------------------------------------
+// SendPacket / BroadcastPacket — canale e affidabilità da RoutePacket (Protocol.h)
+// ---------------------------------------------------------------------------
+static ENetPacket* CreateRoutedPacket(const void* data, size_t size, uint8_t& channel) {
+    const PacketRoute route = RoutePacket(static_cast<const uint8_t*>(data)[0]);
+    enet_uint32 flags = 0;
+    if (route.delivery == Delivery::RELIABLE)    flags = ENET_PACKET_FLAG_RELIABLE;
+    if (route.delivery == Delivery::UNSEQUENCED) flags = ENET_PACKET_FLAG_UNSEQUENCED;
+    channel = route.channel;
+    return enet_packet_create(data, size, flags);
+}
+
+void ServerSession::SendPacket(ENetPeer* peer, const void* data, size_t size) {
+    uint8_t channel = 0;
+    ENetPacket* pkt = CreateRoutedPacket(data, size, channel);
+    enet_peer_send(peer, channel, pkt);
+}
+
+// The host may serve several rooms: only this session's peers receive the packet.
+void ServerSession::BroadcastPacket(ENetHost* /*host*/, const void* data, size_t size) {
+    uint8_t channel = 0;
+    ENetPacket* pkt = CreateRoutedPacket(data, size, channel);
+    for (auto& [peer, pl] : players_)
+        enet_peer_send(peer, channel, pkt);
+    if (pkt->referenceCount == 0) enet_packet_destroy(pkt);   // nessun destinatario
+}
+
 // ---------------------------------------------------------------------------
 // Costruttore
 // ---------------------------------------------------------------------------
-ServerSession::ServerSession(const char* initial_map_path, int initial_level,
-                             bool skip_lobby, GameMode initial_mode)
-    : initial_map_path_(initial_map_path ? initial_map_path : "")
+ServerSession::ServerSession(ChunkLibrary& chunks, const char* initial_map_path,
+                             int initial_level, bool skip_lobby, GameMode initial_mode)
+    : chunk_library_(chunks)
+    , initial_map_path_(initial_map_path ? initial_map_path : "")
     , initial_level_(initial_level)
     , current_level_([&]{ return (std::strstr(initial_map_path, "_Lobby") ||
                                   std::strstr(initial_map_path, "_lobby"))
@@ -25,20 +57,16 @@ ServerSession::ServerSession(const char* initial_map_path, int initial_level,
                                 std::strstr(initial_map_path, "_lobby")))
     , game_mode_(initial_mode)
 {
-    // Load all chunks from the chunks directory for procedural generation.
-    if (!chunk_store_.LoadFromDirectory("assets/levels/chunks")) {
-        printf("[server] WARNING: no chunks loaded — level generation disabled\n");
-    }
-
     // In skip_lobby mode, generate the first level immediately.
     // game_locked_ is set later in OnConnect (after the local client connects).
-    if (skip_lobby_ && chunk_store_.IsReady()) {
+    const auto store = chunk_library_.Current();
+    if (skip_lobby_ && store->IsReady()) {
         current_level_ = 1;
-        is_ready_      = level_mgr_.Generate(current_level_, chunk_store_, 0, skip_lobby_);
+        is_ready_      = level_mgr_.Generate(current_level_, *store, 0, skip_lobby_);
         if (is_ready_) {
             // Strip checkpoints for race and versus modes.
             if (game_mode_ == GameMode::RACE || game_mode_ == GameMode::VERSUS)
-                level_mgr_.GetWorldMut().StripCheckpoints();
+                level_mgr_.StripCheckpoints();
             printf("[server] skip_lobby: generated level 1 immediately (mode=%s)\n",
                    game_mode_ == GameMode::VERSUS ? "VERSUS" :
                    game_mode_ == GameMode::RACE   ? "RACE"   : "COOP");
@@ -84,17 +112,20 @@ void ServerSession::OnConnect(ENetHost* host, ENetPeer* peer) {
     PktWelcome welcome{};
     welcome.player_id     = ps.player_id;
     welcome.session_token = session_token_;
-    ENetPacket* wlc = enet_packet_create(&welcome, sizeof(welcome),
-                                          ENET_PACKET_FLAG_RELIABLE);
-    enet_peer_send(peer, CHANNEL_RELIABLE, wlc);
+    welcome.level_epoch   = level_epoch_;
+    SendPacket(peer, &welcome, sizeof(welcome));
     printf("[server] CONNECT player_id=%u  session=%u  %08x:%u\n",
            ps.player_id, session_token_,
            peer->address.host, peer->address.port);
 
     // In skip_lobby mode the level is already generated; lock the game and send it.
-    if (skip_lobby_ && !in_lobby_) {
+    // (During a generation the new level is broadcast to everyone on completion.)
+    if (skip_lobby_ && !in_lobby_ && !generating_) {
         game_locked_ = true;
         SendLevelDataToPeer(peer);
+        // The next PKT_LEVEL_COMMIT assumes the stage: late joiners get it too.
+        if (level_staged_)
+            SendLevel(PKT_LEVEL_STAGE, prepared_->level, prepared_key_.level, peer, true);
     }
 }
 
@@ -114,11 +145,16 @@ bool ServerSession::OnDisconnect(ENetHost* host, ENetPeer* peer) {
     }
 
     players_.erase(peer);
+    input_queues_.erase(peer);
+    input_next_tick_.erase(peer);
+    snapshot_acks_.erase(peer);
+    peer_chunk_hash_.erase(peer);
     best_ticks_.erase(peer);
     ready_peers_.erase(peer);
 
     // Leader promotion: if the leader disconnected, elect a new one.
     ElectLeader();
+    if (!players_.empty()) BroadcastRoster(host);
 
     // Se in results/global_results e tutti i rimanenti già pronti → transizione immediata.
     if ((in_results_ || in_global_results_) && !players_.empty() &&
@@ -143,6 +179,9 @@ bool ServerSession::OnDisconnect(ENetHost* host, ENetPeer* peer) {
         in_lobby_      = (initial_map_path_.find("_Lobby") != std::string::npos ||
                            initial_map_path_.find("_lobby") != std::string::npos);
         game_locked_   = false;
+        generating_    = false;
+        RetireGeneration();       // a running worker finishes in the background; Tick drops it
+        DropPreparedLevel();
         session_token_ = 0u;
         leader_id_     = 0;
         game_mode_     = GameMode::VERSUS;
@@ -166,14 +205,25 @@ bool ServerSession::OnReceive(ENetHost* host, ENetPeer* peer,
     if (len < 1) return false;
     const uint8_t type = data[0];
 
-    if (type == PKT_INPUT && len >= sizeof(PktInput)) {
-        PktInput pkt{};
-        std::memcpy(&pkt, data, sizeof(PktInput));
-        return HandleInput(host, peer, pkt);
+    if (type == PKT_INPUT) {
+        uint32_t   snapshot_ack = 0;
+        uint8_t    epoch        = 0;
+        InputFrame frames[INPUT_BUNDLE_MAX];
+        int        count        = 0;
+        if (!DecodeInputPacket(data, len, snapshot_ack, epoch, frames, count)) return false;
+        if (epoch != level_epoch_) return false;   // still in flight from the previous level
+        for (int i = 0; i < count; ++i) QueueInput(peer, frames[i]);
+        // Acks only move forward and never past the newest snapshot actually sent.
+        if (snapshot_ack <= snapshot_seq_) {
+            uint32_t& ack = snapshot_acks_[peer];
+            if (snapshot_ack > ack) ack = snapshot_ack;
+        }
+        return false;
     }
-    if (type == PKT_PLAYER_INFO && len >= sizeof(PktPlayerInfo)) {
+    if (type == PKT_PLAYER_INFO && len >= offsetof(PktPlayerInfo, chunk_hash)) {
+        // Older clients send a shorter struct: still read protocol_version to reject them.
         PktPlayerInfo pkt{};
-        std::memcpy(&pkt, data, sizeof(PktPlayerInfo));
+        std::memcpy(&pkt, data, std::min(len, sizeof(PktPlayerInfo)));
         HandlePlayerInfo(host, peer, pkt);
         return false;
     }
@@ -197,10 +247,7 @@ bool ServerSession::OnReceive(ENetHost* host, ENetPeer* peer,
             PktEmoteBroadcast bcast{};
             bcast.emote_id  = epkt.emote_id;
             bcast.player_id = it->second.GetState().player_id;
-            ENetPacket* pkt = enet_packet_create(&bcast, sizeof(bcast),
-                                                  ENET_PACKET_FLAG_RELIABLE);
-            enet_host_broadcast(host, CHANNEL_RELIABLE, pkt);
-            enet_host_flush(host);
+            BroadcastPacket(host, &bcast, sizeof(bcast));
         }
         return false;
     }
@@ -219,6 +266,16 @@ bool ServerSession::OnReceive(ENetHost* host, ENetPeer* peer,
     if (type == PKT_START_GAME && len >= sizeof(PktStartGame)) {
         return HandleStartGame(host, peer);
     }
+    if (type == PKT_LEVEL_REQUEST && len >= sizeof(PktLevelRequest)) {
+        PktLevelRequest req{};
+        std::memcpy(&req, data, sizeof(PktLevelRequest));
+        // Only the current level can be resent; a later level change sends its own data.
+        if (!generating_ && req.level == current_level_ && players_.count(peer)) {
+            printf("[server] PKT_LEVEL_REQUEST level=%u --> full grid\n", (unsigned)req.level);
+            SendLevel(PKT_LEVEL_DATA, level_mgr_, current_level_, peer, false);
+        }
+        return false;
+    }
     return false;
 }
 
@@ -241,26 +298,107 @@ void ServerSession::CheckTimers(ENetHost* host) {
 }
 
 // ---------------------------------------------------------------------------
-// HandleInput — simulazione fisica + finish/kill + broadcast + trigger cambio
+// QueueInput — accoda l'input del peer; consumato dal prossimo Tick()
+// ---------------------------------------------------------------------------
+void ServerSession::QueueInput(ENetPeer* peer, const InputFrame& frame) {
+    if (players_.find(peer) == players_.end()) return;
+    // Ogni pacchetto ripete i frame non confermati: accoda solo tick nuovi.
+    // Un salto in avanti (più di INPUT_BUNDLE_MAX frame persi) viene accettato.
+    auto nit = input_next_tick_.find(peer);
+    if (nit != input_next_tick_.end() && frame.tick < nit->second) return;
+    input_next_tick_[peer] = frame.tick + 1;
+    std::deque<InputFrame>& q = input_queues_[peer];
+    q.push_back(frame);
+    while (q.size() > INPUT_QUEUE_MAX) q.pop_front();
+}
+
+// ---------------------------------------------------------------------------
+// Tick — passo autoritativo a frequenza fissa (una volta per FIXED_DT)
 // ---------------------------------------------------------------------------
-bool ServerSession::HandleInput(ENetHost* host, ENetPeer* peer,
-                                 const PktInput& pkt) {
+bool ServerSession::Tick(ENetHost* host) {
+    ReapRetiredGenerations();
+    if (PollLevelGeneration(host)) return true;
+    if (players_.empty()) return false;
+    UpdatePregeneration(host);
+    // Generazione in corso: nessuna simulazione (il mondo sta per cambiare), ma il loop
+    // continua a servire ENet, quindi ping/ack non scadono.
+    if (generating_) {
+        input_queues_.clear();
+        return false;
+    }
+
+    // Deterministic simulation order: player_id, not hash-map iteration order.
+    std::vector<std::pair<uint32_t, ENetPeer*>> order;
+    order.reserve(players_.size());
+    for (const auto& [peer, pl] : players_)
+        order.push_back({pl.GetState().player_id, peer});
+    std::sort(order.begin(), order.end());
+
+    std::unordered_set<ENetPeer*> break_free;
+    for (const auto& [pid, peer] : order) {
+        auto qit = input_queues_.find(peer);
+        if (qit == input_queues_.end() || qit->second.empty()) continue;
+        std::deque<InputFrame>& q = qit->second;
+        // One frame per tick; a backlog (burst after jitter) drains at two per tick.
+        const int frames = (q.size() > INPUT_BACKLOG_FRAMES) ? 2 : 1;
+        for (int f = 0; f < frames && !q.empty(); ++f) {
+            const InputFrame frame = q.front();
+            q.pop_front();
+            SimulatePlayer(peer, frame, break_free);
+        }
+    }
+
+    const World& world = level_mgr_.GetWorld();
+    UpdateZone();
+    // Apply magnet grab/carry and player collisions — coop and versus modes.
+    if (game_mode_ == GameMode::COOP || game_mode_ == GameMode::VERSUS) {
+        ApplyMagnetGrab(break_free);
+        ResolvePlayerCollisions(world);
+    }
+    BroadcastGameState(host);
+
+    // --- Verifica scadenza timer zona ---
+    if (zone_start_ms_ != 0 && !players_.empty() &&
+        enet_time_get() - zone_start_ms_ >= NEXT_LEVEL_MS) {
+        zone_start_ms_ = 0;
+        if (in_lobby_) {
+            DoLevelChange(host);
+            return true;
+        }
+        if (!in_results_) {
+            SendResults(host, "zona");
+        }
+    }
+
+    // --- Verifica scadenza time limit (2 min) ---
+    if (!in_lobby_ && !in_results_ && !players_.empty() &&
+        enet_time_get() - level_start_ms_ >= LEVEL_TIME_LIMIT_MS) {
+        zone_start_ms_ = 0;
+        SendResults(host, "timeout");
+    }
+    return false;
+}
+
+// ---------------------------------------------------------------------------
+// SimulatePlayer — simulazione fisica di un frame + grab/finish/checkpoint/kill
+// ---------------------------------------------------------------------------
+void ServerSession::SimulatePlayer(ENetPeer* peer, const InputFrame& frame,
+                                   std::unordered_set<ENetPeer*>& break_free) {
     auto it = players_.find(peer);
-    if (it == players_.end()) return false;
+    if (it == players_.end()) return;
 
     const World& world = level_mgr_.GetWorld();
-    ENetPeer* break_free_peer = nullptr;
     bool consumed_dash_for_throw = false;
 
     // Co-op/versus: if a grabbed player presses jump/dash, release before simulation so
     // the same input frame can immediately trigger jump or dash.
     if (game_mode_ == GameMode::COOP || game_mode_ == GameMode::VERSUS) {
         const PlayerState& pre = it->second.GetState();
-        if (pre.grabbed && (pkt.frame.Has(BTN_JUMP_PRESS) || pkt.frame.Has(BTN_DASH))) {
+        if (pre.grabbed && (frame.Has(BTN_JUMP_PRESS) || frame.Has(BTN_DASH))) {
             for (auto& [grabber, grabbed_peer] : grab_targets_) {
                 if (grabbed_peer == peer) {
                     ReleaseGrab(grabber);
-                    break_free_peer = peer;
+                    break_free.insert(peer);
                     break;
                 }
             }
@@ -269,7 +407,7 @@ bool ServerSession::HandleInput(ENetHost* host, ENetPeer* peer,
 
     // Co-op/versus: if the grabber starts a new dash while holding a player, throw the grabbed
     // player in the direction of the dash, then release the grab.
-    if ((game_mode_ == GameMode::COOP || game_mode_ == GameMode::VERSUS) && pkt.frame.Has(BTN_DASH)) {
+    if ((game_mode_ == GameMode::COOP || game_mode_ == GameMode::VERSUS) && frame.Has(BTN_DASH)) {
         const PlayerState& pre = it->second.GetState();
         if (pre.dash_ready && pre.dash_cooldown_ticks == 0 && pre.dash_active_ticks == 0) {
             auto git = grab_targets_.find(peer);
@@ -277,8 +415,8 @@ bool ServerSession::HandleInput(ENetHost* host, ENetPeer* peer,
                 ENetPeer* thrown_peer = git->second;
 
                 // Compute normalised dash direction (mirrors RequestDash logic).
-                float ddx = pkt.frame.dash_dx;
-                float ddy = pkt.frame.dash_dy;
+                float ddx = frame.dash_dx;
+                float ddy = frame.dash_dy;
                 const float len2 = ddx * ddx + ddy * ddy;
                 if (len2 > 0.000001f) {
                     const float inv = 1.f / std::sqrt(len2);
@@ -315,15 +453,14 @@ bool ServerSession::HandleInput(ENetHost* host, ENetPeer* peer,
                 consumed_dash_for_throw = true;
 
                 // Prevent the thrown player from being immediately re-grabbed this tick.
-                if (break_free_peer == nullptr)
-                    break_free_peer = thrown_peer;
+                break_free.insert(thrown_peer);
             }
         }
     }
 
     // Finished players still run physics, but their gameplay input is ignored.
     // This keeps movement/collisions authoritative while preventing any new actions.
-    InputFrame sim_frame = pkt.frame;
+    InputFrame sim_frame = frame;
     // Grab-throw consumes dash input: only the grabbed player is launched.
     if (consumed_dash_for_throw)
         sim_frame.buttons = static_cast<uint16_t>(sim_frame.buttons & ~BTN_DASH);
@@ -337,6 +474,9 @@ bool ServerSession::HandleInput(ENetHost* host, ENetPeer* peer,
 
     PlayerState s = it->second.GetState();
 
+    // Classi di tile toccate dal player (E / C / K): una sola query per input.
+    uint8_t touched = world.QueryAABB(s.x, s.y, TILE_SIZE, TILE_SIZE);
+
     // --- Timer di livello + rilevamento tile 'E' (finish) ---
     if (!s.finished) {
         const bool can_play = (s.kill_respawn_ticks == 0 && s.respawn_grace_ticks == 0);
@@ -351,24 +491,17 @@ bool ServerSession::HandleInput(ENetHost* host, ENetPeer* peer,
             s.level_ticks++;
 
         // Finish detection remains tied to active gameplay (not during kill/grace).
-        if (can_play) {
-        const int tx0 = static_cast<int>(s.x)                    / TILE_SIZE;
-        const int ty0 = static_cast<int>(s.y)                    / TILE_SIZE;
-        const int tx1 = static_cast<int>(s.x + TILE_SIZE - 1.f)  / TILE_SIZE;
-        const int ty1 = static_cast<int>(s.y + TILE_SIZE - 1.f)  / TILE_SIZE;
-        if (world.GetTile(tx0, ty0) == 'E' || world.GetTile(tx1, ty0) == 'E' ||
-            world.GetTile(tx0, ty1) == 'E' || world.GetTile(tx1, ty1) == 'E') {
+        if (can_play && (touched & TILE_EXIT)) {
             s.finished = true;
             printf("[server] FINISH player_id=%u ticks=%u\n",
                    s.player_id, s.level_ticks);
             uint32_t& best = best_ticks_[peer];
             if (best == 0 || s.level_ticks < best) best = s.level_ticks;
         }
-        }
     }
 
     // --- Checkpoint tile 'C' (shared: activates for all players) — COOP only ---
-    if (game_mode_ == GameMode::COOP && !s.finished) {
+    if (game_mode_ == GameMode::COOP && !s.finished && (touched & TILE_CHECKPOINT)) {
         const int txc0 = static_cast<int>(s.x)                    / TILE_SIZE;
         const int tyc0 = static_cast<int>(s.y)                    / TILE_SIZE;
         const int txc1 = static_cast<int>(s.x + TILE_SIZE - 1.f)  / TILE_SIZE;
@@ -399,76 +532,42 @@ bool ServerSession::HandleInput(ENetHost* host, ENetPeer* peer,
                 }
                 printf("[server] SHARED CHECKPOINT player_id=%u activated (%.0f, %.0f) → reset all players\n",
                        s.player_id, cp.x, cp.y);
+                touched = world.QueryAABB(s.x, s.y, TILE_SIZE, TILE_SIZE);   // s was moved
             }
         }
     }
 
     // --- Kill tile 'K' ---
-    {
-        const int tx0k = static_cast<int>(s.x)                    / TILE_SIZE;
-        const int ty0k = static_cast<int>(s.y)                    / TILE_SIZE;
-        const int tx1k = static_cast<int>(s.x + TILE_SIZE - 1.f)  / TILE_SIZE;
-        const int ty1k = static_cast<int>(s.y + TILE_SIZE - 1.f)  / TILE_SIZE;
-        if (world.GetTile(tx0k, ty0k) == 'K' || world.GetTile(tx1k, ty0k) == 'K' ||
-            world.GetTile(tx0k, ty1k) == 'K' || world.GetTile(tx1k, ty1k) == 'K') {
-            // In versus mode, preserve the player's elapsed time (timer doesn't reset on respawn).
-            const uint32_t saved_ticks = (game_mode_ == GameMode::VERSUS) ? s.level_ticks : 0u;
-            // Respawn at last checkpoint if available, otherwise at spawn.
-            if (s.checkpoint_x != 0.f || s.checkpoint_y != 0.f)
-                s = CheckpointReset(s, s.checkpoint_x, s.checkpoint_y, true);
-            else
-                s = ApplySpawnReset(s, true);
-            if (game_mode_ == GameMode::VERSUS) s.level_ticks = saved_ticks;
-            printf("[server] KILL player_id=%u --> respawn in 1s\n", s.player_id);
-        }
+    if (touched & TILE_KILL) {
+        // In versus mode, preserve the player's elapsed time (timer doesn't reset on respawn).
+        const uint32_t saved_ticks = (game_mode_ == GameMode::VERSUS) ? s.level_ticks : 0u;
+        // Respawn at last checkpoint if available, otherwise at spawn.
+        if (s.checkpoint_x != 0.f || s.checkpoint_y != 0.f)
+            s = CheckpointReset(s, s.checkpoint_x, s.checkpoint_y, true);
+        else
+            s = ApplySpawnReset(s, true);
+        if (game_mode_ == GameMode::VERSUS) s.level_ticks = saved_ticks;
+        printf("[server] KILL player_id=%u --> respawn in 1s\n", s.player_id);
     }
 
     it->second.SetState(s);
-
-    UpdateZone();
-    // Apply magnet grab/carry and player collisions — coop and versus modes.
-    if (game_mode_ == GameMode::COOP || game_mode_ == GameMode::VERSUS) {
-        ApplyMagnetGrab(break_free_peer);
-        ResolvePlayerCollisions(world);
-    }
-    BroadcastGameState(host);
-
-    // --- Verifica scadenza timer zona ---
-    if (zone_start_ms_ != 0 && !players_.empty() &&
-        enet_time_get() - zone_start_ms_ >= NEXT_LEVEL_MS) {
-        zone_start_ms_ = 0;
-        if (in_lobby_) {
-            DoLevelChange(host);
-            return true;
-        }
-        if (!in_results_) {
-            SendResults(host, "zona");
-        }
-    }
-
-    // --- Verifica scadenza time limit (2 min) ---
-    if (!in_lobby_ && !in_results_ && !players_.empty() &&
-        enet_time_get() - level_start_ms_ >= LEVEL_TIME_LIMIT_MS) {
-        zone_start_ms_ = 0;
-        SendResults(host, "timeout");
-    }
-    return false;
 }
 
 // ---------------------------------------------------------------------------
 // HandlePlayerInfo — aggiorna nome + controllo protocollo
 // ---------------------------------------------------------------------------
-void ServerSession::HandlePlayerInfo(ENetHost* /*host*/, ENetPeer* peer,
+void ServerSession::HandlePlayerInfo(ENetHost* host, ENetPeer* peer,
                                       const PktPlayerInfo& info) {
     if (info.protocol_version != PROTOCOL_VERSION) {
         printf("[server] VERSION MISMATCH peer=%08x client=%u server=%u --> disconnesso\n",
                peer->address.host, info.protocol_version, PROTOCOL_VERSION);
         PktVersionMismatch vm{};
-        ENetPacket* vmpkt = enet_packet_create(&vm, sizeof(vm),
-                                                ENET_PACKET_FLAG_RELIABLE);
-        enet_peer_send(peer, CHANNEL_RELIABLE, vmpkt);
+        SendPacket(peer, &vm, sizeof(vm));
         enet_peer_disconnect(peer, DISCONNECT_VERSION_MISMATCH);
         players_.erase(peer);
+        input_queues_.erase(peer);
+        input_next_tick_.erase(peer);
+        snapshot_acks_.erase(peer);
         return;
     }
     auto it = players_.find(peer);
@@ -478,7 +577,11 @@ void ServerSession::HandlePlayerInfo(ENetHost* /*host*/, ENetPeer* peer,
         s.name[sizeof(s.name) - 1] = '\0';
         session_names_[s.player_id] = s.name;
         it->second.SetState(s);
-        printf("[server] PLAYER_INFO id=%u name='%s'\n", s.player_id, s.name);
+        peer_chunk_hash_[peer] = info.chunk_hash;
+        printf("[server] PLAYER_INFO id=%u name='%s' chunks=%s\n", s.player_id, s.name,
+               info.chunk_hash == chunk_library_.Current()->ContentHash() && info.chunk_hash != 0
+                   ? "match (recipe)" : "differ (full grid)");
+        BroadcastRoster(host);
     }
 }
 
@@ -655,6 +758,9 @@ void ServerSession::DoLevelChange(ENetHost* host) {
     in_results_ = false;
     ready_peers_.clear();
     best_ticks_.clear();
+    input_queues_.clear();   // inputs simulated against the previous level are stale
+    input_next_tick_.clear();  // client ticks restart from 0 on the new level
+    ++level_epoch_;
     activated_checkpoints_.clear();
     grab_targets_.clear();
     regrab_requires_release_.clear();
@@ -677,28 +783,153 @@ void ServerSession::DoLevelChange(ENetHost* host) {
         return;
     }
 
-    // Generate level from chunks (or fall back to file-based loading).
-    bool loaded = false;
-    if (chunk_store_.IsReady()) {
-        // Notify clients that generation is starting so they show a loading overlay
-        // and don't time out while the ENet loop is stalled.
+    // Livello già pronto (pre-generato durante il livello precedente): swap immediato.
+    // Altrimenti si attende il worker; Tick() continua a servire i peer nel frattempo.
+    if (chunk_library_.Current()->IsReady()) {
+        const LevelKey key = LevelKeyFor(current_level_);
+        if (prepared_ && prepared_key_ == key) {
+            printf("[server] level %d pre-generated%s --> instant swap\n",
+                   current_level_, level_staged_ ? " + staged on clients" : "");
+            InstallPreparedLevel(host);
+            return;
+        }
+        // Notify clients so they show a loading overlay until PKT_LEVEL_DATA.
         BroadcastGenerating(host);
-        // Co-op gets a steeper ramp: reach high difficulty earlier within the session.
-        const int curve_levels = (game_mode_ == GameMode::COOP)
-            ? static_cast<int>(session_max_levels_)
-            : DIFFICULTY_CURVE_LEVELS;
-        loaded = level_mgr_.Generate(current_level_, chunk_store_, 0, skip_lobby_, curve_levels);
+        if (!(generation_.valid() && generation_key_ == key)) {
+            DropPreparedLevel();
+            StartGeneration(key);
+        }
+        generating_          = true;
+        generation_start_ms_ = enet_time_get();
+        return;
     }
+    FinishLevelChange(host, false);
+}
+
+// ---------------------------------------------------------------------------
+// Pre-generazione del livello successivo
+// ---------------------------------------------------------------------------
+ServerSession::LevelKey ServerSession::LevelKeyFor(int level_num) const {
+    LevelKey k;
+    k.level = level_num;
+    // Co-op gets a steeper ramp: reach high difficulty earlier within the session.
+    k.curve_levels = (game_mode_ == GameMode::COOP)
+        ? static_cast<int>(session_max_levels_)
+        : DIFFICULTY_CURVE_LEVELS;
+    k.mode     = game_mode_;
+    k.validate = skip_lobby_;
+    // A reloaded chunk set invalidates whatever was prepared from the previous one.
+    k.chunk_hash = chunk_library_.Current()->ContentHash();
+    return k;
+}
+
+void ServerSession::StartGeneration(const LevelKey& key) {
+    RetireGeneration();   // stale worker: never joined on the tick thread
+    // The worker owns a reference to its snapshot: a swap meanwhile does not affect it.
+    std::shared_ptr<const ChunkStore> store = chunk_library_.Current();
+    generation_key_            = key;
+    generation_key_.chunk_hash = store->ContentHash();
+    generation_ = std::async(std::launch::async, [key, store = std::move(store)] {
+        GeneratedLevel out;
+        out.ok = out.level.Generate(key.level, *store, 0, key.validate, key.curve_levels);
+        // Race and versus modes: strip checkpoints here so a staged grid is final.
+        if (out.ok && (key.mode == GameMode::RACE || key.mode == GameMode::VERSUS))
+            out.level.StripCheckpoints();
+        return out;
+    });
+}
+
+// A stale worker cannot be cancelled: it is parked here and dropped by Tick once it
+// is done, so neither a reset nor a new generation waits for it.
+void ServerSession::RetireGeneration() {
+    if (generation_.valid()) retired_generations_.push_back(std::move(generation_));
+}
+
+void ServerSession::ReapRetiredGenerations() {
+    std::erase_if(retired_generations_, [](const std::future<GeneratedLevel>& f) {
+        return f.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    });
+}
+
+void ServerSession::DropPreparedLevel() {
+    prepared_.reset();
+    level_staged_ = false;
+}
+
+void ServerSession::UpdatePregeneration(ENetHost* host) {
+    if (!chunk_library_.Current()->IsReady() || generating_) return;
+
+    // Prossimo livello atteso con le impostazioni correnti (0 = nessuno: fine sessione).
+    const int next = in_lobby_ ? 1 : current_level_ + 1;
+    const bool want = next <= static_cast<int>(session_max_levels_);
+    const LevelKey key = LevelKeyFor(next);
+
+    // Modalità o numero di livelli cambiati dal leader: il livello preparato non vale più.
+    if (prepared_ && (!want || !(prepared_key_ == key))) {
+        printf("[server] pre-generated level %d invalidated (settings or chunk set changed)\n", prepared_key_.level);
+        DropPreparedLevel();
+    }
+
+    if (generation_.valid()) {
+        if (generation_.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return;
+        GeneratedLevel gen = generation_.get();
+        if (want && generation_key_ == key) {
+            prepared_     = std::move(gen);
+            prepared_key_ = generation_key_;
+            printf("[server] level %d pre-generated (%s)\n", key.level, prepared_->ok ? "ok" : "failed");
+        }
+    }
+    if (want && !prepared_ && !generation_.valid()) StartGeneration(key);
+
+    // Durante i risultati il livello pronto viene già trasferito ai client (CHANNEL_BULK):
+    // al cambio livello basta PKT_LEVEL_COMMIT.
+    if (in_results_ && prepared_ && prepared_->ok && !level_staged_) {
+        (void)host;
+        SendLevel(PKT_LEVEL_STAGE, prepared_->level, prepared_key_.level, nullptr, true);
+        level_staged_ = true;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// PollLevelGeneration — installa il livello generato dal worker (se pronto)
+// ---------------------------------------------------------------------------
+bool ServerSession::PollLevelGeneration(ENetHost* host) {
+    if (!generating_ || !generation_.valid()) return false;
+    if (generation_.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        return false;
+    prepared_     = generation_.get();
+    prepared_key_ = generation_key_;
+    level_staged_ = false;
+    generating_   = false;
+    printf("[server] generation level %d: %s in %u ms (ENet serviced meanwhile)\n",
+           current_level_, prepared_->ok ? "ok" : "failed", enet_time_get() - generation_start_ms_);
+    InstallPreparedLevel(host);
+    return true;
+}
+
+void ServerSession::InstallPreparedLevel(ENetHost* host) {
+    const bool ok     = prepared_->ok;
+    const bool staged = level_staged_;
+    if (ok) level_mgr_ = std::move(prepared_->level);
+    DropPreparedLevel();
+    FinishLevelChange(host, ok, staged);
+}
+
+// ---------------------------------------------------------------------------
+// FinishLevelChange — seconda metà di DoLevelChange, dopo la generazione
+// ---------------------------------------------------------------------------
+void ServerSession::FinishLevelChange(ENetHost* host, bool loaded, bool staged) {
     if (!loaded) {
         // Fallback: try file-based loading (legacy path).
         const std::string next_path = LevelManager::BuildPath(current_level_);
         loaded = level_mgr_.Load(next_path.c_str());
+        staged = false;
     }
 
     if (loaded) {
         // Race and versus modes: strip checkpoint tiles from the generated level.
         if (game_mode_ == GameMode::RACE || game_mode_ == GameMode::VERSUS)
-            level_mgr_.GetWorldMut().StripCheckpoints();
+            level_mgr_.StripCheckpoints();
 
         for (auto& [peer, pl] : players_) {
             // Full reset: clears dash/jump/movement state that was previously leaking
@@ -708,9 +939,17 @@ void ServerSession::DoLevelChange(ENetHost* host) {
             pl.ResetTransient();  // clear non-serialised edge-detection flags
         }
 
-        // Send the generated level data to all clients.
-        BroadcastLevelData(host);
-        printf("[server] LEVEL CHANGE --> generated level %d\n", current_level_);
+        // Clients already hold the staged grid: a few bytes switch them over.
+        if (staged) {
+            PktLevelCommit commit{};
+            commit.level = static_cast<uint8_t>(current_level_);
+            commit.epoch = level_epoch_;
+            BroadcastPacket(host, &commit, sizeof(commit));
+        } else {
+            BroadcastLevelData(host);
+        }
+        printf("[server] LEVEL CHANGE --> generated level %d%s\n",
+               current_level_, staged ? " (commit)" : "");
 
         zone_start_ms_  = 0;
         level_start_ms_ = enet_time_get();
@@ -730,6 +969,11 @@ void ServerSession::ResetToInitial(ENetHost* host) {
     for (auto& [peer, pl] : players_)
         enet_peer_disconnect_now(peer, 0);
     players_.clear();
+    input_queues_.clear();
+    input_next_tick_.clear();
+    snapshot_acks_.clear();
+    peer_chunk_hash_.clear();
+    level_epoch_ = 0;
 
     session_wins_.clear();
     session_names_.clear();
@@ -739,6 +983,8 @@ void ServerSession::ResetToInitial(ENetHost* host) {
     in_lobby_      = (initial_map_path_.find("_Lobby") != std::string::npos ||
                        initial_map_path_.find("_lobby") != std::string::npos);
     game_locked_   = false;
+    generating_    = false;
+    DropPreparedLevel();
     coop_cleared_levels_ = 0;
     session_token_ = 0u;
     leader_id_     = 0;
@@ -810,10 +1056,7 @@ void ServerSession::SendResults(ENetHost* host, const char* reason) {
     for (size_t i = 0; i < entries.size() && i < static_cast<size_t>(MAX_PLAYERS); i++)
         res_pkt.entries[i] = entries[i];
 
-    ENetPacket* resl = enet_packet_create(&res_pkt, sizeof(res_pkt),
-                                           ENET_PACKET_FLAG_RELIABLE);
-    enet_host_broadcast(host, CHANNEL_RELIABLE, resl);
-    enet_host_flush(host);
+    BroadcastPacket(host, &res_pkt, sizeof(res_pkt));
 
     in_results_       = true;
     results_start_ms_ = enet_time_get();
@@ -826,25 +1069,81 @@ void ServerSession::SendResults(ENetHost* host, const char* reason) {
 // BroadcastGameState
 // ---------------------------------------------------------------------------
 void ServerSession::BroadcastGameState(ENetHost* host) {
-    PktGameState gs_pkt{};
-    gs_pkt.state.count = 0;
+    (void)host;
+    GameState gs{};
+    gs.count = 0;
     for (auto& [peer, pl] : players_) {
-        if (gs_pkt.state.count < static_cast<uint32_t>(MAX_PLAYERS))
-            gs_pkt.state.players[gs_pkt.state.count++] = pl.GetState();
-    }
-    gs_pkt.state.next_level_countdown_ticks = CountdownTicks();
-    gs_pkt.state.is_lobby    = in_lobby_ ? 1u : 0u;
-    gs_pkt.state.game_mode   = static_cast<uint8_t>(game_mode_);
-    gs_pkt.state.max_generated_levels = session_max_levels_;
-    gs_pkt.state.leader_id   = leader_id_;
+        // Grab / collisions / resets run after Simulate: snap again so the authoritative
+        // state is exactly what clients decode.
+        PlayerState s = pl.GetState();
+        QuantizePlayerState(s);
+        pl.SetState(s);
+        if (gs.count < static_cast<uint32_t>(MAX_PLAYERS))
+            gs.players[gs.count++] = s;
+    }
+    // Stable slot order keeps consecutive snapshots byte-comparable.
+    std::sort(gs.players, gs.players + gs.count,
+              [](const PlayerState& a, const PlayerState& b) {
+                  return a.player_id < b.player_id;
+              });
+    gs.next_level_countdown_ticks = CountdownTicks();
+    gs.is_lobby    = in_lobby_ ? 1u : 0u;
+    gs.game_mode   = static_cast<uint8_t>(game_mode_);
+    gs.max_generated_levels = session_max_levels_;
+    gs.leader_id   = leader_id_;
+    gs.level_epoch = level_epoch_;
     if (!in_lobby_ && !in_results_) {
         const uint32_t el = enet_time_get() - level_start_ms_;
-        gs_pkt.state.time_limit_secs = el < LEVEL_TIME_LIMIT_MS
+        gs.time_limit_secs = el < LEVEL_TIME_LIMIT_MS
             ? (LEVEL_TIME_LIMIT_MS - el) / 1000u : 0u;
     }
-    ENetPacket* bcast = enet_packet_create(&gs_pkt, sizeof(gs_pkt), 0);
-    enet_host_broadcast(host, CHANNEL_RELIABLE, bcast);
-    enet_host_flush(host);
+
+    const uint32_t seq = ++snapshot_seq_;
+    snapshot_ring_[seq % SNAPSHOT_RING] = gs;
+
+    // One payload per peer: each client is diffed against the newest snapshot it acked.
+    // Missing or too-old acks fall back to a keyframe.
+    std::vector<uint8_t> buf;
+    for (auto& [peer, pl] : players_) {
+        const auto ait = snapshot_acks_.find(peer);
+        const uint32_t ack = (ait != snapshot_acks_.end()) ? ait->second : 0u;
+        const bool has_base = ack != 0 && seq - ack < SNAPSHOT_RING;
+
+        buf.clear();
+        EncodeSnapshot(seq, has_base ? ack : 0u,
+                       has_base ? &snapshot_ring_[ack % SNAPSHOT_RING] : nullptr, gs, buf);
+
+        snapshot_stats_.packets++;
+        snapshot_stats_.bytes += buf.size();
+        if (!has_base) snapshot_stats_.keyframes++;
+
+        SendPacket(peer, buf.data(), buf.size());
+    }
+
+    // Ogni ~10 s: dimensione media dei pacchetti rispetto allo struct GameState grezzo.
+    if (seq % 600 == 0 && snapshot_stats_.packets > 0) {
+        printf("[server] snapshot: %llu pkt  avg=%.1f B  keyframe=%.1f%%  (raw GameState %zu B)\n",
+               (unsigned long long)snapshot_stats_.packets,
+               (double)snapshot_stats_.bytes / (double)snapshot_stats_.packets,
+               100.0 * (double)snapshot_stats_.keyframes / (double)snapshot_stats_.packets,
+               sizeof(GameState));
+        snapshot_stats_ = {};
+    }
+}
+
+// ---------------------------------------------------------------------------
+// BroadcastRoster — tabella player_id → nome (i nomi non viaggiano negli snapshot)
+// ---------------------------------------------------------------------------
+void ServerSession::BroadcastRoster(ENetHost* host) {
+    PktRoster pkt{};
+    for (const auto& [peer, pl] : players_) {
+        if (pkt.count >= static_cast<uint8_t>(MAX_PLAYERS)) break;
+        const PlayerState& s = pl.GetState();
+        RosterEntry& e = pkt.entries[pkt.count++];
+        e.player_id = s.player_id;
+        std::memcpy(e.name, s.name, sizeof(e.name));
+    }
+    BroadcastPacket(host, &pkt, sizeof(pkt));
 }
 
 // ---------------------------------------------------------------------------
@@ -853,78 +1152,182 @@ void ServerSession::BroadcastGameState(ENetHost* host) {
 void ServerSession::BroadcastGenerating(ENetHost* host) {
     PktGenerating pkt{};
     pkt.level = static_cast<uint8_t>(current_level_);
-    ENetPacket* ep = enet_packet_create(&pkt, sizeof(pkt), ENET_PACKET_FLAG_RELIABLE);
-    enet_host_broadcast(host, CHANNEL_RELIABLE, ep);
-    enet_host_flush(host);  // send immediately before blocking in Generate()
+    BroadcastPacket(host, &pkt, sizeof(pkt));
     printf("[server] PKT_GENERATING level=%u\n", (unsigned)pkt.level);
 }
 
 // ---------------------------------------------------------------------------
-// BroadcastLevelData — send PKT_LEVEL_DATA with the current world grid
+// BuildLevelPacket — header + payload (PKT_LEVEL_DATA / PKT_LEVEL_STAGE)
 // ---------------------------------------------------------------------------
-void ServerSession::BroadcastLevelData(ENetHost* host) {
-    const World& world = level_mgr_.GetWorld();
+void ServerSession::BuildLevelPacket(uint8_t type, const LevelManager& lm, int level,
+                                     const LevelRecipe* recipe,
+                                     const std::vector<std::string>& rows,
+                                     std::vector<uint8_t>& buf) const {
+    const World& world = lm.GetWorld();
     const int w = world.GetWidth();
     const int h = world.GetHeight();
-    const size_t grid_size = static_cast<size_t>(w) * h;
-    const size_t pkt_size  = sizeof(PktLevelDataHeader) + grid_size;
 
-    // Build packet buffer: header + tile char data
-    std::vector<uint8_t> buf(pkt_size, 0);
     PktLevelDataHeader hdr{};
-    hdr.type    = PKT_LEVEL_DATA;
-    hdr.is_last = 0;
-    hdr.width   = static_cast<uint16_t>(w);
-    hdr.height  = static_cast<uint16_t>(h);
-    hdr.level   = static_cast<uint8_t>(current_level_);
-    std::memcpy(buf.data(), &hdr, sizeof(hdr));
-
-    // Copy tile chars row-by-row
-    const auto& rows = world.GetRows();
-    uint8_t* dst = buf.data() + sizeof(hdr);
-    for (int y = 0; y < h; ++y) {
-        std::memcpy(dst, rows[y].data(), w);
-        dst += w;
+    hdr.type     = type;
+    hdr.is_last  = 0;
+    hdr.width    = static_cast<uint16_t>(w);
+    hdr.height   = static_cast<uint16_t>(h);
+    hdr.level    = static_cast<uint8_t>(level);
+    hdr.epoch    = level_epoch_;   // ignored for PKT_LEVEL_STAGE (PKT_LEVEL_COMMIT carries it)
+    hdr.encoding = recipe ? LEVEL_ENC_RECIPE : LEVEL_ENC_PACKED;
+    buf.assign(sizeof(hdr), 0);
+
+    if (recipe) {
+        BitWriter bw(buf);
+        WriteLevelRecipe(bw, *recipe);
+    } else if (!EncodeLevelGrid(rows, w, h, buf)) {
+        // Too many tile kinds for the 3-bit palette: copy tile chars row-by-row
+        hdr.encoding = LEVEL_ENC_GRID;
+        buf.resize(sizeof(hdr) + static_cast<size_t>(w) * h);
+        uint8_t* dst = buf.data() + sizeof(hdr);
+        for (int y = 0; y < h; ++y) {
+            std::memcpy(dst, rows[y].data(), w);
+            dst += w;
+        }
     }
-
-    ENetPacket* pkt = enet_packet_create(buf.data(), pkt_size,
-                                          ENET_PACKET_FLAG_RELIABLE);
-    enet_host_broadcast(host, CHANNEL_RELIABLE, pkt);
-    enet_host_flush(host);
-    printf("[server] PKT_LEVEL_DATA sent: %dx%d = %zu bytes\n", w, h, pkt_size);
+    std::memcpy(buf.data(), &hdr, sizeof(hdr));
 }
 
 // ---------------------------------------------------------------------------
-// SendLevelDataToPeer — send PKT_LEVEL_DATA to a single peer (used on connect)
+// BuildLevelStream — PKT_LEVEL_DATA (LEVEL_ENC_REGIONS) + PKT_LEVEL_REGION packets,
+// regions nearest to the spawn first. false if the level is a single region or
+// cannot be packed: the caller sends one packet instead.
 // ---------------------------------------------------------------------------
-void ServerSession::SendLevelDataToPeer(ENetPeer* peer) {
-    const World& world = level_mgr_.GetWorld();
+bool ServerSession::BuildLevelStream(const LevelManager& lm, int level,
+                                     const std::vector<std::string>& rows,
+                                     std::vector<std::vector<uint8_t>>& pkts) const {
+    const World& world = lm.GetWorld();
     const int w = world.GetWidth();
     const int h = world.GetHeight();
-    if (w == 0 || h == 0) return;
-    const size_t grid_size = static_cast<size_t>(w) * h;
-    const size_t pkt_size  = sizeof(PktLevelDataHeader) + grid_size;
-
-    std::vector<uint8_t> buf(pkt_size, 0);
-    PktLevelDataHeader hdr{};
-    hdr.type    = PKT_LEVEL_DATA;
-    hdr.is_last = 0;
-    hdr.width   = static_cast<uint16_t>(w);
-    hdr.height  = static_cast<uint16_t>(h);
-    hdr.level   = static_cast<uint8_t>(current_level_);
-    std::memcpy(buf.data(), &hdr, sizeof(hdr));
+    if (w <= LEVEL_REGION_TILES && h <= LEVEL_REGION_TILES) return false;
+
+    const SpawnPos sp = FindCenterSpawn(world);
+    std::vector<LevelRegion> regions;
+    if (!EncodeLevelRegions(rows, w, h, LEVEL_REGION_TILES,
+                            static_cast<int>(sp.x) / TILE_SIZE,
+                            static_cast<int>(sp.y) / TILE_SIZE, regions) ||
+        regions.size() > 0xFFFF)
+        return false;
 
-    const auto& rows = world.GetRows();
-    uint8_t* dst = buf.data() + sizeof(hdr);
-    for (int y = 0; y < h; ++y) {
-        std::memcpy(dst, rows[y].data(), w);
-        dst += w;
+    pkts.clear();
+    size_t next = 0;
+    while (next < regions.size()) {
+        // Fill one packet up to LEVEL_REGION_PKT_BYTES (always at least one block).
+        size_t end = next, bytes = 0;
+        while (end < regions.size() && end - next < 255 &&
+               (end == next || bytes + RegionBlockSize(regions[end]) <= LEVEL_REGION_PKT_BYTES))
+            bytes += RegionBlockSize(regions[end++]);
+        const uint8_t count = static_cast<uint8_t>(end - next);
+
+        std::vector<uint8_t> buf;
+        if (pkts.empty()) {
+            PktLevelDataHeader hdr{};
+            hdr.type     = PKT_LEVEL_DATA;
+            hdr.width    = static_cast<uint16_t>(w);
+            hdr.height   = static_cast<uint16_t>(h);
+            hdr.level    = static_cast<uint8_t>(level);
+            hdr.epoch    = level_epoch_;
+            hdr.encoding = LEVEL_ENC_REGIONS;
+            PktLevelRegionsInfo info{};
+            info.count = count;
+            info.total = static_cast<uint16_t>(regions.size());
+            buf.resize(sizeof(hdr) + sizeof(info));
+            std::memcpy(buf.data(), &hdr, sizeof(hdr));
+            std::memcpy(buf.data() + sizeof(hdr), &info, sizeof(info));
+        } else {
+            PktLevelRegion reg{};
+            reg.level = static_cast<uint8_t>(level);
+            reg.epoch = level_epoch_;
+            reg.count = count;
+            buf.resize(sizeof(reg));
+            std::memcpy(buf.data(), &reg, sizeof(reg));
+        }
+        buf.reserve(buf.size() + bytes);
+        for (; next < end; ++next) AppendRegionBlock(regions[next], buf);
+        pkts.push_back(std::move(buf));
     }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// SendLevel — level packet to one peer (nullptr = every player of the room).
+// Peers holding the same chunk set get the recipe, the others the packed grid
+// (PKT_LEVEL_DATA: streamed by region when the level spans more than one).
+// ---------------------------------------------------------------------------
+void ServerSession::SendLevel(uint8_t type, const LevelManager& lm, int level,
+                              ENetPeer* only, bool allow_recipe) {
+    const World& world = lm.GetWorld();
+    if (world.GetWidth() == 0 || world.GetHeight() == 0) return;
+
+    const LevelRecipe* recipe = allow_recipe ? lm.Recipe() : nullptr;
+    std::vector<uint8_t> grid_pkt, recipe_pkt;
+    std::vector<std::vector<uint8_t>> stream_pkts;
+    bool stream_built = false;
+    int n_grid = 0, n_recipe = 0, n_stream = 0;
+    size_t stream_bytes = 0;
+    // Tile rows for the grid encodings: built once, on the first peer that needs them.
+    std::vector<std::string> rows;
+    auto grid_rows = [&]() -> const std::vector<std::string>& {
+        if (rows.empty()) rows = world.GetRows();
+        return rows;
+    };
+    auto send_to = [&](ENetPeer* peer) {
+        const auto it = peer_chunk_hash_.find(peer);
+        const bool use_recipe = recipe && it != peer_chunk_hash_.end() &&
+                                it->second == recipe->chunk_hash;
+        std::vector<uint8_t>& buf = use_recipe ? recipe_pkt : grid_pkt;
+        if (buf.empty()) {
+            if (use_recipe) BuildLevelPacket(type, lm, level, recipe, {}, buf);
+            else            BuildLevelPacket(type, lm, level, nullptr, grid_rows(), buf);
+        }
+        if (!use_recipe && type == PKT_LEVEL_DATA) {
+            if (!stream_built) {
+                // Up to one fragment the packed grid arrives as fast as the spawn regions
+                // would (and is half their size): stream only bigger levels.
+                stream_built = true;
+                if (grid_pkt.size() <= sizeof(PktLevelDataHeader) + LEVEL_REGION_PKT_BYTES ||
+                    !BuildLevelStream(lm, level, grid_rows(), stream_pkts))
+                    stream_pkts.clear();
+                for (const auto& p : stream_pkts) stream_bytes += p.size();
+            }
+            if (!stream_pkts.empty()) {
+                for (const auto& p : stream_pkts) SendPacket(peer, p.data(), p.size());
+                ++n_stream;
+                return;
+            }
+        }
+        SendPacket(peer, buf.data(), buf.size());
+        ++(use_recipe ? n_recipe : n_grid);
+    };
+    if (only) send_to(only);
+    else for (auto& [peer, pl] : players_) send_to(peer);
+
+    printf("[server] %s level=%d %dx%d: recipe %zu B x%d, grid %zu B x%d, "
+           "regions %zu B in %zu pkts x%d\n",
+           type == PKT_LEVEL_STAGE ? "PKT_LEVEL_STAGE" : "PKT_LEVEL_DATA",
+           level, world.GetWidth(), world.GetHeight(),
+           recipe_pkt.size(), n_recipe, grid_pkt.size(), n_grid,
+           stream_bytes, stream_pkts.size(), n_stream);
+}
 
-    ENetPacket* pkt = enet_packet_create(buf.data(), pkt_size,
-                                          ENET_PACKET_FLAG_RELIABLE);
-    enet_peer_send(peer, CHANNEL_RELIABLE, pkt);
-    printf("[server] PKT_LEVEL_DATA sent to peer: %dx%d = %zu bytes\n", w, h, pkt_size);
+// ---------------------------------------------------------------------------
+// BroadcastLevelData — send PKT_LEVEL_DATA with the current world grid
+// ---------------------------------------------------------------------------
+void ServerSession::BroadcastLevelData(ENetHost* host) {
+    (void)host;
+    SendLevel(PKT_LEVEL_DATA, level_mgr_, current_level_, nullptr, true);
+}
+
+// ---------------------------------------------------------------------------
+// SendLevelDataToPeer — send PKT_LEVEL_DATA to a single peer (used on connect)
+// ---------------------------------------------------------------------------
+void ServerSession::SendLevelDataToPeer(ENetPeer* peer) {
+    SendLevel(PKT_LEVEL_DATA, level_mgr_, current_level_, peer, true);
 }
 
 // ---------------------------------------------------------------------------
@@ -1036,7 +1439,7 @@ void ServerSession::ReleaseGrab(ENetPeer* grabber) {
 // ---------------------------------------------------------------------------
 // ApplyMagnetGrab — magnet holders grab the closest player and carry them
 // ---------------------------------------------------------------------------
-void ServerSession::ApplyMagnetGrab(ENetPeer* break_free) {
+void ServerSession::ApplyMagnetGrab(const std::unordered_set<ENetPeer*>& break_free) {
     if (players_.size() < 2) return;
 
     // Latch release: after any release, a grabber must let go of magnet first.
@@ -1088,7 +1491,7 @@ void ServerSession::ApplyMagnetGrab(ENetPeer* break_free) {
 
         for (auto& [other_peer, other_pl] : players_) {
             if (other_peer == peer) continue;
-            if (other_peer == break_free) continue;  // just broke free this tick — skip
+            if (break_free.count(other_peer)) continue;  // just broke free this tick — skip
             const PlayerState& os = other_pl.GetState();
             if (os.kill_respawn_ticks > 0 || os.respawn_grace_ticks > 0 || os.finished) continue;
             if (os.grabbed) continue;       // already grabbed by someone else
@@ -1274,10 +1677,7 @@ void ServerSession::SendGlobalResults(ENetHost* host) {
     for (size_t i = 0; i < pkt.count; i++)
         pkt.entries[i] = entries[i];
 
-    ENetPacket* p = enet_packet_create(&pkt, sizeof(pkt),
-                                        ENET_PACKET_FLAG_RELIABLE);
-    enet_host_broadcast(host, CHANNEL_RELIABLE, p);
-    enet_host_flush(host);
+    BroadcastPacket(host, &pkt, sizeof(pkt));
 
     in_global_results_        = true;
     global_results_start_ms_  = enet_time_get();
@@ -1292,9 +1692,9 @@ void ServerSession::SendGlobalResults(ENetHost* host) {
 void ServerSession::FinishSession(ENetHost* host) {
     PktLoadLevel ll_pkt{};
     ll_pkt.is_last = 1;
-    ENetPacket* ll = enet_packet_create(&ll_pkt, sizeof(ll_pkt),
-                                         ENET_PACKET_FLAG_RELIABLE);
-    enet_host_broadcast(host, CHANNEL_RELIABLE, ll);
+    BroadcastPacket(host, &ll_pkt, sizeof(ll_pkt));
+    // ResetToInitial drops queued packets (enet_peer_disconnect_now): send is_last first.
+    // Only reached from the ENet thread (handlers / CheckTimers), never from Tick.
     enet_host_flush(host);
     printf("[server] SESSION COMPLETE --> reset\n");
     ResetToInitial(host);
@@ -3,26 +3,44 @@
 // Manages connected players, lobby / game / results phases, and level progression.
 // Socket lifecycle and the ENet service loop live in RunServer (ServerLogic.cpp).
 #include "LevelManager.h"
-#include "ChunkStore.h"
+#include "ChunkLibrary.h"
 #include "Player.h"
 #include "Protocol.h"
 #include "GameMode.h"
+#include "SnapshotDelta.h"
 #include <enet/enet.h>
+#include <deque>
+#include <future>
+#include <optional>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 #include <string>
 #include <cstdint>
 
 class ServerSession {
 public:
     // Load the initial map. Check IsReady() after construction.
+    // chunks is shared by every room and must outlive the session. Each generation takes
+    // its current snapshot, so a hot-reloaded chunk set applies from the next level.
+    // While the library holds no usable set, level generation is disabled.
     // When skip_lobby is true the lobby is skipped: level 1 is generated immediately.
     // initial_mode sets the starting game mode (used by offline → RACE).
-    ServerSession(const char* initial_map_path, int initial_level,
+    ServerSession(ChunkLibrary& chunks, const char* initial_map_path, int initial_level,
                   bool skip_lobby = false, GameMode initial_mode = GameMode::VERSUS);
 
     bool IsReady() const { return is_ready_; }
 
+    // Room routing: a new connection may join this session (lobby open, slot free).
+    bool   CanAccept()   const { return !game_locked_ && players_.size() < MAX_CLIENTS; }
+    size_t PlayerCount() const { return players_.size(); }
+
+    // Threading: one ENet host can serve several sessions (rooms). The event handlers
+    // and CheckTimers run on the ENet thread; Tick may run on a pool thread concurrently
+    // with other rooms' Tick, so it only queues packets for this session's own peers
+    // (enet_peer_send) and never flushes or disconnects — RunServer flushes the host
+    // after every tick batch.
+
     // ENet event handlers — called by RunServer inside the service loop.
 
     void OnConnect(ENetHost* host, ENetPeer* peer);
@@ -31,13 +49,24 @@ public:
     bool OnDisconnect(ENetHost* host, ENetPeer* peer);
 
     // Returns true when a level change was triggered.
+    // PKT_INPUT is only queued here; it is consumed by the next Tick().
     bool OnReceive(ENetHost* host, ENetPeer* peer, const uint8_t* data, size_t len);
 
+    // Authoritative fixed-rate step — call exactly once per FIXED_DT.
+    // Drains the per-peer input queues, simulates every player in player_id order,
+    // resolves grab/collisions once and broadcasts a single snapshot.
+    // Returns true when a level change was triggered.
+    bool Tick(ENetHost* host);
+
     // Periodic timer checks (results timeout). Call once per outer loop iteration.
     void CheckTimers(ENetHost* host);
 
 private:
-    bool HandleInput     (ENetHost* host, ENetPeer* peer, const PktInput& pkt);
+    void QueueInput      (ENetPeer* peer, const InputFrame& frame);
+    // Simulate one input frame for one player (grab release/throw, finish, checkpoint, kill).
+    // Peers that must not be re-grabbed this tick are added to break_free.
+    void SimulatePlayer  (ENetPeer* peer, const InputFrame& frame,
+                          std::unordered_set<ENetPeer*>& break_free);
     void HandlePlayerInfo(ENetHost* host, ENetPeer* peer, const PktPlayerInfo& pkt);
     void HandleRestart   (ENetPeer* peer);       // respawn at last checkpoint (or spawn)
     void HandleRestartSpawn(ENetPeer* peer);     // respawn always at level spawn
@@ -46,8 +75,15 @@ private:
     void HandleSetMaxLevels(ENetHost* host, ENetPeer* peer, const PktSetMaxLevels& pkt);
     bool HandleStartGame (ENetHost* host, ENetPeer* peer);  // returns true on level change
 
-    // Load next map, reset all players, broadcast new state.
+    // Start the transition to the next level. Generated levels are built on a worker
+    // thread, normally ahead of time (UpdatePregeneration). If the level is not ready
+    // yet, PollLevelGeneration() (called by Tick) installs it when the worker finishes.
+    // FinishLevelChange(): reset all players, send PKT_LEVEL_DATA (or PKT_LEVEL_COMMIT
+    // when the grid was already staged on the clients).
     void DoLevelChange(ENetHost* host);
+    bool PollLevelGeneration(ENetHost* host);   // true when a new level was installed
+    void InstallPreparedLevel(ENetHost* host);
+    void FinishLevelChange(ENetHost* host, bool loaded, bool staged = false);
     // Broadcast PKT_GLOBAL_RESULTS and enter the global-results phase.
     void SendGlobalResults(ENetHost* host);
     // Send PKT_LOAD_LEVEL(is_last=1) then tear down the session.
@@ -55,23 +91,35 @@ private:
     // Disconnect all peers, reload the lobby (called when is_last).
     void ResetToInitial(ENetHost* host);
     void SendResults   (ENetHost* host, const char* reason);
-    void BroadcastGameState(ENetHost* host);
+    void BroadcastGameState(ENetHost* host);      // one delta snapshot per peer vs. its acked baseline
     void BroadcastLevelData(ENetHost* host);      // send PKT_LEVEL_DATA with generated world grid
     void BroadcastGenerating(ENetHost* host);     // send PKT_GENERATING before level generation starts
+    void BroadcastRoster(ENetHost* host);         // send PKT_ROSTER (player_id → name) to everyone
+    // Every outgoing packet goes through these: channel + flags from RoutePacket(type byte).
+    static void SendPacket     (ENetPeer* peer, const void* data, size_t size);
+    void        BroadcastPacket(ENetHost* host, const void* data, size_t size);  // this room only
     void SendLevelDataToPeer(ENetPeer* peer);     // send PKT_LEVEL_DATA to a single peer
+    // rows = lm.GetWorld().GetRows() (unused with a recipe): built once per SendLevel.
+    void BuildLevelPacket(uint8_t type, const LevelManager& lm, int level,
+                          const LevelRecipe* recipe, const std::vector<std::string>& rows,
+                          std::vector<uint8_t>& buf) const;
+    bool BuildLevelStream(const LevelManager& lm, int level, const std::vector<std::string>& rows,
+                          std::vector<std::vector<uint8_t>>& pkts) const;  // LEVEL_ENC_REGIONS
+    void SendLevel(uint8_t type, const LevelManager& lm, int level,
+                   ENetPeer* only, bool allow_recipe);
     void UpdateZone();
     bool AllInZone()        const;
     uint32_t CountdownTicks() const;
     PlayerState ApplySpawnReset(PlayerState s, bool with_kill) const;
     void ResolvePlayerCollisions(const World& world);   // coop mode: push overlapping player AABBs apart
-    void ApplyMagnetGrab(ENetPeer* break_free = nullptr);  // magnet holders grab & carry nearby players
+    void ApplyMagnetGrab(const std::unordered_set<ENetPeer*>& break_free);  // magnet holders grab & carry nearby players
     void ReleaseGrab(ENetPeer* grabber);                 // release a grabbed player (if any)
 
     // Leader election: elect a new leader from the remaining players.
     void ElectLeader();
 
     LevelManager level_mgr_;
-    ChunkStore   chunk_store_;       // loaded at construction; used by LevelGenerator
+    ChunkLibrary& chunk_library_;  // process-wide (ChunkLibrary::Shared); snapshots feed LevelGenerator
 
     std::string  initial_map_path_;
     int          initial_level_;
@@ -97,6 +145,22 @@ private:
     uint32_t     level_start_ms_          = 0u;
 
     std::unordered_map<ENetPeer*, Player>   players_;
+    // Inputs received since the last Tick(), in arrival order (one frame per client tick).
+    std::unordered_map<ENetPeer*, std::deque<InputFrame>> input_queues_;
+    // Next tick not yet queued per peer: PKT_INPUT repeats unconfirmed frames (dedupe).
+    std::unordered_map<ENetPeer*, uint32_t> input_next_tick_;
+    uint8_t   level_epoch_ = 0;   // ++ on every level change; PKT_INPUT from other epochs is dropped
+
+    // Snapshot history for delta compression: slot = seq % SNAPSHOT_RING.
+    GameState snapshot_ring_[SNAPSHOT_RING] = {};
+    uint32_t  snapshot_seq_ = 0;                              // newest snapshot seq (0 = none)
+    std::unordered_map<ENetPeer*, uint32_t> snapshot_acks_;   // newest seq acked by each peer
+    std::unordered_map<ENetPeer*, uint64_t> peer_chunk_hash_; // PktPlayerInfo::chunk_hash (recipe vs. grid)
+    struct SnapshotStats {
+        uint64_t packets   = 0;
+        uint64_t bytes     = 0;
+        uint64_t keyframes = 0;
+    } snapshot_stats_;                                        // reset at every log line
     std::unordered_map<ENetPeer*, uint32_t> best_ticks_;
     std::unordered_set<ENetPeer*>           ready_peers_;
     // Persistent within a session (survive per-level resets); cleared by ResetToInitial.
@@ -112,8 +176,48 @@ private:
     // Grabbers in this set must release magnet before they can grab again.
     std::unordered_set<ENetPeer*> regrab_requires_release_;
 
+    // Async level generation. The worker holds its own chunk snapshot and writes its own
+    // LevelManager; the session swaps it into level_mgr_ on the ENet thread.
+    struct GeneratedLevel {
+        bool         ok = false;
+        LevelManager level;
+    };
+    // Everything the generated grid depends on; a prepared level is valid only while
+    // LevelKeyFor(next level) still matches (the leader can change mode / level count).
+    struct LevelKey {
+        int      level        = 0;
+        int      curve_levels = 0;
+        GameMode mode         = GameMode::COOP;
+        bool     validate     = false;
+        uint64_t chunk_hash   = 0;     // snapshot the grid is built from (hot reload)
+        bool operator==(const LevelKey&) const = default;
+    };
+    LevelKey LevelKeyFor(int level_num) const;
+    void     StartGeneration(const LevelKey& key);
+    void     UpdatePregeneration(ENetHost* host);   // per tick: collect / (re)start / stage
+    void     DropPreparedLevel();
+    void     RetireGeneration();         // park generation_ in retired_generations_
+    void     ReapRetiredGenerations();   // per tick: drop the finished ones
+
+    bool         generating_          = false;  // a level change is waiting for the worker
+    uint32_t     generation_start_ms_ = 0u;
+    LevelKey     generation_key_;               // what generation_ is building
+    std::optional<GeneratedLevel> prepared_;    // finished, not yet installed
+    LevelKey     prepared_key_;
+    bool         level_staged_        = false;  // prepared_ already sent as PKT_LEVEL_STAGE
+
     static constexpr uint32_t LEVEL_TIME_LIMIT_MS        = 120'000u;
     static constexpr uint32_t NEXT_LEVEL_MS              =   3'000u;
     static constexpr uint32_t RESULTS_DURATION_MS        =  15'000u;
     static constexpr uint32_t GLOBAL_RESULTS_DURATION_MS =  25'000u;  // longer: final screen
+
+    // Input queue limits: a queue longer than INPUT_BACKLOG_FRAMES is drained two frames
+    // per tick until it catches up; INPUT_QUEUE_MAX drops the oldest frames outright.
+    static constexpr size_t   INPUT_BACKLOG_FRAMES       = 4;
+    static constexpr size_t   INPUT_QUEUE_MAX            = 32;
+
+    // Declared last: destroyed (and therefore joined) first, while the rest of the
+    // session is still alive. Workers keep their snapshot alive themselves.
+    std::future<GeneratedLevel> generation_;
+    std::vector<std::future<GeneratedLevel>> retired_generations_;   // stale, still running
 };
@@ -0,0 +1,180 @@
+// SnapshotBench.cpp — benchmark del formato di rete: byte per PKT_GAME_STATE e PKT_INPUT.
+// Uso: TileRace_SnapshotBench [players] [ticks] [ack_lag], lanciato dalla cartella bin.
+// Simula `players` giocatori con Player::Simulate su Level01 e input pseudo-casuali
+// deterministici, codifica ogni tick come farebbe il server (delta contro lo snapshot
+// confermato `ack_lag` tick prima) e decodifica come il client.
+// Confronta con lo struct grezzo (formato precedente) e con un keyframe per tick.
+// Exit code 1 se decode(encode(s)) != s per uno snapshot o un bundle di input.
+
+#include "LevelManager.h"
+#include "Player.h"
+#include "Protocol.h"
+#include "SnapshotDelta.h"
+#include "WireCodec.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+// Input di un giocatore che tiene premuti i tasti per qualche tick, salta e scatta
+// ogni tanto: abbastanza simile al gioco vero da dare delta realistici.
+struct InputScript {
+    std::mt19937 rng;
+    float        move_x    = 0.f;
+    uint16_t     held      = 0;   // BTN_SPRINT / BTN_JUMP tenuti
+    int          jump_left = 0;
+
+    explicit InputScript(uint32_t seed) : rng(seed) {}
+
+    InputFrame Next(uint32_t tick) {
+        InputFrame f{};
+        f.tick = tick;
+        if (rng() % 20 == 0) move_x = static_cast<float>(static_cast<int>(rng() % 3) - 1);
+        if (rng() % 120 == 0) held ^= BTN_SPRINT;
+        if (jump_left == 0 && rng() % 40 == 0) {
+            f.buttons |= BTN_JUMP_PRESS;
+            jump_left  = 5 + static_cast<int>(rng() % 15);
+        }
+        if (jump_left > 0) { f.buttons |= BTN_JUMP; --jump_left; }
+        if (rng() % 90 == 0) {
+            f.buttons |= BTN_DASH;
+            f.dash_dx  = move_x;
+            f.dash_dy  = (rng() % 2) ? -1.f : 0.f;
+        }
+        f.move_x   = move_x;
+        f.buttons |= held;
+        if (move_x > 0.f) f.buttons |= BTN_RIGHT;
+        if (move_x < 0.f) f.buttons |= BTN_LEFT;
+        QuantizeInputFrame(f);
+        return f;
+    }
+};
+
+bool SameSnapshot(const GameState& a, const GameState& b) {
+    if (a.count != b.count || a.next_level_countdown_ticks != b.next_level_countdown_ticks ||
+        a.time_limit_secs != b.time_limit_secs || a.is_lobby != b.is_lobby ||
+        a.game_mode != b.game_mode || a.max_generated_levels != b.max_generated_levels ||
+        a.level_epoch != b.level_epoch || a.leader_id != b.leader_id)
+        return false;
+    for (uint32_t i = 0; i < a.count; ++i) {
+        if (a.players[i].player_id != b.players[i].player_id) return false;
+        for (int f = 0; f < PlayerFieldCount(); ++f)
+            if (!PlayerFieldEqual(f, a.players[i], b.players[i])) return false;
+    }
+    return true;
+}
+
+bool SameFrame(const InputFrame& a, const InputFrame& b) {
+    return a.tick == b.tick && a.buttons == b.buttons && a.move_x == b.move_x &&
+           a.dash_dx == b.dash_dx && a.dash_dy == b.dash_dy;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int      players = std::clamp(argc > 1 ? std::atoi(argv[1]) : 4, 1, MAX_PLAYERS);
+    const uint32_t ticks   = static_cast<uint32_t>(std::max(1, argc > 2 ? std::atoi(argv[2]) : 3600));
+    const uint32_t ack_lag = static_cast<uint32_t>(std::clamp(argc > 3 ? std::atoi(argv[3]) : 3,
+                                                              1, static_cast<int>(SNAPSHOT_RING) - 1));
+
+    LevelManager level;
+    const std::string path = LevelManager::BuildPath(1);
+    if (!level.Load(path.c_str())) {
+        printf("[SnapshotBench] cannot load '%s'\n", path.c_str());
+        return 1;
+    }
+    const World& world = level.GetWorld();
+
+    std::vector<Player>      sim(players);
+    std::vector<InputScript> scripts;
+    for (int p = 0; p < players; ++p) {
+        PlayerState ps;
+        ps.x         = level.SpawnX();
+        ps.y         = level.SpawnY();
+        ps.player_id = static_cast<uint32_t>(p + 1);
+        QuantizePlayerState(ps);
+        sim[p].SetState(ps);
+        scripts.emplace_back(static_cast<uint32_t>(p + 1));
+    }
+
+    // Ring del server (snapshot inviati) e del client (snapshot decodificati).
+    std::vector<GameState> server_ring(SNAPSHOT_RING), client_ring(SNAPSHOT_RING);
+    // Input non ancora confermati dal server, per giocatore (il client li rimanda tutti).
+    std::vector<std::vector<InputFrame>> unconfirmed(players);
+
+    std::vector<uint8_t> buf;
+    uint64_t delta_bytes = 0, key_bytes = 0, input_bytes = 0, input_frames = 0;
+    size_t   delta_max   = 0;
+    int      mismatches  = 0;
+
+    for (uint32_t seq = 1; seq <= ticks; ++seq) {
+        // --- Client → server: bundle degli input non confermati ---
+        for (int p = 0; p < players; ++p) {
+            auto& pending = unconfirmed[p];
+            pending.push_back(scripts[p].Next(seq));
+            while (pending.size() > std::min<size_t>(ack_lag + 1, INPUT_BUNDLE_MAX))
+                pending.erase(pending.begin());
+
+            buf.clear();
+            EncodeInputPacket(seq - 1, 0, pending.data(), static_cast<int>(pending.size()), buf);
+            input_bytes  += buf.size();
+            input_frames += pending.size();
+
+            InputFrame frames[INPUT_BUNDLE_MAX];
+            uint32_t   ack   = 0;
+            uint8_t    epoch = 0;
+            int        count = 0;
+            bool ok = DecodeInputPacket(buf.data(), buf.size(), ack, epoch, frames, count) &&
+                      ack == seq - 1 && count == static_cast<int>(pending.size());
+            for (int i = 0; ok && i < count; ++i) ok = SameFrame(frames[i], pending[i]);
+            if (!ok) ++mismatches;
+
+            sim[p].Simulate(pending.back(), world);
+            PlayerState ps = sim[p].GetState();
+            ps.last_processed_tick = seq;
+            ps.level_ticks         = seq;
+            sim[p].SetState(ps);
+        }
+
+        // --- Server: snapshot del tick ---
+        GameState gs;
+        gs.count           = static_cast<uint32_t>(players);
+        gs.time_limit_secs = 120 - std::min<uint32_t>(seq / 60, 120);
+        gs.leader_id       = 1;
+        for (int p = 0; p < players; ++p) gs.players[p] = sim[p].GetState();
+        server_ring[seq % SNAPSHOT_RING] = gs;
+
+        buf.clear();
+        EncodeSnapshot(seq, 0, nullptr, gs, buf);
+        key_bytes += buf.size();
+
+        // --- Server → client: delta contro l'ultimo snapshot confermato ---
+        const uint32_t ack = seq > ack_lag ? seq - ack_lag : 0;
+        buf.clear();
+        EncodeSnapshot(seq, ack, ack ? &server_ring[ack % SNAPSHOT_RING] : nullptr, gs, buf);
+        delta_bytes += buf.size();
+        delta_max    = std::max(delta_max, buf.size());
+
+        GameState& decoded = client_ring[seq % SNAPSHOT_RING];
+        const bool ok = DecodeSnapshot(ack ? &client_ring[ack % SNAPSHOT_RING] : nullptr,
+                                       buf.data(), buf.size(), decoded);
+        if (!ok || !SameSnapshot(decoded, gs)) ++mismatches;
+    }
+
+    printf("[SnapshotBench] %d players, %u ticks, ack lag %u ticks\n", players, ticks, ack_lag);
+    printf("[SnapshotBench] PKT_GAME_STATE  raw struct %zu B  keyframe avg %.1f B  delta avg %.1f B (max %zu B)\n",
+           1 + sizeof(GameState), static_cast<double>(key_bytes) / ticks,
+           static_cast<double>(delta_bytes) / ticks, delta_max);
+    printf("[SnapshotBench] PKT_INPUT       raw frame %zu B  bundle avg %.1f B (%.1f frames)\n",
+           1 + sizeof(InputFrame), static_cast<double>(input_bytes) / (ticks * players),
+           static_cast<double>(input_frames) / (ticks * players));
+    if (mismatches > 0) {
+        printf("[SnapshotBench] FAIL: %d packets did not decode to what was encoded\n", mismatches);
+        return 1;
+    }
+    printf("[SnapshotBench] round trip OK: decode(encode(s)) == s on every packet\n");
+    return 0;
+}
@@ -0,0 +1,84 @@
+// ThreadPool.cpp — worker fissi per batch fork-join.
+
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(size_t workers) {
+    workers_.reserve(workers);
+    for (size_t i = 0; i < workers; ++i)
+        workers_.emplace_back([this] { WorkerLoop(); });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& t : workers_) t.join();
+}
+
+size_t ThreadPool::DefaultWorkers() {
+    const unsigned hw = std::thread::hardware_concurrency();
+    return hw > 1 ? static_cast<size_t>(hw - 1) : 0u;
+}
+
+// ---------------------------------------------------------------------------
+// ParallelFor
+// ---------------------------------------------------------------------------
+size_t ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)>& fn) {
+    if (count == 0) return 1;
+    // Pool vuoto, batch di un solo indice o worker già occupati da un altro batch:
+    // il chiamante esegue tutto da solo.
+    std::unique_lock<std::mutex> batch(batch_mutex_, std::defer_lock);
+    if (workers_.empty() || count == 1 || !batch.try_lock()) {
+        for (size_t i = 0; i < count; ++i) fn(i);
+        return 1;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        fn_     = &fn;
+        count_  = count;
+        next_.store(0, std::memory_order_relaxed);
+        active_ = workers_.size();
+        ++batch_id_;
+    }
+    wake_.notify_all();
+
+    RunBatch();   // il chiamante lavora come gli altri thread
+
+    // Attende che tutti i worker abbiano lasciato il batch prima di invalidare fn_.
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return active_ == 0; });
+    fn_ = nullptr;
+    return ThreadCount();
+}
+
+void ThreadPool::RunBatch() {
+    for (;;) {
+        const size_t i = next_.fetch_add(1, std::memory_order_relaxed);
+        if (i >= count_) return;
+        (*fn_)(i);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// WorkerLoop
+// ---------------------------------------------------------------------------
+void ThreadPool::WorkerLoop() {
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stop_ || batch_id_ != seen; });
+            if (stop_) return;
+            seen = batch_id_;
+        }
+        RunBatch();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --active_;
+        }
+        done_.notify_one();
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+// SRP: fixed set of worker threads running fork-join batches (ParallelFor).
+// Used by RunServer to tick many rooms per server tick, and by LevelManager for the
+// generation pools every room shares. No ENet or Raylib dependency.
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+    // workers = extra threads; the thread calling ParallelFor always takes part,
+    // so ThreadPool(0) runs every batch inline.
+    explicit ThreadPool(size_t workers);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&)            = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Run fn(i) for every i in [0, count) and return when all calls have finished.
+    // Indices are handed out dynamically, so uneven jobs balance across threads.
+    // One batch at a time gets the workers: a call made while another is running (from
+    // another thread, or from inside fn) runs its indices inline on the caller.
+    // Returns the threads that ran the batch (1 = inline).
+    size_t ParallelFor(size_t count, const std::function<void(size_t)>& fn);
+
+    size_t ThreadCount() const { return workers_.size() + 1; }
+
+    // hardware_concurrency() - 1, at least 0: one worker per core besides the caller.
+    static size_t DefaultWorkers();
+
+private:
+    void WorkerLoop();
+    void RunBatch();   // take indices until the current batch is exhausted
+
+    std::vector<std::thread> workers_;
+    std::mutex               batch_mutex_;   // held by the caller whose batch has the workers
+    std::mutex               mutex_;
+    std::condition_variable  wake_;    // new batch or shutdown
+    std::condition_variable  done_;    // a worker left the batch
+
+    const std::function<void(size_t)>* fn_ = nullptr;
+    size_t              count_      = 0;
+    std::atomic<size_t> next_{0};
+    uint64_t            batch_id_   = 0;   // incremented per batch (guarded by mutex_)
+    size_t              active_     = 0;   // workers still inside the current batch
+    bool                stop_       = false;
+};
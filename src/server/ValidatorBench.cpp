@@ -0,0 +1,168 @@
+// ValidatorBench.cpp — benchmark del LevelValidator: tempo e allocazioni per livello.
+// Uso: TileRace_ValidatorBench [levels] [passes] [workers], lanciato dalla cartella bin.
+// Genera `levels` livelli con seed fissi dal chunk set, poi li valida `passes` volte per
+// ciascuna modalità di ricerca (BFS su un pool di `workers` thread, la stessa BFS con i
+// riassunti dei chunk di levels.pack, best-first seriale).
+// operator new è sostituito da un contatore: dal secondo passaggio in poi (scratch già
+// caldo) Validate non deve allocare. Exit code 1 se un passaggio caldo alloca o se con i
+// riassunti un livello ha un esito o un numero di espansioni diverso dalla BFS semplice.
+
+#include "ChunkLibrary.h"
+#include "LevelGenerator.h"
+#include "LevelValidator.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Contatore di allocazioni (tutti i thread)
+// ---------------------------------------------------------------------------
+static std::atomic<uint64_t> g_allocs{0};
+static std::atomic<uint64_t> g_alloc_bytes{0};
+
+static void* CountedAlloc(std::size_t size) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    g_alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size)   { return CountedAlloc(size); }
+void* operator new[](std::size_t size) { return CountedAlloc(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try { return CountedAlloc(size); } catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try { return CountedAlloc(size); } catch (...) { return nullptr; }
+}
+void operator delete(void* p) noexcept                          { std::free(p); }
+void operator delete[](void* p) noexcept                        { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept             { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept           { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept   { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+// ---------------------------------------------------------------------------
+// Passaggi
+// ---------------------------------------------------------------------------
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct PassResult {
+    uint64_t allocs = 0, bytes = 0;
+    int      valid = 0, invalid = 0, undecided = 0;
+    int64_t  ticks = 0, summarized = 0;
+    double   ms    = 0.0;
+    std::vector<std::pair<LevelValidator::Result, int>> levels;   // esito, espansioni
+};
+
+// recipes != nullptr: ogni livello con la sua ricetta (riassunti dei chunk).
+PassResult RunPass(const std::vector<World>& worlds, const std::vector<LevelRecipe>* recipes,
+                   const ChunkStore& store, const LevelValidator::Options& opts) {
+    LevelValidator::Stats stats;
+    LevelValidator::Options o = opts;
+    o.stats = &stats;
+
+    PassResult r;
+    r.levels.reserve(worlds.size());   // prima del contatore
+    const uint64_t a0 = g_allocs.load(), b0 = g_alloc_bytes.load();
+    const auto     t0 = Clock::now();
+    for (size_t i = 0; i < worlds.size(); ++i) {
+        if (recipes) {
+            o.store  = &store;
+            o.recipe = &(*recipes)[i];
+        }
+        const LevelValidator::Result res = LevelValidator::Validate(worlds[i], o);
+        switch (res) {
+            case LevelValidator::Result::VALID:     r.valid++;     break;
+            case LevelValidator::Result::INVALID:   r.invalid++;   break;
+            case LevelValidator::Result::UNDECIDED: r.undecided++; break;
+        }
+        r.ticks      += stats.simulated_ticks;
+        r.summarized += stats.summarized_ticks;
+        r.levels.push_back({ res, stats.expansions });
+    }
+    r.ms     = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    r.allocs = g_allocs.load() - a0;
+    r.bytes  = g_alloc_bytes.load() - b0;
+    return r;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int    levels  = argc > 1 ? std::atoi(argv[1]) : 200;
+    const int    passes  = argc > 2 ? std::max(2, std::atoi(argv[2])) : 3;
+    const size_t workers = argc > 3 ? static_cast<size_t>(std::atoi(argv[3])) : ThreadPool::DefaultWorkers();
+
+    const auto store = ChunkLibrary::Shared().Current();
+    std::vector<World>       worlds;
+    std::vector<LevelRecipe> recipes;
+    worlds.reserve(levels);
+    recipes.reserve(levels);
+    for (int i = 0; i < levels; ++i) {
+        GeneratorParams p;
+        p.level_num = 1 + i % DIFFICULTY_CURVE_LEVELS;
+        p.seed      = static_cast<uint32_t>(i + 1);
+        World       w;
+        LevelRecipe recipe;
+        if (LevelGenerator::Generate(*store, p, w, &recipe)) {
+            worlds.push_back(std::move(w));
+            recipes.push_back(std::move(recipe));
+        }
+    }
+    size_t summarized_chunks = 0;
+    for (size_t id = 0; id < store->ChunkCount(); ++id)
+        if (store->ChunkById(static_cast<int>(id))->traversal) summarized_chunks++;
+    if (worlds.empty()) {
+        printf("[ValidatorBench] no level generated from '%s'\n", CHUNKS_DIR);
+        return 1;
+    }
+
+    ThreadPool pool(workers);
+    struct Mode { const char* name; LevelValidator::Options opts; const std::vector<LevelRecipe>* recipes; };
+    constexpr int MODES = 3;
+    Mode modes[MODES] = {};
+    modes[0].name        = "bfs";
+    modes[0].opts.pool   = &pool;
+    modes[1].name        = "bfs+chunks";
+    modes[1].opts.pool   = &pool;
+    modes[1].recipes     = &recipes;
+    modes[2].name        = "best-first";
+    modes[2].opts.search = LevelValidator::Search::BEST_FIRST;
+
+    std::vector<PassResult> results[MODES];
+    for (int m = 0; m < MODES; ++m)
+        for (int pass = 0; pass < passes; ++pass)
+            results[m].push_back(RunPass(worlds, modes[m].recipes, *store, modes[m].opts));
+
+    // Riepilogo alla fine: Validate stampa una riga per livello.
+    bool warm_allocs = false;
+    printf("[ValidatorBench] %zu levels, %d passes, bfs on %zu thread(s), %zu of %zu chunks summarized\n",
+           worlds.size(), passes, pool.ThreadCount(), summarized_chunks, store->ChunkCount());
+    for (int m = 0; m < MODES; ++m)
+        for (int pass = 0; pass < passes; ++pass) {
+            const PassResult& r = results[m][pass];
+            printf("[ValidatorBench] %-10s pass %d%s: %d valid, %d invalid, %d undecided"
+                   "  %.2f ms/level  %.0f ticks/level (%.0f summarized)  %llu allocs (%llu bytes)\n",
+                   modes[m].name, pass + 1, pass == 0 ? " (cold)" : "",
+                   r.valid, r.invalid, r.undecided,
+                   r.ms / worlds.size(), static_cast<double>(r.ticks) / worlds.size(),
+                   static_cast<double>(r.summarized) / worlds.size(),
+                   static_cast<unsigned long long>(r.allocs), static_cast<unsigned long long>(r.bytes));
+            if (pass > 0 && r.allocs > 0) warm_allocs = true;
+        }
+    if (warm_allocs) printf("[ValidatorBench] FAIL: Validate allocated on a warm pass\n");
+
+    // I riassunti non devono cambiare nulla: stesso esito e stesse espansioni per livello.
+    int differ = 0;
+    for (size_t i = 0; i < worlds.size(); ++i)
+        if (results[1][0].levels[i] != results[0][0].levels[i]) differ++;
+    if (differ > 0) printf("[ValidatorBench] FAIL: %d levels differ with chunk summaries\n", differ);
+    return (warm_allocs || differ > 0) ? 1 : 0;
+}
@@ -3,23 +3,40 @@
 // con LocalServer (modalità offline, passo 20).
 
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <atomic>
 #include <enet/enet.h>
 #include "ServerLogic.h"
+#include "ChunkLibrary.h"
 #include "Protocol.h"
 
-int main() {
+int main(int argc, char** argv) {
+    // Uso: TileRace_Server [stanze] [--hot-reload]   (default DEFAULT_SERVER_ROOMS)
+    // --hot-reload: ricarica i chunk quando cambiano su disco (sviluppo dei livelli).
+    int  rooms      = DEFAULT_SERVER_ROOMS;
+    bool hot_reload = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--hot-reload") == 0) hot_reload = true;
+        else rooms = std::atoi(argv[i]);
+    }
+    if (rooms < 1) rooms = 1;
+
     if (enet_initialize() != 0) {
         fprintf(stderr, "[server] ERRORE: enet_initialize fallita\n");
         return 1;
     }
 
     printf("[server] premi Ctrl+C per uscire\n");
+    if (hot_reload) {
+        ChunkLibrary::Shared().StartWatching();
+        printf("[server] hot reload dei chunk attivo (%s)\n", CHUNKS_DIR);
+    }
 
     // stop_flag rimane false per sempre in modalità standalone;
     // il processo termina con Ctrl+C (SIGINT).
     std::atomic<bool> stop{false};
-    RunServer(SERVER_PORT, LOBBY_MAP_PATH, stop);
+    RunServer(SERVER_PORT, LOBBY_MAP_PATH, stop, false, GameMode::VERSUS, rooms);
 
     enet_deinitialize();
     return 0;